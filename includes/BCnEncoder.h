@@ -0,0 +1,61 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+
+// glad 只生成了核心规范，S3TC 属于扩展（EXT_texture_compression_s3tc），常量需要自行定义
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+/*
+ * 块压缩格式，每个格式都把 4x4 像素编码为一个定长的块：
+ *  BC1：RGB，每块8字节（4 bpp），用于不透明的颜色贴图。
+ *  BC3：RGBA，每块16字节（8 bpp），BC4 编码的 alpha + BC1 编码的颜色，用于带透明度的颜色贴图。
+ *  BC4：单通道，每块8字节（4 bpp），用于高光、粗糙度等灰度贴图。
+ *  BC5：双通道，每块16字节（8 bpp），两个 BC4 块分别编码 R 和 G，用于切线空间法线贴图（Z 在着色器中重建）。
+*/
+enum class BCFormat : uint32_t
+{
+    BC1 = 1,
+    BC3 = 3,
+    BC4 = 4,
+    BC5 = 5,
+};
+
+/*
+ * CPU 块压缩编码器，在工作线程中把 RGBA8 图像编码为 BCn 数据，可以直接用 glCompressedTexImage2D 上传。
+ * 端点选择使用包围盒加最小二乘修正，颜色距离计算在支持 SSE2 的平台上使用 SIMD，其余平台使用等价的标量代码。
+ * 同时提供解码器和 PSNR 计算，不需要GPU即可评估压缩质量。
+*/
+class BCnEncoder
+{
+  public:
+    static size_t GetBlockSize(BCFormat format);
+
+    /* 宽高不是4的倍数时按块向上取整 */
+    static size_t GetCompressedSize(BCFormat format, int width, int height);
+
+    static GLenum GetGLFormat(BCFormat format);
+
+    /*
+     * rgba 为 width*height*4 字节紧密排列的像素，output 至少需要 GetCompressedSize 字节。
+     * BC4 只读取 R 通道，BC5 只读取 R、G 通道；图像边缘不足4x4的块会重复边缘像素补齐。
+    */
+    static void Encode(BCFormat format, const uint8_t *rgba, int width, int height, uint8_t *output);
+
+    /* 把压缩数据解码为 RGBA8，未编码的通道填0（alpha 填255） */
+    static void Decode(BCFormat format, const uint8_t *blocks, int width, int height, uint8_t *rgba);
+
+    /* 只统计该格式实际编码的通道，两幅图像完全相同时返回正无穷 */
+    static double ComputePSNR(BCFormat format, const uint8_t *reference, const uint8_t *decoded, int width,
+                              int height);
+
+  private:
+    // 禁止实例化该类
+    BCnEncoder() = delete;
+};
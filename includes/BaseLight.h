@@ -2,6 +2,13 @@
 
 #include "glm/glm.hpp"
 
+enum class LightType
+{
+    Direction,
+    Point,
+    Spot,
+};
+
 class BaseLight
 {
   protected:
@@ -16,4 +23,10 @@ class BaseLight
     // 禁止拷贝和赋值
     BaseLight(const BaseLight &) = delete;
     BaseLight &operator=(const BaseLight &) = delete;
-};
\ No newline at end of file
+
+    virtual LightType GetType() const = 0;
+
+    const glm::vec3 &GetAmbient() const;
+    const glm::vec3 &GetDiffuse() const;
+    const glm::vec3 &GetSpecular() const;
+};
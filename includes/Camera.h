@@ -31,9 +31,19 @@ class Camera
     glm::mat4 GetViewMatrix();
     glm::mat4 GetProjectionMatrix();
 
+    /*
+     * 世界空间下视锥体的6个平面（左、右、下、上、近、远），xyz 为指向视锥体内部的单位法线，w 为距离，
+     * 点 p 满足 dot(plane.xyz, p) + plane.w >= 0 时位于平面内侧。
+    */
+    void GetFrustumPlanes(glm::vec4 planes[6]);
+
     glm::vec3 GetPos() const;
     glm::vec3 GetFront() const;
 
+    double GetFov() const; // 垂直视野角度（度）
+    double GetNear() const;
+    double GetFar() const;
+
     void MoveForwardOrBackward(float delta);
     void MoveLeftOrRight(float delta);
     void TuneYawAndPitch(float deltaYaw, float deltaPitch);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Camera.h"
+#include "FrameRingBuffer.h"
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+/*
+ * 与 shaders/camera_block.glsl 中的 CameraBlock 对应的 std140 布局：
+ * mat4 按列存放，每列16字节；vec3 按16字节对齐，后面的 float 正好占用它剩下的4个字节。
+*/
+struct CameraBlockData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 view_projection;
+    glm::vec3 cam_pos;
+    float time;
+};
+
+static_assert(sizeof(CameraBlockData) == 208, "CameraBlockData must match the std140 layout of CameraBlock");
+
+/*
+ * 每帧更新一次的相机 uniform block，绑定到 UNIFORM_BLOCK_CAMERA。
+ * 声明了 CameraBlock 的着色器直接从缓冲区中读取 view/projection/camPos，
+ * 不再需要为每个着色器、每个网格单独上传这些值。
+ * 数据每帧从 FrameRingBuffer 中分配，直接写入映射的内存后用 glBindBufferRange 绑定。
+*/
+class CameraUniformBuffer
+{
+  private:
+    FrameRingBuffer *m_ring;
+
+    CameraBlockData m_data;
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    CameraUniformBuffer(const CameraUniformBuffer &) = delete;
+    CameraUniformBuffer &operator=(const CameraUniformBuffer &) = delete;
+
+    CameraUniformBuffer();
+    ~CameraUniformBuffer();
+
+    /* ring 为每帧分配数据的环形缓冲区，需要先初始化 */
+    bool Init(FrameRingBuffer *ring);
+
+    /* 每帧在 FrameRingBuffer::BeginFrame 之后调用一次，把相机参数写入环形缓冲区并绑定 */
+    void Update(Camera &camera, float time);
+
+    const CameraBlockData &GetData() const;
+};
@@ -11,4 +11,9 @@ class DirectionLight : public BaseLight
     DirectionLight(const glm::vec3 &direction, const glm::vec3 &ambient, const glm::vec3 &diffuse,
                    const glm::vec3 &specular);
     ~DirectionLight();
-};
\ No newline at end of file
+
+    LightType GetType() const override;
+
+    const glm::vec3 &GetDirection() const;
+    void SetDirection(const glm::vec3 &direction);
+};
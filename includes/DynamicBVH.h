@@ -0,0 +1,105 @@
+#pragma once
+
+#include "FrustumCuller.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <vector>
+
+/*
+ * 动态包围体层次结构（BVH），用于在大量场景实例中快速查找与视锥体、球体或射线相交的实例，不调用任何gl函数。
+ * 每个实例对应一个叶节点（proxy），叶节点保存实例的精确包围盒和向外扩展 margin 后的宽松包围盒，树只按宽松包围盒组织。
+ * 实例移动后调用 MoveProxy：新的包围盒仍在宽松包围盒内时只更新精确包围盒，否则移除后重新插入，
+ * 插入时按表面积启发式（SAH）选择兄弟节点，并沿途旋转节点保持平衡，查询的复杂度约为 O(log n)。
+ * 查询只在主线程中使用，查询结果是精确的：与按精确包围盒逐个测试所有实例得到的集合相同。
+*/
+class DynamicBVH
+{
+  public:
+    static constexpr int NULL_NODE = -1;
+    static constexpr uint32_t INVALID_USER_INDEX = ~0u;
+
+  private:
+    struct Node
+    {
+        glm::vec3 fat_min, fat_max; // 内部节点为两个子节点宽松包围盒的并集
+        glm::vec3 min, max;         // 只对叶节点有效：实例的精确包围盒
+
+        // 空闲节点用 parent 串成链表
+        int parent;
+        int child1, child2;
+
+        // 叶节点为0，空闲节点为-1
+        int height;
+
+        uint32_t user_index;
+
+        bool IsLeaf() const
+        {
+            return child1 == NULL_NODE;
+        }
+    };
+
+    std::vector<Node> m_nodes;
+    int m_root;
+    int m_free_list;
+    size_t m_proxy_num;
+
+    float m_margin;
+
+    // 视锥体查询中需要精确测试的叶节点，攒成一批后用 SIMD 一次测试
+    mutable FrustumCuller m_leaf_culler;
+    mutable std::vector<int> m_leaf_candidates;
+    mutable std::vector<int> m_stack;
+
+    int AllocateNode();
+    void FreeNode(int node);
+
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+
+    /* 如果以 node 为根的子树不平衡则旋转，返回旋转后子树的根 */
+    int Balance(int node);
+
+    /* 从 node 开始向上平衡并重新计算包围盒和高度 */
+    void Refit(int node);
+
+    void CollectLeaves(int node, std::vector<uint32_t> &result) const;
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    DynamicBVH(const DynamicBVH &) = delete;
+    DynamicBVH &operator=(const DynamicBVH &) = delete;
+
+    /* margin 为宽松包围盒在每个方向上扩展的距离，越大移动时重新插入越少，查询时的误判越多 */
+    DynamicBVH(float margin = 0.1f);
+    ~DynamicBVH();
+
+    /* 添加实例，userIndex 由调用者定义（例如实例在数组中的下标），查询时返回 */
+    int CreateProxy(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, uint32_t userIndex);
+    void DestroyProxy(int proxy);
+
+    /* 更新实例的包围盒，发生重新插入时返回 true */
+    bool MoveProxy(int proxy, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+
+    uint32_t GetUserIndex(int proxy) const;
+
+    void Clear();
+
+    /* 与视锥体相交的实例，planes 来自 Camera::GetFrustumPlanes，结果追加到 result */
+    void QueryFrustum(const glm::vec4 planes[6], std::vector<uint32_t> &result) const;
+
+    /* 与球体相交的实例，结果追加到 result */
+    void QuerySphere(const glm::vec3 &center, float radius, std::vector<uint32_t> &result) const;
+
+    /*
+     * 沿射线查找最近的实例包围盒（用于拾取），direction 不需要单位化，距离以 direction 的长度为单位。
+     * 起点在包围盒内部时距离为0。没有命中时返回 INVALID_USER_INDEX。
+    */
+    uint32_t RayCast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+                     float &hitDistance) const;
+
+    size_t GetProxyNum() const;
+
+    /* 树的高度，空树为0 */
+    int GetHeight() const;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * 每帧变化的数据（uniform block、逐实例数据、动态顶点等）共用的环形缓冲区。
+ * 缓冲区分为 regionNum 个大小相同的区域，每帧只在一个区域中顺序分配，帧结束时插入 fence，
+ * 下一次轮到该区域时 GPU 通常早已读完，等待 fence 不会阻塞；CPU 直接写入映射的内存，不经过驱动复制。
+ * 支持 GL_ARB_buffer_storage（OpenGL 4.4）时整个缓冲区持久映射（persistent + coherent），
+ * 否则（例如 macOS 的 OpenGL 4.1）每次分配用 GL_MAP_UNSYNCHRONIZED_BIT 映射对应的范围，由 fence 保证不会覆盖 GPU 正在读取的数据。
+*/
+class FrameRingBuffer
+{
+  public:
+    static constexpr uint32_t DEFAULT_REGION_NUM = 3;
+
+    /* 一次分配：data 为可写入的内存，offset 为在缓冲区中的字节偏移（用于 glBindBufferRange、顶点属性偏移等） */
+    struct Allocation
+    {
+        void *data;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+  private:
+    GLuint m_buffer;
+    bool m_persistent;
+    uint8_t *m_mapped; // 持久映射时整个缓冲区的起始地址
+
+    size_t m_region_size;
+    uint32_t m_region_num;
+    uint32_t m_region_index; // 当前帧使用的区域
+    size_t m_head;           // 当前区域中已分配的字节数
+
+    std::vector<GLsync> m_fences; // 每个区域最后一次使用时插入的 fence
+
+    GLint m_uniform_alignment;
+
+    size_t m_stall_num;
+    bool m_overflow_reported;
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    FrameRingBuffer(const FrameRingBuffer &) = delete;
+    FrameRingBuffer &operator=(const FrameRingBuffer &) = delete;
+
+    FrameRingBuffer();
+    ~FrameRingBuffer();
+
+    /* 创建缓冲区，regionSize 为每帧可以分配的字节数，需要在OpenGL上下文创建之后调用 */
+    bool Init(size_t regionSize, uint32_t regionNum = DEFAULT_REGION_NUM);
+
+    /* 每帧分配之前调用，必要时等待 GPU 读完当前区域上一次的数据 */
+    void BeginFrame();
+
+    /* 当前帧的数据全部提交绘制之后调用，为当前区域插入 fence，下一帧使用下一个区域 */
+    void EndFrame();
+
+    /*
+     * 在当前区域中分配 size 字节，偏移按 alignment 对齐，区域剩余空间不足时返回的 data 为空。
+     * 写入完成后必须调用 Commit，并且要在下一次 Allocate 之前（非持久映射时同一时间只能映射一个范围）。
+    */
+    Allocation Allocate(size_t size, size_t alignment);
+    void Commit(const Allocation &allocation);
+
+    /* 分配并写入 data，再把结果绑定到 GL_UNIFORM_BUFFER 的 binding 绑定点，失败时返回 false */
+    bool UploadUniformBlock(GLuint binding, const void *data, size_t size);
+
+    GLuint GetBufferID() const;
+
+    bool IsPersistent() const;
+
+    /* uniform block 的偏移必须是该值的倍数（GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT） */
+    size_t GetUniformAlignment() const;
+
+    size_t GetRegionSize() const;
+
+    /* 当前帧已分配的字节数 */
+    size_t GetUsedSize() const;
+
+    /* BeginFrame 中需要真正等待 GPU 的次数，持续增长说明区域数量不够 */
+    size_t GetStallNum() const;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * 批量视锥体剔除：每帧先用 Add 收集所有候选绘制的包围盒，再调用一次 Cull 统一测试。
+ * 包围盒变换到世界空间后按分量分开保存（SoA），x86 上使用 SSE 一次测试4个包围盒，其他平台使用标量实现。
+ * 测试是保守的：与视锥体的任意平面都不完全位于外侧的包围盒被视为可见。
+*/
+class FrustumCuller
+{
+  public:
+    /*
+     * 没有包围盒、总是可见的物体使用的半长，场景和 BVH 中也使用同一个值表示“无包围盒”。
+     * 足够大但有限：避免 0 * inf 得到 NaN，也避免 BVH 计算表面积时溢出。
+    */
+    static constexpr float UNBOUNDED_EXTENT = 1e18f;
+
+  private:
+    // 世界空间AABB的中心和半长，长度补齐为4的倍数，补齐的元素不计入结果
+    std::vector<float> m_center_x, m_center_y, m_center_z;
+    std::vector<float> m_extent_x, m_extent_y, m_extent_z;
+
+    std::vector<uint8_t> m_visible;
+
+    size_t m_bounds_num;
+    size_t m_visible_num;
+    size_t m_culled_num;
+
+    size_t Push(const glm::vec3 &center, const glm::vec3 &extent);
+
+    void CullScalar(const glm::vec4 planes[6], size_t begin, size_t end);
+    void CullSimd(const glm::vec4 planes[6], size_t end);
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    FrustumCuller(const FrustumCuller &) = delete;
+    FrustumCuller &operator=(const FrustumCuller &) = delete;
+
+    FrustumCuller();
+    ~FrustumCuller();
+
+    /* 每帧收集前调用，清空上一帧的包围盒 */
+    void Begin();
+
+    /* 添加模型空间的包围盒及其模型矩阵，返回用于 IsVisible 的下标 */
+    size_t Add(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, const glm::mat4 &model);
+
+    /* 添加世界空间的包围盒 */
+    size_t Add(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+
+    /* 添加没有包围盒、总是可见的绘制 */
+    size_t AddUnbounded();
+
+    /* planes 来自 Camera::GetFrustumPlanes */
+    void Cull(const glm::vec4 planes[6]);
+
+    bool IsVisible(size_t idx) const;
+
+    /* 上一次 Cull 中可见和被剔除的数量 */
+    size_t GetVisibleNum() const;
+    size_t GetCulledNum() const;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * OpenGL 状态缓存：记录当前绑定的程序、VAO、帧缓冲区、各纹理单元上的纹理，以及深度/模板/混合/面剔除相关的状态，
+ * 要设置的值与记录的值相同时直接跳过GL调用。
+ * 引擎中所有修改这些状态的代码都必须通过这里，绕过它直接调用GL会让记录与实际状态不一致。
+ * 初始时所有状态都是未知的，第一次设置总会调用GL。删除对象时需要调用对应的 OnXxxDeleted，避免对象名被复用后误判为已绑定。
+ * 只能在主线程（持有OpenGL上下文的线程）中使用。
+*/
+class GLStateCache
+{
+  private:
+    static constexpr GLuint UNKNOWN_NAME = ~0u;
+    static constexpr GLuint MAX_TEXTURE_UNIT_NUM = 32;
+
+    /* 只记录引擎使用的纹理类型，其他类型每次都调用GL */
+    enum TextureSlot
+    {
+        TEXTURE_SLOT_2D = 0,
+        TEXTURE_SLOT_CUBE_MAP,
+        TEXTURE_SLOT_BUFFER,
+        TEXTURE_SLOT_NUM,
+    };
+
+    /* 记录开关状态的功能，-1 表示未知 */
+    enum CapabilitySlot
+    {
+        CAPABILITY_DEPTH_TEST = 0,
+        CAPABILITY_STENCIL_TEST,
+        CAPABILITY_BLEND,
+        CAPABILITY_CULL_FACE,
+        CAPABILITY_NUM,
+    };
+
+    GLuint m_program;
+    GLuint m_vertex_array;
+    GLuint m_framebuffer;
+
+    GLuint m_active_texture_unit;
+    GLuint m_textures[MAX_TEXTURE_UNIT_NUM][TEXTURE_SLOT_NUM];
+
+    int8_t m_capabilities[CAPABILITY_NUM];
+
+    // 以下状态的初始值都设置为GL不接受的值，表示未知
+    GLint m_depth_mask;
+    GLenum m_depth_func;
+    GLuint m_stencil_mask;
+    GLenum m_stencil_func;
+    GLint m_stencil_ref;
+    GLuint m_stencil_func_mask;
+    GLenum m_stencil_fail_op, m_stencil_depth_fail_op, m_stencil_pass_op;
+    GLenum m_blend_src, m_blend_dst;
+    GLenum m_cull_face;
+
+    size_t m_issued_num;
+    size_t m_skipped_num;
+
+    GLStateCache();
+
+    static int GetTextureSlot(GLenum target);
+    static int GetCapabilitySlot(GLenum capability);
+
+    /* 记录一次调用，需要调用GL时返回 true */
+    bool Record(bool changed);
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    GLStateCache(const GLStateCache &) = delete;
+    GLStateCache &operator=(const GLStateCache &) = delete;
+    ~GLStateCache();
+
+    // 获取单例实例
+    static GLStateCache &getInstance();
+
+    void UseProgram(GLuint program);
+    void BindVertexArray(GLuint vertexArray);
+
+    /* 只记录 GL_FRAMEBUFFER（同时绑定读和写） */
+    void BindFramebuffer(GLuint framebuffer);
+
+    void ActiveTexture(GLuint unit);
+
+    /* 绑定到当前活动的纹理单元，用于创建和上传纹理 */
+    void BindTexture(GLenum target, GLuint texture);
+
+    /* 把纹理绑定到指定的纹理单元，已经绑定时不会切换活动纹理单元 */
+    void BindTextureUnit(GLuint unit, GLenum target, GLuint texture);
+
+    void Enable(GLenum capability);
+    void Disable(GLenum capability);
+
+    void DepthMask(GLboolean flag);
+    void DepthFunc(GLenum func);
+    void StencilMask(GLuint mask);
+    void StencilFunc(GLenum func, GLint ref, GLuint mask);
+    void StencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass);
+    void BlendFunc(GLenum src, GLenum dst);
+    void CullFace(GLenum mode);
+
+    void OnProgramDeleted(GLuint program);
+    void OnVertexArrayDeleted(GLuint vertexArray);
+    void OnFramebufferDeleted(GLuint framebuffer);
+    void OnTextureDeleted(GLuint texture);
+
+    /* 把所有状态标记为未知，例如其他库直接修改了GL状态之后 */
+    void Invalidate();
+
+    /* 实际调用GL的次数和被跳过的次数，Game 在每帧开始时清零，并把每帧的结果显示在窗口标题中 */
+    size_t GetIssuedNum() const;
+    size_t GetSkippedNum() const;
+    void ResetCounters();
+};
@@ -2,6 +2,7 @@
 
 #include "Scene.h"
 #include "GLFW/glfw3.h"
+#include <string>
 
 class Game
 {
@@ -12,6 +13,11 @@ class Game
 
     Scene scene;
 
+    // 窗口标题中的统计信息每隔一段时间刷新一次，帧率为这段时间内的平均值
+    std::string title;
+    double stats_start_time;
+    int stats_frame_num;
+
     void SetupWindowHint() const;
 
     void SetupGLDebugContext() const;
@@ -24,6 +30,9 @@ class Game
 
     void QueryMaxVertexAndFragmentUniformComponents() const;
 
+    /* 每帧调用，把帧率、本帧可见/被剔除的绘制数量和GL状态缓存的计数显示在窗口标题中 */
+    void UpdateStats();
+
   public:
     // 删除复制构造函数和赋值操作符
     Game(const Game &) = delete;
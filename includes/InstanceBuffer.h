@@ -0,0 +1,59 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include <cstddef>
+
+/*
+ * 实例化绘制的逐实例顶点属性位置，与 shaders/instance_attributes.glsl 一致。
+ * 从8开始，避开网格自己的顶点属性（0, 1, 2, ...），mat4 占4个位置，mat3 占3个位置，最后一个位置为15。
+*/
+enum InstanceAttribute : GLuint
+{
+    INSTANCE_ATTRIBUTE_MODEL = 8,
+    INSTANCE_ATTRIBUTE_NORMAL_MATRIX = 12,
+    INSTANCE_ATTRIBUTE_CUSTOM = 15,
+};
+
+/*
+ * 一个实例的数据：模型矩阵、法线矩阵和一个自定义的 vec4（例如颜色或动画相位）。
+ * 法线矩阵的每一列补齐为 vec4，着色器按 mat3 读取每列的前3个分量。
+*/
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 normal_matrix[3];
+    glm::vec4 custom;
+
+    static InstanceData Make(const glm::mat4 &model, const glm::vec4 &custom = glm::vec4(0.0f));
+};
+
+static_assert(sizeof(InstanceData) == 128, "InstanceData must be tightly packed");
+
+/*
+ * 保存逐实例数据的顶点缓冲区，通过 Mesh::SetInstanceBuffer 关联到网格的 VAO 后，
+ * 用 Mesh::DrawInstanced 一次绘制所有实例，代替逐个设置模型矩阵再绘制。
+*/
+class InstanceBuffer
+{
+  private:
+    GLuint m_vbo;
+    size_t m_capacity; // 可以保存的实例数量
+    size_t m_instance_num;
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    InstanceBuffer(const InstanceBuffer &) = delete;
+    InstanceBuffer &operator=(const InstanceBuffer &) = delete;
+
+    InstanceBuffer(size_t capacity);
+    ~InstanceBuffer();
+
+    /* 用 instances 替换缓冲区的内容，超过容量时扩大缓冲区（缓冲区对象不变，已关联的网格不需要重新设置） */
+    bool Update(const InstanceData *instances, size_t instanceNum);
+
+    GLuint GetBufferID() const;
+
+    size_t GetInstanceNum() const;
+    size_t GetCapacity() const;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* 参与分簇的点光源或聚光灯：观察空间中的位置和影响半径 */
+struct ClusterLight
+{
+    glm::vec3 view_pos;
+    float range;
+};
+
+/* 一个簇在灯光索引表中的范围 */
+struct ClusterRange
+{
+    uint32_t offset;
+    uint32_t count;
+};
+
+/*
+ * 分簇光照（clustered forward）的CPU端剔除，不调用任何gl函数。
+ * 把相机视锥体划分为 GRID_X * GRID_Y * GRID_Z 个簇（froxel）：x、y 方向在NDC中均匀划分，
+ * z 方向在 [near, far] 之间按观察空间深度指数划分，越远的簇越厚。
+ * 每个簇使用包围它的观察空间AABB，与灯光的包围球相交时该灯光属于这个簇。
+ * Build 的结果是每个簇在灯光索引表中的范围和紧凑的灯光索引表，簇内的索引按灯光下标升序排列。
+ * 簇的下标为 (z * GRID_Y + y) * GRID_X + x。
+*/
+class LightCluster
+{
+  public:
+    static constexpr uint32_t GRID_X = 16;
+    static constexpr uint32_t GRID_Y = 9;
+    static constexpr uint32_t GRID_Z = 24;
+    static constexpr uint32_t CLUSTER_NUM = GRID_X * GRID_Y * GRID_Z;
+
+    // 灯光索引表的容量，超出时后面的簇会丢失部分灯光
+    static constexpr size_t MAX_LIGHT_INDEX_NUM = 65536;
+
+  private:
+    // 构建簇AABB时使用的投影参数，变化时才重新计算
+    float m_proj_x, m_proj_y, m_near, m_far;
+
+    /*
+     * 簇AABB的 x 范围只与簇所在的列和层有关，y 范围只与行和层有关，所以分开保存。
+     * 第 z 层的深度范围为 [m_slice_depths[z], m_slice_depths[z + 1]]。
+    */
+    float m_slice_depths[GRID_Z + 1];
+    glm::vec2 m_x_bounds[GRID_Z][GRID_X];
+    glm::vec2 m_y_bounds[GRID_Z][GRID_Y];
+
+    std::vector<ClusterRange> m_clusters;
+    std::vector<uint16_t> m_light_indices;
+
+    // 每层的临时结果：层内的簇范围（offset 相对于该层）和灯光索引
+    struct SliceResult
+    {
+        ClusterRange clusters[GRID_X * GRID_Y];
+        std::vector<uint16_t> light_indices;
+        std::vector<uint32_t> pairs; // 高16位为层内簇下标，低16位为灯光下标
+    };
+    std::vector<SliceResult> m_slices;
+
+    size_t m_dropped_num;
+
+    void SetupGrid(const glm::mat4 &projection, float near, float far);
+
+    /* 簇 (x, y, z) 的观察空间AABB与包围球是否相交 */
+    bool Intersects(uint32_t x, uint32_t y, uint32_t z, const ClusterLight &light) const;
+
+    void CullSlice(uint32_t z, const std::vector<ClusterLight> &lights);
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    LightCluster(const LightCluster &) = delete;
+    LightCluster &operator=(const LightCluster &) = delete;
+
+    LightCluster();
+    ~LightCluster();
+
+    /*
+     * projection 为对称的透视投影矩阵，near / far 为它的近、远裁剪面，lights 的下标即灯光索引（最多65536个）。
+     * 各层在线程池中并行剔除，返回时结果已经完整。
+    */
+    void Build(const glm::mat4 &projection, float near, float far, const std::vector<ClusterLight> &lights);
+
+    /*
+     * 逐簇逐灯光测试的参考实现，单线程执行，结果应与 Build 完全相同，由 tests/LightClusterTest 验证。
+    */
+    void BuildReference(const glm::mat4 &projection, float near, float far, const std::vector<ClusterLight> &lights);
+
+    const std::vector<ClusterRange> &GetClusters() const;
+    const std::vector<uint16_t> &GetLightIndices() const;
+
+    /* 由于索引表容量不足而丢失的灯光索引数量 */
+    size_t GetDroppedNum() const;
+
+    /* 着色器根据观察空间深度 d 计算簇的层号：floor(log(d) * scale + bias) */
+    glm::vec2 GetDepthSliceParams() const;
+};
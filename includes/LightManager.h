@@ -0,0 +1,115 @@
+#pragma once
+
+#include "BaseLight.h"
+#include "DirectionLight.h"
+#include "FrameRingBuffer.h"
+#include "LightCluster.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+#include "TextureBuffer.h"
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <vector>
+
+class Camera;
+
+/*
+ * 与 shaders/light_block.glsl 中的 LightBlock 对应的 std140 布局，所有成员都是 vec4，不需要额外的填充。
+ * 点光源和聚光灯使用同一种结构：点光源的内外切光角余弦值为 -1/-2，锥形衰减恒为1，着色器中不需要分支。
+*/
+struct DirectionLightData
+{
+    glm::vec4 direction; // xyz 方向
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+};
+
+struct LocalLightData
+{
+    glm::vec4 position;  // xyz 位置，w 常量衰减系数
+    glm::vec4 direction; // xyz 聚光方向，w 内切光角的余弦值
+    glm::vec4 ambient;   // w 外切光角的余弦值
+    glm::vec4 diffuse;   // w 一次衰减系数
+    glm::vec4 specular;  // w 二次衰减系数
+};
+
+/*
+ * 数组长度必须与 light_block.glsl 中的 MAX_DIRECTION_LIGHT_NUM / MAX_LOCAL_LIGHT_NUM 一致。
+ * 整个 block 不超过 16KB（GL_MAX_UNIFORM_BLOCK_SIZE 的最小保证值），所有驱动上都可以使用。
+*/
+struct LightBlockData
+{
+    static constexpr size_t MAX_DIRECTION_LIGHT_NUM = 4;
+    static constexpr size_t MAX_LOCAL_LIGHT_NUM = 192;
+
+    glm::ivec4 light_counts;        // x 方向光数量，y 点光源和聚光灯的总数
+    glm::ivec4 cluster_size;        // xyz 簇网格的尺寸
+    glm::vec4 cluster_depth_params; // xy 由观察空间深度计算簇层号的 scale 和 bias，见 LightCluster
+    DirectionLightData direction_lights[MAX_DIRECTION_LIGHT_NUM];
+    LocalLightData local_lights[MAX_LOCAL_LIGHT_NUM];
+};
+
+static_assert(sizeof(LightBlockData) <= 16384, "LightBlock must fit in the minimum GL_MAX_UNIFORM_BLOCK_SIZE");
+
+/*
+ * 场景中所有灯光的所有者。每帧调用一次 Update，把所有灯光打包到 FrameRingBuffer 中分配的一段（绑定到 UNIFORM_BLOCK_LIGHT），
+ * 声明了 LightBlock 的着色器遍历其中的灯光，不需要再为每个着色器、每个网格设置灯光的 uniform。
+ * 点光源和聚光灯还会按相机视锥体分簇（见 LightCluster），每个簇的灯光索引表上传到两个缓冲区纹理，
+ * 着色器（见 light_cluster.glsl）只计算片元所在簇中的灯光。
+*/
+class LightManager
+{
+  private:
+    FrameRingBuffer *m_ring;
+
+    std::vector<DirectionLight *> m_direction_lights;
+    std::vector<PointLight *> m_local_lights; // 点光源和聚光灯
+
+    LightBlockData m_data;
+
+    LightCluster m_cluster;
+    std::vector<ClusterLight> m_cluster_lights;
+
+    // 每个簇的 (offset, count)（GL_RG32UI）和所有簇的灯光索引（GL_R16UI）
+    TextureBuffer *m_cluster_grid;
+    TextureBuffer *m_cluster_light_indices;
+
+    bool m_overflow_reported;
+
+    void Pack();
+
+    /* 在线程池中剔除各簇的灯光并上传索引表 */
+    void BuildClusters(Camera &camera);
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    LightManager(const LightManager &) = delete;
+    LightManager &operator=(const LightManager &) = delete;
+
+    LightManager();
+    ~LightManager();
+
+    /* 创建分簇使用的缓冲区纹理，LightBlock 每帧从 ring 中分配，ring 需要先初始化 */
+    bool Init(FrameRingBuffer *ring);
+
+    /*
+     * 添加灯光并获得其所有权，之后可以继续通过该指针修改灯光（例如移动位置），下一次 Update 时生效。
+     * 同类灯光数量超过上限时返回 false，此时所有权仍属于调用者。
+    */
+    bool AddLight(BaseLight *light);
+
+    /* 移除并删除灯光 */
+    void RemoveLight(BaseLight *light);
+
+    void Clear();
+
+    /* 每帧在 FrameRingBuffer::BeginFrame 之后调用一次，打包所有灯光、按相机重新分簇并上传 */
+    void Update(Camera &camera);
+
+    size_t GetDirectionLightNum() const;
+    size_t GetLocalLightNum() const;
+
+    const std::vector<PointLight *> &GetLocalLights() const;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * 以只读方式把整个文件映射到进程地址空间，文件内容按需由操作系统分页读入，不需要额外拷贝到用户缓冲区。
+*/
+class MappedFile
+{
+  private:
+    const uint8_t *m_data;
+    size_t m_size;
+
+#ifdef _WIN32
+    void *m_file_handle;
+    void *m_mapping_handle;
+#else
+    int m_fd;
+#endif
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile();
+    ~MappedFile();
+
+    bool Open(const std::string &path);
+    void Close();
+
+    bool IsOpen() const;
+
+    const uint8_t *GetData() const;
+    size_t GetSize() const;
+
+    /* 文件内容的 FNV-1a 64位哈希，用于判断缓存是否过期 */
+    uint64_t ComputeHash() const;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Shader.h"
+#include "Texture.h"
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * 轻量的材质对象：引用一个（可能被多个材质共享的）着色器程序，并保存各个网格之间不同的参数，
+ * 例如漫反射/高光纹理和反光度。绘制前调用 Use() 把这些参数绑定到程序上。
+*/
+class Material
+{
+  private:
+    // 参数名在设置时转换为 UniformId，绑定时不再处理字符串
+    struct TextureParam
+    {
+        std::string name;
+        UniformId id;
+        const Texture *texture;
+    };
+
+    struct FloatParam
+    {
+        std::string name;
+        UniformId id;
+        GLfloat value;
+    };
+
+    struct Vec3Param
+    {
+        std::string name;
+        UniformId id;
+        glm::vec3 value;
+    };
+
+    Shader *m_shader;
+
+    // 创建时分配的唯一编号，用作渲染队列排序键中的材质部分
+    uint32_t m_sort_id;
+
+    static std::atomic<uint32_t> next_sort_id;
+
+    std::vector<TextureParam> m_textures;
+    std::vector<FloatParam> m_floats;
+    std::vector<Vec3Param> m_vec3s;
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    Material(const Material &) = delete;
+    Material &operator=(const Material &) = delete;
+
+    Material(Shader *shader);
+    ~Material();
+
+    /* 纹理按设置的顺序依次占用纹理单元 0, 1, 2, ... */
+    void SetTexture(const std::string &name, const Texture *texture);
+    void SetFloat(const std::string &name, const GLfloat value);
+    void SetVec3f(const std::string &name, const glm::vec3 &value);
+
+    Shader *GetShader() const;
+
+    uint32_t GetSortId() const;
+
+    void Use() const;
+};
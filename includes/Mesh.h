@@ -1,8 +1,12 @@
 #pragma once
 
+#include "InstanceBuffer.h"
+#include "Material.h"
+#include "MeshData.h"
 #include "Shader.h"
 #include "glad/glad.h"
 #include "VertexAttribute.h"
+#include "glm/glm.hpp"
 
 class Mesh
 {
@@ -15,12 +19,45 @@ class Mesh
 
     Shader *shader;
 
+    Material *material; // 不为空时，绘制前通过材质绑定参数
+
+    std::vector<MeshLod> lods; // 为空时绘制整个索引缓冲区
+    size_t lod_index;          // 当前绘制的 LOD
+
+    // 位置被量化时，绘制前把还原参数传给着色器（positionScale/positionOffset）
+    bool quantized;
+    glm::vec3 position_scale;
+    glm::vec3 position_offset;
+
+    /*
+     * 顶点位置的包围盒，在 SetupMesh 上传顶点数据时计算，之后不再保留顶点数据。
+     * 位置被量化时保存的是量化后的范围，GetBoundingBox 再用还原参数换算。
+     * 位置属性的格式不支持时 has_bounds 为 false，此时网格总是被视为可见。
+    */
+    bool has_bounds;
+    glm::vec3 bounds_min;
+    glm::vec3 bounds_max;
+
+    // 不为空时 VAO 中关联了逐实例属性，可以调用 DrawInstanced
+    const InstanceBuffer *instance_buffer;
+
     void SetupMesh(const std::vector<GLfloat> &vertices, const std::vector<GLuint> &indices,
                    const std::vector<VertexAttribute> &attributes);
 
+    void SetupMesh(const GLfloat *vertices, size_t vertexFloatNum, const GLuint *indices, size_t indexNum,
+                   const std::vector<VertexAttribute> &attributes);
+
+    void SetupMesh(const void *vertexData, size_t vertexBytes, const GLuint *indices, size_t indexNum,
+                   const std::vector<VertexAttribute> &attributes);
+
     /* 只希望在子类中调用 */
     Mesh(Shader *shader);
 
+    void BindVertexArray() const;
+
+    /* 从第0个顶点属性（位置）计算包围盒 */
+    void ComputeBounds(const void *vertexData, size_t vertexBytes, const VertexAttribute &position);
+
   public:
     ~Mesh();
 
@@ -31,9 +68,70 @@ class Mesh
     Mesh(const std::vector<GLfloat> &vertices, const std::vector<GLuint> &indices,
          const std::vector<VertexAttribute> &attributes, Shader *shader);
 
+    /* 顶点和索引数据可以来自任意连续内存（例如映射到内存中的缓存文件） */
+    Mesh(const GLfloat *vertices, size_t vertexFloatNum, const GLuint *indices, size_t indexNum,
+         const std::vector<VertexAttribute> &attributes, Shader *shader);
+
+    /* 任意格式的顶点数据（例如压缩后的顶点），由 attributes 描述其布局 */
+    Mesh(const void *vertexData, size_t vertexBytes, const GLuint *indices, size_t indexNum,
+         const std::vector<VertexAttribute> &attributes, Shader *shader);
+
     void Draw() const;
 
+    /*
+     * 用指定的着色器和材质（可以为空）绘制，不改变网格自己的着色器和材质，
+     * 用于同一个网格在一帧中以不同的着色器绘制多次（例如轮廓）。
+    */
+    void Draw(Shader &drawShader, Material *drawMaterial) const;
+
+    /*
+     * 把逐实例属性（模型矩阵、法线矩阵和自定义数据）关联到网格的 VAO，为空时取消关联。
+     * 着色器需要以 INSTANCED 宏编译并引入 instance_attributes.glsl。
+    */
+    void SetInstanceBuffer(const InstanceBuffer *buffer);
+
+    /* 一次绘制调用绘制实例缓冲区中的前 instanceNum 个实例（超出缓冲区中的实例数量时只绘制已有的），不会设置 model / normalMatrix uniform */
+    void DrawInstanced(GLsizei instanceNum) const;
+    void DrawInstanced(GLsizei instanceNum, Shader &drawShader, Material *drawMaterial) const;
+
+    /* 把位置的还原参数写入着色器（位置未量化时什么都不做），uniform 在着色器的 Use() 中才会上传 */
+    void SetQuantizationUniforms() const;
+    void SetQuantizationUniforms(Shader &drawShader) const;
+
+    /*
+     * 在一次调用中绘制多段索引范围，不会绑定材质，
+     * 调用前需要先调用 SetQuantizationUniforms，再准备好着色器程序和纹理。
+    */
+    void MultiDraw(const GLsizei *counts, const void *const *indexOffsets, const GLint *baseVertices,
+                   GLsizei drawNum) const;
+
+    /*
+     * 与 MultiDraw 相同，但绘制参数从间接绘制缓冲区中读取，需要 OpenGL 4.3。
+    */
+    void MultiDrawIndirect(GLuint indirectBuffer, size_t byteOffset, GLsizei drawNum) const;
+
     Shader &GetShader() const;
 
     void ChangeShader(Shader *shader);
+
+    void SetMaterial(Material *material);
+    Material *GetMaterial() const;
+
+    /*
+     * 设置量化位置的还原参数，着色器需要以 QUANTIZED_POSITION 宏编译。
+    */
+    void SetPositionDequantization(const glm::vec3 &scale, const glm::vec3 &offset);
+
+    /*
+     * 设置各级 LOD 在索引缓冲区中的范围，第0级最精细。
+    */
+    void SetLods(const MeshLod *meshLods, size_t lodNum);
+    void SelectLod(size_t lodIndex);
+
+    /* 模型空间下的包围盒和包围球，没有包围盒时返回 false */
+    bool GetBoundingBox(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const;
+    bool GetBoundingSphere(glm::vec3 &center, float &radius) const;
+
+    size_t GetLodNum() const;
+    const MeshLod *GetLod(size_t lodIndex) const;
 };
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "MeshData.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * 模型网格的二进制缓存。
+ * 缓存文件保存在源模型文件旁边（<模型路径>.meshcache），包含每个网格交错排列的顶点、索引、LOD 范围、材质纹理路径和包围盒。
+ * 读取时直接把文件映射到内存，顶点与索引指针指向映射区域，不再经过 Assimp 解析。
+*/
+class MeshCache
+{
+  private:
+    MappedFile m_file;
+
+    std::vector<MeshMaterialData> m_materials;
+    std::vector<MeshView> m_meshes;
+
+  public:
+    /* 缓存格式版本，修改文件布局或网格预处理流程后需要递增 */
+    static constexpr uint32_t VERSION = 3;
+
+    // 删除复制构造函数和赋值操作符
+    MeshCache(const MeshCache &) = delete;
+    MeshCache &operator=(const MeshCache &) = delete;
+
+    MeshCache();
+    ~MeshCache();
+
+    /*
+     * 打开缓存文件，只有当版本号和源文件哈希都匹配时才返回true。
+     * 返回的网格视图在 MeshCache 对象销毁前一直有效。
+    */
+    bool Open(const std::string &cachePath, uint64_t sourceHash);
+
+    const std::vector<MeshView> &GetMeshes() const;
+
+    static bool Write(const std::string &cachePath, uint64_t sourceHash, const std::vector<MeshData> &meshes);
+
+    static std::string GetCachePath(const std::string &sourcePath);
+
+    /* 计算源文件内容的 FNV-1a 64位哈希 */
+    static bool HashFile(const std::string &path, uint64_t &hash);
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * 网格引用的材质纹理，路径相对于模型文件所在目录。
+*/
+struct MeshMaterialData
+{
+    std::vector<std::string> diffuse_textures;
+    std::vector<std::string> specular_textures;
+};
+
+/*
+ * 一级 LOD 在索引数组中的范围。所有 LOD 共享同一组顶点，只是索引不同。
+ * error 是该级相对原始网格的简化误差，以网格包围盒对角线长度的比例表示。
+*/
+struct MeshLod
+{
+    uint32_t index_offset;
+    uint32_t index_num;
+    float error;
+};
+
+/*
+ * 网格在CPU侧的中间数据，由Assimp转换得到，可以在工作线程中生成，之后再交给主线程创建OpenGL缓冲区。
+*/
+struct MeshData
+{
+    /* 位置-法线-纹理坐标 交错排列的顶点数据 */
+    std::vector<GLfloat> vertices;
+
+    /* 三角形索引，依次存放从精细到粗糙的各级 LOD */
+    std::vector<GLuint> indices;
+
+    /* 各级 LOD 的索引范围，第0级是原始网格 */
+    std::vector<MeshLod> lods;
+
+    /* 在 aiScene::mMaterials 中的材质下标 */
+    unsigned int material_index = 0;
+
+    MeshMaterialData material;
+
+    /* 模型空间下的包围盒 */
+    glm::vec3 bounds_min = glm::vec3(0.0f);
+    glm::vec3 bounds_max = glm::vec3(0.0f);
+};
+
+/*
+ * 网格数据的只读视图，顶点和索引既可以指向 MeshData 中的数组，也可以直接指向映射到内存中的缓存文件。
+*/
+struct MeshView
+{
+    const GLfloat *vertices = nullptr;
+    size_t vertex_float_num = 0;
+
+    const GLuint *indices = nullptr;
+    size_t index_num = 0;
+
+    const MeshLod *lods = nullptr;
+    size_t lod_num = 0;
+
+    unsigned int material_index = 0;
+
+    const MeshMaterialData *material = nullptr;
+
+    glm::vec3 bounds_min = glm::vec3(0.0f);
+    glm::vec3 bounds_max = glm::vec3(0.0f);
+
+    static MeshView FromData(const MeshData &meshData)
+    {
+        MeshView view;
+        view.vertices = meshData.vertices.data();
+        view.vertex_float_num = meshData.vertices.size();
+        view.indices = meshData.indices.data();
+        view.index_num = meshData.indices.size();
+        view.lods = meshData.lods.data();
+        view.lod_num = meshData.lods.size();
+        view.material_index = meshData.material_index;
+        view.material = &meshData.material;
+        view.bounds_min = meshData.bounds_min;
+        view.bounds_max = meshData.bounds_max;
+        return view;
+    }
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * 网格优化的统计结果。
+ * ACMR（Average Cache Miss Ratio）是每个三角形平均引起的顶点变换缓存未命中次数，
+ * 取值范围约为 0.5 ~ 3.0，越小说明顶点着色器的重复计算越少。
+*/
+struct MeshOptimizeStats
+{
+    size_t triangle_num;
+    size_t vertex_num_before;
+    size_t vertex_num_after;
+    float acmr_before;
+    float acmr_after;
+};
+
+/*
+ * 在调用 Mesh::SetupMesh 之前对交错排列的顶点/索引数组进行优化，只做CPU计算，可以在工作线程中执行。
+ * 顶点数组中每个顶点占 stride 个浮点数，且前3个分量必须是位置（所有预定义布局都满足这一点）。
+*/
+class MeshOptimizer
+{
+  public:
+    static constexpr unsigned int CACHE_SIZE = 16; // 模拟的FIFO顶点缓存大小，用于计算 ACMR
+
+    /*
+     * 依次执行顶点焊接、顶点缓存优化、过度绘制优化和顶点读取顺序优化，返回优化前后的统计结果。
+    */
+    static MeshOptimizeStats Optimize(std::vector<GLfloat> &vertices, std::vector<GLuint> &indices, size_t stride);
+
+    /*
+     * 合并所有分量完全相同的顶点，并重写索引，返回焊接后的顶点数量。
+    */
+    static size_t WeldVertices(std::vector<GLfloat> &vertices, std::vector<GLuint> &indices, size_t stride);
+
+    /*
+     * 使用 Tom Forsyth 的线性时间算法重新排列三角形，让相邻三角形尽量复用顶点缓存中的顶点。
+    */
+    static void OptimizeVertexCache(std::vector<GLuint> &indices, size_t vertexNum);
+
+    /*
+     * 在不明显破坏顶点缓存局部性的前提下，把三角形序列切分成若干簇，朝外的簇排在前面先绘制，减少过度绘制。
+     * threshold 是允许的 ACMR 上升比例，应在 OptimizeVertexCache 之后调用。
+    */
+    static void OptimizeOverdraw(std::vector<GLuint> &indices, const std::vector<GLfloat> &vertices, size_t stride,
+                                 float threshold = 1.05f);
+
+    /*
+     * 按照顶点在索引中第一次出现的顺序重新排列顶点数组，提高顶点读取的内存局部性，未被引用的顶点会被移除。
+    */
+    static void OptimizeVertexFetch(std::vector<GLfloat> &vertices, std::vector<GLuint> &indices, size_t stride);
+
+    /*
+     * 模拟大小为 cacheSize 的FIFO顶点缓存，计算索引序列的 ACMR。
+    */
+    static float ComputeACMR(const std::vector<GLuint> &indices, size_t vertexNum, unsigned int cacheSize = CACHE_SIZE);
+
+  private:
+    // 禁止实例化该类
+    MeshOptimizer() = delete;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * 基于二次误差度量（QEM）的网格简化，用于生成 LOD。
+ * 只做边折叠：被折叠的顶点直接并入边的另一个端点，不移动也不新增顶点，因此所有 LOD 可以共享同一个顶点缓冲区，只需要不同的索引。
+ * 边界边上的顶点和接缝顶点（位置相同但法线/纹理坐标不同）不会被折叠，保证轮廓和纹理不被撕裂。
+ * 只做CPU计算，结果只取决于输入数据（候选边按误差和下标排序），相同输入总是得到相同输出。
+*/
+class MeshSimplifier
+{
+  public:
+    /*
+     * 把索引数量简化到 targetIndexNum 附近，或者在误差超过 targetError 时停止。
+     * targetError 是相对于网格包围盒对角线长度的比例，resultError 返回实际达到的相对误差。
+     * 顶点数组中每个顶点占 stride 个浮点数，且前3个分量是位置。
+    */
+    static std::vector<GLuint> Simplify(const GLfloat *vertices, size_t vertexNum, size_t stride,
+                                        const GLuint *indices, size_t indexNum, size_t targetIndexNum,
+                                        float targetError, float *resultError = nullptr);
+
+  private:
+    // 禁止实例化该类
+    MeshSimplifier() = delete;
+};
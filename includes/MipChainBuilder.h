@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct MipLevel
+{
+    int width, height;
+    size_t offset, size;
+};
+
+/*
+ * 8位像素的完整 mip 链，各级像素紧密排列（行之间没有对齐填充），依次存放在 data 中。
+*/
+struct MipChain
+{
+    int width = 0, height = 0;
+    int channel_num = 0;
+
+    /* 第0级是原始图像，最后一级是 1x1 */
+    std::vector<MipLevel> levels;
+
+    std::vector<uint8_t> data;
+};
+
+/*
+ * 在CPU上生成 mip 链，代替加载时的 glGenerateMipmap（软件实现的OpenGL中非常慢），结果可以逐级上传。
+ * 每一级由上一级经 2x2 盒式滤波得到，滤波在线性空间中进行：sRGB 编码的颜色通道先转换为线性值，
+ * 求平均后再编码回 sRGB，避免直接平均 sRGB 值导致缩小后的图像偏暗。中间结果保留为浮点数，不会逐级累积量化误差。
+ * 同一级内按行分块在线程池中并行处理，可以在工作线程中调用。
+*/
+class MipChainBuilder
+{
+  public:
+    /* 缓存格式版本，修改文件布局或滤波方式后需要递增 */
+    static constexpr uint32_t VERSION = 2;
+
+    /*
+     * pixels 为 width*height*channelNum 字节的图像，channelNum 为 1、3 或 4（stbi_load 的输出）。
+     * srgb 为 true 时颜色通道按 sRGB 编码处理，4通道图像的 alpha 始终按线性值处理。
+    */
+    static void Build(const uint8_t *pixels, int width, int height, int channelNum, bool srgb, MipChain &chain);
+
+    /*
+     * 与 Build 相同，但结果写入调用方分配的内存，levels 由 ComputeLevels 得到，output 至少需要其返回的字节数。
+     * 用于把多张图像的 mip 链放在同一块内存中（例如立方体贴图的6个面）。
+    */
+    static void BuildInto(const uint8_t *pixels, int width, int height, int channelNum, bool srgb,
+                          const std::vector<MipLevel> &levels, uint8_t *output);
+
+    /* 计算完整 mip 链中各级的尺寸和偏移量，返回总字节数 */
+    static size_t ComputeLevels(int width, int height, int channelNum, std::vector<MipLevel> &levels);
+
+    /*
+     * 解码图片（上下翻转，与OpenGL纹理坐标一致）并生成 mip 链，srgb 与 Build 相同，由调用方根据贴图的用途决定
+     * （颜色贴图为 true，高光、法线等数据贴图为 false），不能从通道数推断。
+     * persist 为 true 时结果保存在源图片旁边（<图片路径>.mips），源文件内容未变时直接读取，跳过解码和滤波；
+     * 缓存文件与未压缩的图像一样大，默认不保存。
+    */
+    static bool Load(const std::string &sourcePath, bool srgb, MipChain &chain, bool persist = false);
+
+    static std::string GetCachePath(const std::string &sourcePath);
+
+    /* 完整 mip 链的级数：floor(log2(max(width, height))) + 1 */
+    static int GetLevelNum(int width, int height);
+
+  private:
+    // 禁止实例化该类
+    MipChainBuilder() = delete;
+
+    static bool ReadCache(const std::string &cachePath, uint64_t sourceHash, bool srgb, MipChain &chain);
+    static bool WriteCache(const std::string &cachePath, uint64_t sourceHash, bool srgb, const MipChain &chain);
+};
@@ -1,26 +1,92 @@
 #pragma once
 
+#include "Material.h"
 #include "Mesh.h"
-#include "ShaderUnit.h"
+#include "MeshData.h"
+#include "MeshOptimizer.h"
+#include "Shader.h"
 #include "Texture2D.h"
 #include "assimp/scene.h"
 #include <functional>
+#include <unordered_map>
 #include <vector>
 
 class Model
 {
   private:
-    std::vector<Mesh *> m_meshes;
-    std::vector<Shader *> m_shaders;
+    /*
+     * 合并缓冲区中的一个子网格：顶点从 base_vertex 开始，各级 LOD 的索引范围相对于整个索引缓冲区。
+    */
+    struct SubMesh
+    {
+        GLint base_vertex;
+        std::vector<MeshLod> lods;
+        size_t lod_index;
+        Material *material;
+    };
+
+    /*
+     * 使用同一个材质的子网格，它们的绘制参数在参数数组中从 command_offset 开始连续存放。
+    */
+    struct DrawGroup
+    {
+        Material *material;
+        std::vector<size_t> submeshes;
+        size_t command_offset;
+    };
+
+    /* 与 glMultiDrawElementsIndirect 要求的内存布局一致 */
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint base_instance;
+    };
+
+    std::vector<Mesh *> m_meshes; // 所有子网格合并后的顶点/索引缓冲区
+    Shader *m_shader; // 从 ShaderRegistry 获取的共享程序
+
+    std::unordered_map<unsigned int, Material *> m_materials; // aiMaterial 下标 -> 材质
     std::vector<Texture2D *> m_textures;
 
     std::string m_directory;
 
+    // 模型空间下所有子网格的包围盒
+    glm::vec3 m_bounds_min;
+    glm::vec3 m_bounds_max;
+
+    // 各级 LOD 允许的相对简化误差（相对于网格包围盒对角线）
+    static constexpr float LOD_TARGET_ERRORS[] = {0.005f, 0.01f, 0.02f, 0.04f};
+
+    // 允许的简化误差在屏幕上的最大投影大小（相对于屏幕高度），约为1个像素
+    static constexpr float LOD_SCREEN_ERROR = 0.002f;
+
+    std::vector<SubMesh> m_submeshes;
+    std::vector<DrawGroup> m_draw_groups;
+
+    // 按分组顺序排列的绘制参数，分别供 glMultiDrawElementsBaseVertex 和间接绘制使用
+    std::vector<GLsizei> m_draw_counts;
+    std::vector<const void *> m_draw_offsets;
+    std::vector<GLint> m_draw_base_vertices;
+    std::vector<DrawElementsIndirectCommand> m_draw_commands;
+
+    GLuint m_indirect_buffer; // 不支持间接绘制时为0
+
     void LoadModel(const std::string &path);
 
-    void ProcessNode(aiNode *node, const aiScene *scene, ShaderUnit &vertexUnit, ShaderUnit &fragmentUnit);
-    Mesh *ProcessMesh(aiMesh *mesh, const aiScene *scene, ShaderUnit &vertexUnit, ShaderUnit &fragmentUnit);
-    std::vector<Texture2D *> LoadMaterialTextures(const aiMaterial *mat, const aiTextureType type);
+    void ProcessNode(const aiNode *node, const aiScene *scene, std::vector<const aiMesh *> &meshes);
+    void CreateMeshes(const std::vector<MeshView> &meshViews);
+    void UpdateDrawCommands();
+    Material *GetOrCreateMaterial(const MeshView &meshView);
+    std::vector<Texture2D *> LoadMaterialTextures(const std::vector<std::string> &paths,
+                                                  TextureCompression compression);
+
+    static void ConvertMesh(const aiScene *scene, const aiMesh *mesh, MeshData &meshData);
+    static void CollectTexturePaths(const aiMaterial *mat, const aiTextureType type, std::vector<std::string> &paths);
+    static void GenerateLods(MeshData &meshData);
+    static void PrintOptimizeStats(const std::string &path, const std::vector<MeshOptimizeStats> &stats);
 
   public:
     // 删除复制构造函数和赋值操作符
@@ -33,5 +99,18 @@ class Model
     void ForeachMesh(std::function<void(Mesh *)> func) const;
     void Draw() const;
 
+    /*
+     * 模型空间下的包围盒和包围球。
+    */
+    void GetBoundingBox(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const;
+    void GetBoundingSphere(glm::vec3 &center, float &radius) const;
+
+    /*
+     * 根据包围球在屏幕上的大小（直径相对于屏幕高度的比例）为每个子网格选择 LOD。
+    */
+    void SelectLod(float screenSize);
+
     bool HasValidMesh() const;
+
+    Shader *GetShader() const;
 };
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * 软件光栅化的遮挡剔除，不调用任何gl函数。
+ * 每帧先用 AddOccluder 把少量指定的遮挡体（简化的、完全位于原网格内部的三角形网格）加入，
+ * Rasterize 把它们光栅化到低分辨率的深度缓冲区：屏幕划分为若干图块，图块在线程池中并行处理，
+ * x86 上每次用 SSE 计算4个像素，其他平台使用标量实现。之后按2x2取最远深度逐级生成深度金字塔。
+ * IsVisible 把被遮挡物的世界空间包围盒投影到屏幕上，在覆盖范围不超过4x4个像素的金字塔层级中
+ * 取最远的遮挡深度，包围盒最近的深度仍比它更远时才被视为不可见。
+ * 深度为 NDC 深度映射到 [0, 1]，越小越近，清空为1。
+ * 跨过近平面的遮挡三角形直接丢弃，跨过近平面的包围盒总是可见，这两种情况只会少剔除。
+ * 遮挡体只在覆盖像素中心时写入深度，所以在遮挡体轮廓附近不足一个像素的缝隙中可见的物体可能被剔除。
+*/
+class OcclusionCuller
+{
+  public:
+    static constexpr uint32_t TILE_WIDTH = 32;
+    static constexpr uint32_t TILE_HEIGHT = 16;
+
+  private:
+    /*
+     * 设置好的屏幕空间三角形，像素坐标以像素为单位，像素中心在 +0.5 处。
+     * 第 i 条边的边函数为 edge_a[i] * x + edge_b[i] * y + edge_c[i]，三条边都不小于0时像素中心在三角形内，
+     * 深度为 depth_plane.x * x + depth_plane.y * y + depth_plane.z。
+    */
+    struct Triangle
+    {
+        glm::vec3 edge_a, edge_b, edge_c;
+        glm::vec3 depth_plane;
+        int32_t min_x, min_y, max_x, max_y; // 覆盖的像素范围（包含两端），已限制在屏幕内
+    };
+
+    uint32_t m_width, m_height;
+    uint32_t m_tile_x_num, m_tile_y_num;
+
+    glm::mat4 m_view_projection;
+
+    bool m_simd_enabled;
+
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<uint32_t>> m_tile_bins; // 每个图块中需要光栅化的三角形下标
+
+    // 第0级为深度缓冲区，之后每级的宽高减半（向上取整），直到 1x1
+    std::vector<std::vector<float>> m_levels;
+    std::vector<glm::uvec2> m_level_sizes;
+
+    void BinTriangles();
+    void RasterizeTile(uint32_t tileIdx);
+    void RasterizeTriangleScalar(const Triangle &triangle, uint32_t tileX, uint32_t tileY);
+    void RasterizeTriangleSimd(const Triangle &triangle, uint32_t tileX, uint32_t tileY);
+    void BuildPyramid();
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    OcclusionCuller(const OcclusionCuller &) = delete;
+    OcclusionCuller &operator=(const OcclusionCuller &) = delete;
+
+    /* 深度缓冲区的分辨率，宽高向上补齐到图块大小的整数倍 */
+    OcclusionCuller(uint32_t width = 256, uint32_t height = 128);
+    ~OcclusionCuller();
+
+    /* 每帧添加遮挡体前调用，清空深度缓冲区 */
+    void Begin(const glm::mat4 &viewProjection);
+
+    /* 添加一个遮挡体，positions 为模型空间顶点位置，indices 每3个组成一个三角形，正反面都会光栅化 */
+    void AddOccluder(const glm::vec3 *positions, size_t vertexNum, const uint32_t *indices, size_t indexNum,
+                     const glm::mat4 &model);
+
+    /* 光栅化所有遮挡体并生成深度金字塔 */
+    void Rasterize();
+
+    /* 世界空间包围盒是否可能可见 */
+    bool IsVisible(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) const;
+
+    /* 默认在支持 SSE 时使用 SIMD 光栅化，关闭后总是使用标量实现，两者的结果逐位相同（由 tests/OcclusionCullerTest 验证） */
+    void SetSimdEnabled(bool enabled);
+
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+
+    /* 第0级深度缓冲区，按行从下到上排列，用于调试显示 */
+    const float *GetDepthBuffer() const;
+
+    size_t GetOccluderTriangleNum() const;
+};
@@ -14,6 +14,21 @@ class PointLight : public BaseLight
 
   public:
     PointLight(const glm::vec3 &position, const GLfloat linear, const GLfloat quadratic, const glm::vec3 &ambient,
-               const glm::vec3 &diffuse, const glm::vec3 &specular, const GLfloat constant);
+               const glm::vec3 &diffuse, const glm::vec3 &specular, const GLfloat constant = 1.0f);
     ~PointLight();
-};
\ No newline at end of file
+
+    LightType GetType() const override;
+
+    const glm::vec3 &GetPosition() const;
+    void SetPosition(const glm::vec3 &position);
+
+    GLfloat GetConstant() const;
+    GLfloat GetLinear() const;
+    GLfloat GetQuadratic() const;
+
+    /*
+     * 灯光的影响半径：衰减后环境光、漫反射和镜面反射中最亮的分量低于 threshold 时的距离，超出该距离的光照可以忽略。
+     * 没有一次和二次衰减时返回正无穷。
+    */
+    GLfloat GetRange(const GLfloat threshold = 1.0f / 256.0f) const;
+};
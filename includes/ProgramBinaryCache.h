@@ -0,0 +1,64 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <cstdint>
+#include <string>
+
+/*
+ * 着色器程序二进制缓存。
+ * 以 hash(顶点着色器源码, 片段着色器源码, 驱动厂商/渲染器/版本) 为键，把 glGetProgramBinary 的结果保存在
+ * 工作目录下的 shader_cache 目录中，下次启动时直接用 glProgramBinary 载入，跳过编译和链接。
+ * 驱动升级后二进制格式可能不再被接受，此时 Load 返回0，调用方回退到从源码编译，新的结果会覆盖旧的缓存文件。
+ * 需要 OpenGL 4.1（ARB_get_program_binary），且驱动至少支持一种二进制格式，否则缓存不生效。
+*/
+class ProgramBinaryCache
+{
+  private:
+    /* 缓存格式版本，修改文件布局后需要递增 */
+    static constexpr uint32_t VERSION = 1;
+
+    bool m_initialized;
+    bool m_supported;
+
+    // 驱动标识参与键的计算，更换显卡或驱动后旧的缓存自动失效
+    std::string m_driver_id;
+    std::string m_directory;
+
+    size_t m_hit_num;
+    size_t m_miss_num;
+
+    ProgramBinaryCache();
+
+    void Init();
+
+    std::string GetCachePath(uint64_t key) const;
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    ProgramBinaryCache(const ProgramBinaryCache &) = delete;
+    ProgramBinaryCache &operator=(const ProgramBinaryCache &) = delete;
+    ~ProgramBinaryCache();
+
+    // 获取单例实例
+    static ProgramBinaryCache &getInstance();
+
+    bool IsSupported();
+
+    uint64_t MakeKey(const std::string &vertexSource, const std::string &fragmentSource);
+
+    /*
+     * 载入缓存的程序，返回链接成功的程序对象；缓存不存在、已过期或被驱动拒绝时返回0。
+    */
+    GLuint Load(uint64_t key);
+
+    /*
+     * 保存已链接程序的二进制。链接前需要设置 GL_PROGRAM_BINARY_RETRIEVABLE_HINT（见 PrepareProgram）。
+    */
+    void Store(uint64_t key, GLuint program);
+
+    /* 在 glLinkProgram 之前调用，提示驱动保留可以取回的二进制 */
+    void PrepareProgram(GLuint program);
+
+    size_t GetHitNum() const;
+    size_t GetMissNum() const;
+};
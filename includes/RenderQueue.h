@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Mesh.h"
+#include "Model.h"
+#include "Shader.h"
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <vector>
+
+/*
+ * 渲染层，按枚举顺序依次绘制。同一层内不透明物体从前到后、半透明物体（开启混合）从后到前绘制。
+*/
+enum class RenderLayer : uint8_t
+{
+    Background = 0, // 不写入深度、最先绘制的背景（例如未优化的天空盒）
+    Opaque,         // 不透明物体，包括使用 Alpha 测试的植被
+    Skybox,         // 在所有不透明物体之后绘制的天空盒，利用 Early-z 剔除被遮挡的片元
+    Transparent,    // 半透明物体
+    Overlay,        // 最后绘制的叠加效果（例如物体轮廓）
+};
+
+/*
+ * 一个绘制包需要的固定管线状态，RenderQueue 在绘制前通过 GLStateCache 设置，与上一个绘制包相同的状态不会产生GL调用。
+ * 默认值与 Game 初始化后的状态一致：开启深度测试和模板测试，关闭混合和面剔除。
+*/
+struct RenderState
+{
+    bool depth_test = true;
+    bool depth_write = true;
+    GLenum depth_func = GL_LESS;
+
+    bool stencil_test = true;
+    GLenum stencil_func = GL_ALWAYS;
+    GLint stencil_ref = 0;
+    GLuint stencil_func_mask = 0xFF;
+    GLuint stencil_write_mask = 0xFF;
+    GLenum stencil_fail_op = GL_KEEP;
+    GLenum stencil_depth_fail_op = GL_KEEP;
+    GLenum stencil_pass_op = GL_KEEP;
+
+    bool blend = false;
+    GLenum blend_src = GL_SRC_ALPHA;
+    GLenum blend_dst = GL_ONE_MINUS_SRC_ALPHA;
+
+    bool cull_face = false;
+    GLenum cull_mode = GL_BACK;
+};
+
+/*
+ * 一次绘制：网格或模型（二选一）、使用的着色器、模型矩阵和渲染状态。
+ * sort_key 从高位到低位依次为：
+ *  渲染层（4位）| 是否半透明（1位）| 不透明：着色器（16位）材质（16位）深度（24位）
+ *                                 | 半透明：反转的深度（24位）着色器（16位）材质（16位）
+ * 所以不透明物体先按着色器和材质分组以减少状态切换，组内从前到后绘制以减少 overdraw；半透明物体严格从后到前绘制。
+*/
+struct DrawPacket
+{
+    uint64_t sort_key;
+
+    Mesh *mesh;
+    const Model *model;
+    Shader *shader;
+    Material *material; // 提交时确定，绘制时不再读取网格当前的材质
+
+    glm::mat4 model_matrix;
+    bool has_model_matrix; // 为 false 时不修改着色器中的 model / normalMatrix
+
+    GLsizei instance_num; // 大于0时用 Mesh::DrawInstanced 绘制，模型矩阵来自网格关联的实例缓冲区
+
+    RenderState state;
+};
+
+/*
+ * 每帧收集绘制包，按 64 位排序键基数排序后依次绘制。
+ * 提交时只记录绘制包，Execute 时才设置状态、写入模型矩阵并发出绘制调用；
+ * view / projection 等每个着色器共享的 uniform 仍由调用者在提交前设置。
+*/
+class RenderQueue
+{
+  private:
+    struct SortItem
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<SortItem> m_sort_items;
+    std::vector<SortItem> m_sort_scratch;
+
+    glm::mat4 m_view;
+
+    /* 观察空间深度量化为24位，非负浮点数的位模式与数值的大小顺序一致 */
+    uint32_t QuantizeDepth(const glm::vec3 &worldPos) const;
+
+    uint64_t MakeSortKey(RenderLayer layer, const DrawPacket &packet) const;
+
+    /* 网格的材质属于 shader 时返回该材质，否则（例如以其他着色器绘制轮廓）返回空，只使用着色器本身的 uniform */
+    static Material *MeshMaterial(const Mesh *mesh, const Shader *shader);
+
+    void Push(RenderLayer layer, DrawPacket &&packet);
+
+    /* 对 m_sort_items 按 key 做 LSD 基数排序（每趟8位），所有 key 在某一趟上相同时跳过该趟 */
+    void RadixSort();
+
+    static void ApplyState(const RenderState &state);
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    RenderQueue(const RenderQueue &) = delete;
+    RenderQueue &operator=(const RenderQueue &) = delete;
+
+    RenderQueue();
+    ~RenderQueue();
+
+    /* 每帧开始提交前调用，清空上一帧的绘制包，view 用于计算排序深度 */
+    void Begin(const glm::mat4 &view);
+
+    /*
+     * 提交网格，shader 为空时使用网格自己的着色器，否则用该着色器绘制（例如绘制轮廓），不会改变网格的着色器和材质。
+     * model 为空时不设置模型矩阵，排序深度按世界原点计算。
+    */
+    void Submit(RenderLayer layer, Mesh *mesh, const glm::mat4 *model, const RenderState &state = RenderState(),
+                Shader *shader = nullptr);
+
+    /*
+     * 提交一次实例化绘制，网格需要先通过 Mesh::SetInstanceBuffer 关联实例缓冲区，
+     * 着色器从逐实例属性中读取模型矩阵，排序深度按世界原点计算。
+    */
+    void SubmitInstanced(RenderLayer layer, Mesh *mesh, GLsizei instanceNum, const RenderState &state = RenderState(),
+                         Shader *shader = nullptr);
+
+    /* 提交整个模型，模型的所有子网格共享同一个着色器 */
+    void Submit(RenderLayer layer, const Model *model, const glm::mat4 *modelMatrix,
+                const RenderState &state = RenderState());
+
+    /* 排序并绘制本帧提交的所有绘制包，结束后恢复默认的渲染状态 */
+    void Execute();
+
+    size_t GetPacketNum() const;
+};
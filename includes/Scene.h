@@ -6,12 +6,38 @@
 #include "Shader.h"
 #include "Texture2D.h"
 #include "Camera.h"
+#include "CameraUniformBuffer.h"
+#include "FrameRingBuffer.h"
+#include "LightManager.h"
+#include "RenderQueue.h"
 #include "FrameBuffer.h"
+#include "InstanceBuffer.h"
+#include "DynamicBVH.h"
+#include "OcclusionCuller.h"
 #include "TextureCubeMap.h"
 
 class Scene
 {
   private:
+    /* 每帧参与剔除和绘制的场景实例，mesh 和 model 只有一个不为空 */
+    struct SceneInstance
+    {
+        Mesh *mesh;
+        Model *model;
+        glm::vec3 bounds_min, bounds_max; // 模型空间包围盒
+        glm::vec3 world_min, world_max;   // 本帧的世界空间包围盒
+        int proxy;                         // 在 m_bvh 中的叶节点
+        bool is_occluder;
+    };
+
+    /* 遮挡体：完全位于实例网格内部的简化三角形网格（模型空间），跟随实例的模型矩阵变换 */
+    struct Occluder
+    {
+        size_t instance;
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+    };
+
     std::vector<Mesh *> m_meshes;
     std::vector<Shader *> m_shaders;
     std::vector<Texture2D *> m_textures;
@@ -23,7 +49,20 @@ class Scene
 
     FrameBuffer *m_fbo;
 
+    // DrawGrass 中所有草的逐实例数据，第一次绘制时创建
+    InstanceBuffer *m_grass_instances;
+
     Camera m_camera;
+    // 每帧变化的 uniform block 从其中分配，必须在使用它的成员之前构造、之后析构
+    FrameRingBuffer m_frame_ring;
+    CameraUniformBuffer m_camera_buffer;
+    LightManager m_light_manager;
+    RenderQueue m_render_queue;
+    std::vector<SceneInstance> m_instances;
+    DynamicBVH m_bvh;
+    std::vector<uint32_t> m_visible_instances;
+    std::vector<Occluder> m_occluders;
+    OcclusionCuller m_occlusion_culler;
 
     float m_camSpeed;
     float m_lastFrameTime;
@@ -39,24 +78,47 @@ class Scene
     void AddTexture(Texture2D *texture);
     void AddModel(Model *model);
 
+    /* 把网格或模型加入场景实例，由 Render 剔除后绘制；AddModel 会自动添加模型实例 */
+    size_t AddInstance(Mesh *mesh);
+    size_t AddInstance(Model *model);
+
+    /* 用一个长方体（模型空间）作为实例的遮挡体，长方体必须完全位于实例网格内部 */
+    void SetBoxOccluder(size_t instanceIdx, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+
+    /* 把遮挡体光栅化，从 m_visible_instances 中去掉被遮挡的实例 */
+    void CullOccludedInstances(const glm::mat4 &model);
+
     void SetupSkybox();
+    void SetupLights();
     void SetupFrameBuffer(int width, int height);
 
-    Shader *LoadShader(const std::string &vertextPath, const std::string &fragmentPath);
-    Texture2D *LoadTexture(const std::string &texturePath, const GLenum format, const GLint wrapMode = GL_REPEAT);
+    Shader *LoadShader(const std::string &vertextPath, const std::string &fragmentPath,
+                       const std::vector<std::string> &defines = {});
+    // srgb 为 false 表示数据贴图（例如高光贴图），mip 链在线性空间中滤波
+    Texture2D *LoadTexture(const std::string &texturePath, const GLenum format, const GLint wrapMode = GL_REPEAT,
+                           bool srgb = true);
 
     void InitMVP(Shader *material, bool setNormal = false);
 
+    glm::mat4 GetModelMatrix() const;
+
     void UpdateModelMatrix(Shader &shader, bool ignoreNotModel = false);
     void UpdateViewMatrix(Shader &shader, bool ignoreNotView = false);
     void UpdateProjectionMatrix(Shader &shader);
 
+    void SelectModelLod(Model *model);
+
+    /* 用实例当前的世界空间包围盒更新 BVH */
+    void UpdateInstanceBounds(SceneInstance &instance, const glm::mat4 &model);
+
+    /* 除 DrawRenderToTexture 外，Draw* 只向渲染队列提交绘制包，在 Render 结束时统一排序绘制 */
     void DrawSkybox();
     void DrawOptimizedSkybox();
     void DrawMeshAndOutline(Mesh *mesh, Shader *shader, Shader *outlineShader);
     void DrawGlassWithoutBlend(Mesh *cube, Mesh *rectangle);
     void DrawGlassWithBlend(Mesh *cube, Mesh *rectangle);
     void DrawGrass(Mesh *mesh, Mesh *rectangle);
+    void SetupGrassInstances(Mesh *rectangle);
     void DrawCullFace(Mesh *mesh);
     void DrawRenderToTexture(Mesh *mesh, Mesh *screenRectMesh);
 
@@ -118,4 +180,8 @@ class Scene
     void UpdateCamYawAndPitch(double xPos, double yPos);
     void UpdateCamZoom(double yoffset);
     void UpdateCamAspect(double aspect);
+
+    /* 上一帧通过视锥体剔除和遮挡剔除提交的实例数量和被剔除的数量 */
+    size_t GetVisibleDrawNum() const;
+    size_t GetCulledDrawNum() const;
 };
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "glad/glad.h"
 #include "glm/glm.hpp"
 #include "ShaderUnit.h"
+#include "UniformId.h"
 
 class Shader
 {
@@ -16,17 +17,70 @@ class Shader
         const Texture *texture;
     };
 
+    /*
+     * 一个 uniform 在程序中的位置、类型，以及它在CPU端副本 uniform_values 中的偏移量和字节数。
+     * 不支持的类型（例如 vec2、ivec3）size 为0，不能通过 Set* 设置。
+    */
+    struct UniformSlot
+    {
+        GLint location;
+        GLenum type;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    /*
+     * 链接后通过 GL_ACTIVE_UNIFORMS 反射得到的名字哈希，数组的每个元素各占一项（"name[i]"），
+     * 不带下标的名字与第0个元素指向同一个 slot。
+    */
+    struct UniformInfo
+    {
+        uint32_t hash;
+        uint32_t slot;
+    };
+
     GLuint shader_program;
 
+    // 按哈希排序，二分查找
+    std::vector<UniformInfo> uniforms;
+    std::vector<UniformSlot> uniform_slots;
+
+    /*
+     * 程序 uniform 状态的CPU端副本。Set* 只修改副本并标记发生变化的 slot，
+     * Use() 绑定程序后一次性上传所有标记过的值，值没有变化的 Set* 不产生任何GL调用。
+    */
+    mutable std::vector<uint8_t> uniform_values;
+    mutable std::vector<uint8_t> dirty_flags;
+    mutable std::vector<uint32_t> dirty_slots;
+
+    // 已经报告过的找不到或类型不符的 uniform，每个只报告一次
+    mutable std::vector<uint32_t> reported_uniforms;
+
     int texture_idx;
 
     std::vector<TexturePair> texture_tuples;
 
     std::string ReadShaderFile(const char *filePath);
 
-    GLuint Link(GLuint vertexShader, GLuint fragmentShader);
+    GLuint Link(GLuint vertexShader, GLuint fragmentShader, GLint &success);
 
-    GLint GetUniformLocation(const std::string &name) const;
+    void ReflectUniforms();
+
+    /* 把程序中声明的引擎共享 uniform block 关联到固定的绑定点（见 UniformBlockBinding.h） */
+    void BindUniformBlocks();
+
+    /* 把程序中声明的引擎共享纹理的采样器设置为固定的纹理单元（见 SharedTextureUnit.h） */
+    void BindSharedTextures();
+
+    /* expectedType 为0时只要求是整数、布尔或采样器（都用 glUniform1i 设置），找不到时返回 nullptr */
+    const UniformSlot *FindSlot(UniformId id, GLenum expectedType) const;
+
+    /* 把值写入CPU端副本，与原值不同时标记该 slot 需要上传 */
+    void StageUniform(UniformId id, GLenum expectedType, const void *value, size_t size) const;
+
+    void FlushUniforms() const;
+
+    void ReportUniform(UniformId id, const char *reason) const;
 
     void InnerUse() const;
 
@@ -38,17 +92,23 @@ class Shader
     Shader(const ShaderUnit &vertexShader, const ShaderUnit &fragmentShader);
     ~Shader();
 
-    void SetTexture(const std::string &name, const Texture *texture);
-    void SetBool(const std::string &name, const GLboolean value) const;
-    void SetInt(const std::string &name, const GLint value) const;
-    void SetFloat(const std::string &name, const GLfloat value) const;
-    void SetFloat4(const std::string &name, const GLfloat v0, const GLfloat v1, const GLfloat v2,
+    void SetTexture(UniformId id, const Texture *texture);
+    void SetBool(UniformId id, const GLboolean value) const;
+    void SetInt(UniformId id, const GLint value) const;
+    void SetFloat(UniformId id, const GLfloat value) const;
+    void SetFloat4(UniformId id, const GLfloat v0, const GLfloat v1, const GLfloat v2,
                    const GLfloat v3) const;
-    void SetMat4f(const std::string &name, const glm::mat4 &matrix) const;
-    void SetMat3f(const std::string &name, const glm::mat3 &matrix) const;
-    void SetVec3f(const std::string &name, const glm::vec3 &vector) const;
+    void SetMat4f(UniformId id, const glm::mat4 &matrix) const;
+    void SetMat3f(UniformId id, const glm::mat3 &matrix) const;
+    void SetVec3f(UniformId id, const glm::vec3 &vector) const;
 
+    /* 绑定程序和纹理，并上传上次 Use() 之后修改过的 uniform，必须在绘制前调用 */
     void Use() const;
 
+    /* 程序中是否存在该 uniform（未被使用的 uniform 会被链接器剔除） */
+    bool HasUniform(UniformId id) const;
+
     bool IsValidProgram() const;
+
+    GLuint GetProgramID() const;
 };
\ No newline at end of file
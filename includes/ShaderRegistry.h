@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Shader.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * 进程内共享的着色器程序缓存。
+ * 以 (顶点着色器路径, 片段着色器路径, 宏定义列表) 作为键，每个键只编译链接一次，多个模型共享同一个程序对象。
+ * 所有通过 Acquire 获得的程序都必须通过 Release 归还，引用计数归零时才删除程序。
+ * 共享的程序上只应设置所有使用者都相同的 uniform，网格之间不同的参数放在 Material 中。
+*/
+class ShaderRegistry
+{
+  private:
+    struct Entry
+    {
+        Shader *shader;
+        int ref_count;
+    };
+
+    std::unordered_map<std::string, Entry> m_entries;
+    std::unordered_map<const Shader *, std::string> m_keys;
+
+    ShaderRegistry();
+
+    static std::string MakeKey(const std::string &vertexPath, const std::string &fragmentPath,
+                               const std::vector<std::string> &defines);
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    ShaderRegistry(const ShaderRegistry &) = delete;
+    ShaderRegistry &operator=(const ShaderRegistry &) = delete;
+    ~ShaderRegistry();
+
+    // 获取单例实例
+    static ShaderRegistry &getInstance();
+
+    /*
+     * 获取着色器程序，编译或链接失败时返回 nullptr。
+     * isNew 用于告知调用者程序是否为本次新建的，新建的程序需要设置一次共享的 uniform。
+    */
+    Shader *Acquire(const std::string &vertexPath, const std::string &fragmentPath,
+                    const std::vector<std::string> &defines = {}, bool *isNew = nullptr);
+
+    void Release(const Shader *shader);
+
+    size_t GetShaderNum() const;
+};
@@ -2,23 +2,51 @@
 
 #include "glad/glad.h"
 #include <string>
+#include <vector>
 
+/*
+ * 着色器源码单元。构造时只读取源码并插入宏定义，第一次调用 GetShaderID 时才编译：
+ * 程序二进制缓存命中时（见 ProgramBinaryCache）不需要编译任何着色器。
+*/
 class ShaderUnit
 {
   private:
-    GLuint shader_id;
+    GLenum shader_type;
+
+    // 插入宏定义之后的完整源码，用于计算程序二进制缓存的键
+    std::string shader_source;
+
+    mutable GLuint shader_id;
 
     const std::string ReadShaderFile(const std::string &path) const;
 
-    GLuint Compile(GLenum shaderType, const std::string &shaderCode);
+    /*
+     * 把 #include "文件名" 替换为该文件的内容（相对于包含该指令的文件所在的目录），被引入的文件中可以继续 #include。
+     * 引入的文件不存在或嵌套过深时返回 false。
+    */
+    bool ResolveIncludes(const std::string &shaderCode, const std::string &directory, int depth,
+                         std::string &output) const;
+
+    static std::string InjectDefines(const std::string &shaderCode, const std::vector<std::string> &defines);
+
+    static GLuint Compile(GLenum shaderType, const std::string &shaderCode);
 
   public:
     // 删除复制构造函数和赋值操作符
     ShaderUnit(const ShaderUnit &) = delete;
     ShaderUnit &operator=(const ShaderUnit &) = delete;
 
-    ShaderUnit(const std::string &path, const GLenum shaderType);
+    /*
+     * defines 中的每一项会以 "#define xxx" 的形式插入到 #version 指令之后，用于生成同一份源码的不同变体。
+    */
+    ShaderUnit(const std::string &path, const GLenum shaderType, const std::vector<std::string> &defines = {});
     ~ShaderUnit();
 
+    /* 返回编译后的着色器对象，首次调用时编译；源码读取失败时返回0 */
     GLuint GetShaderID() const;
+
+    const std::string &GetSource() const;
+    GLenum GetShaderType() const;
+
+    bool IsValid() const;
 };
\ No newline at end of file
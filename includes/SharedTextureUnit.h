@@ -0,0 +1,22 @@
+#pragma once
+
+#include "glad/glad.h"
+
+/*
+ * 引擎共享的纹理及其固定的纹理单元，占用片元着色器保证可用的16个纹理单元中的最后几个，
+ * Shader::SetTexture 为材质纹理分配的纹理单元不会达到 SHARED_TEXTURE_UNIT_FIRST。
+ * 与 uniform block 一样，Shader 在链接后按名字查找这些采样器并设置对应的纹理单元，着色器只需要声明采样器即可使用。
+*/
+enum SharedTextureUnit : GLuint
+{
+    SHARED_TEXTURE_UNIT_FIRST = 14,
+    TEXTURE_UNIT_CLUSTER_GRID = SHARED_TEXTURE_UNIT_FIRST, // clusterLightGrid，见 LightManager
+    TEXTURE_UNIT_CLUSTER_LIGHT_INDICES,                    // clusterLightIndices，见 LightManager
+    SHARED_TEXTURE_UNIT_END,
+};
+
+/* 从 SHARED_TEXTURE_UNIT_FIRST 开始与 SharedTextureUnit 一一对应的采样器名字 */
+inline constexpr const char *SHARED_TEXTURE_NAMES[SHARED_TEXTURE_UNIT_END - SHARED_TEXTURE_UNIT_FIRST] = {
+    "clusterLightGrid",
+    "clusterLightIndices",
+};
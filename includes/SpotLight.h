@@ -1,17 +1,30 @@
 #pragma once
 
-#include "BaseLight.h"
+#include "PointLight.h"
 #include "glad/glad.h"
 
-class SpotLight : public BaseLight
+/*
+ * 聚光灯：带有方向和锥形范围的点光源，衰减方式与点光源相同。
+ * 切光角以余弦值保存，内切光角以内为全亮，内外切光角之间平滑过渡到0。
+*/
+class SpotLight : public PointLight
 {
   protected:
-    glm::vec3 m_position;  // 灯光位置
-    glm::vec3 m_direction; // 灯光方向
-    GLfloat m_cutOff;      // 切光角
+    glm::vec3 m_direction;  // 灯光方向
+    GLfloat m_cutOff;       // 内切光角的余弦值
+    GLfloat m_outerCutOff;  // 外切光角的余弦值
 
   public:
-    SpotLight(const glm::vec3 &position, const glm::vec3 &direction, const GLfloat cutOff, const glm::vec3 &ambient,
-              const glm::vec3 &diffuse, const glm::vec3 &specular);
+    SpotLight(const glm::vec3 &position, const glm::vec3 &direction, const GLfloat cutOff, const GLfloat outerCutOff,
+              const GLfloat linear, const GLfloat quadratic, const glm::vec3 &ambient, const glm::vec3 &diffuse,
+              const glm::vec3 &specular, const GLfloat constant = 1.0f);
     ~SpotLight();
-};
\ No newline at end of file
+
+    LightType GetType() const override;
+
+    const glm::vec3 &GetDirection() const;
+    void SetDirection(const glm::vec3 &direction);
+
+    GLfloat GetCutOff() const;
+    GLfloat GetOuterCutOff() const;
+};
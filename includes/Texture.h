@@ -16,6 +16,6 @@ class Texture
     Texture();
     virtual ~Texture();
 
-    void Use(int idx) const;
+    virtual void Use(int idx) const;
     bool IsValidTexture() const;
 };
\ No newline at end of file
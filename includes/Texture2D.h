@@ -1,25 +1,60 @@
 #pragma once
 
+#include "MipChainBuilder.h"
 #include "Texture.h"
+#include "TextureCooker.h"
+#include <cstdint>
 
 class Texture2D : public Texture
 {
+    friend class TextureStreamer;
+
   protected:
     GLsizei width, height;
 
     int channel_num;
 
+    // 异步加载的纹理在数据上传完成前 ready 为 false，此时绑定占位纹理
+    bool ready;
+    uint64_t stream_job;
+
     static Texture2D *white_2d_texture;
     static Texture2D *black_2d_texture;
 
-    bool InnerInit(const char *filePath, GLenum format, GLint wrapMode);
+    bool InnerInit(const char *filePath, GLenum format, GLint wrapMode, TextureCompression compression, bool srgb);
+    bool InnerInitAsync(const char *filePath, GLenum format, GLint wrapMode, TextureCompression compression,
+                        bool srgb);
+
+    void SetupParameters(GLint wrapMode);
+
+    /*
+     * 逐级上传 mip 链，format 为纹理的存储格式。data 为 nullptr 时各级的偏移量相对于当前绑定的像素解包缓冲（PBO）。
+    */
+    void UploadMipChain(const MipChain &chain, const uint8_t *data, GLenum format);
+
+    /*
+     * 逐级上传压缩后的 mip 链。data 为 nullptr 时各级的偏移量相对于当前绑定的像素解包缓冲（PBO）。
+    */
+    void UploadCompressed(const CookedTexture &cooked, const uint8_t *data);
+
+    static GLenum GetFormat(int channelNum, GLenum format);
 
     GLenum GetTextureTarget() const override;
 
   public:
-    Texture2D(const char *filePath, GLenum format = 0, GLint wrapMode = GL_REPEAT);
+    /*
+     * async 为 true 时立即返回，图片在线程池中解码并由 TextureStreamer 分帧上传，数据就绪前绑定默认白色纹理。
+     * compression 不为 None 时使用 TextureCooker 烘焙的块压缩数据（此时忽略 format），驱动不支持对应格式时回退到未压缩的方式。
+     * srgb 表示图片是否为 sRGB 编码的颜色，决定未压缩时 mip 链的滤波方式，高光、法线等数据贴图需要传入 false。
+    */
+    Texture2D(const char *filePath, GLenum format = 0, GLint wrapMode = GL_REPEAT, bool async = false,
+              TextureCompression compression = TextureCompression::None, bool srgb = true);
     ~Texture2D() override;
 
+    void Use(int idx) const override;
+
+    bool IsReady() const;
+
     GLsizei GetWidth() const;
     GLsizei GetHeight() const;
 
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Texture.h"
+#include <cstddef>
+
+/*
+ * 缓冲区纹理（GL_TEXTURE_BUFFER）：把一个缓冲区对象当作一维纹理，着色器通过 samplerBuffer / usamplerBuffer 和 texelFetch 读取。
+ * 用于每帧由CPU生成、体积超过 uniform block 限制的数据（例如分簇光照的灯光索引表）。
+*/
+class TextureBuffer : public Texture
+{
+  private:
+    GLuint buffer_id;
+    GLenum internal_format;
+    size_t capacity; // 字节数
+
+  protected:
+    GLenum GetTextureTarget() const override;
+
+  public:
+    /* internalFormat 为纹素格式（例如 GL_R32UI），capacity 为缓冲区的字节数 */
+    TextureBuffer(GLenum internalFormat, size_t capacity);
+    ~TextureBuffer() override;
+
+    /* 用 data 的前 size 个字节替换缓冲区的内容，size 超过容量时返回 false */
+    bool Update(const void *data, size_t size);
+
+    size_t GetCapacity() const;
+};
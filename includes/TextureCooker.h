@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BCnEncoder.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * 纹理的块压缩方式，按纹理的用途选择：
+ *  Color：颜色贴图，不透明时使用 BC1，存在透明像素时使用 BC3。
+ *  Grayscale：灰度贴图（如高光贴图），RGB 的平均值编码为 BC4，采样时 R 通道被复制到 G、B。
+ *  Normal：切线空间法线贴图，R、G 编码为 BC5，Z 需要在着色器中重建。
+*/
+enum class TextureCompression : uint32_t
+{
+    None = 0,
+    Color,
+    Grayscale,
+    Normal,
+};
+
+struct CookedLevel
+{
+    int width, height;
+    size_t offset, size;
+};
+
+/*
+ * 压缩后的纹理：所有 mip 级别的块数据依次存放在 data 中。
+*/
+struct CookedTexture
+{
+    BCFormat format = BCFormat::BC1;
+    int width = 0, height = 0;
+
+    /* 第0级是原始尺寸，最后一级是 1x1 */
+    std::vector<CookedLevel> levels;
+
+    std::vector<uint8_t> data;
+};
+
+/*
+ * 纹理烘焙：解码图片、生成 mip 链并逐级编码为 BCn。
+ * 结果保存在源图片旁边（<图片路径>.bctex），源文件内容未变时直接读取缓存，不再解码和编码。
+ * Cook 只做CPU计算和文件读写，可以在工作线程中调用。
+*/
+class TextureCooker
+{
+  public:
+    /* 缓存格式版本，修改文件布局、编码器或 mip 生成方式后需要递增 */
+    static constexpr uint32_t VERSION = 2;
+
+    static bool Cook(const std::string &sourcePath, TextureCompression compression, CookedTexture &cooked);
+
+    static std::string GetCachePath(const std::string &sourcePath);
+
+    /*
+     * 查询驱动是否支持该压缩方式需要的格式（GL_COMPRESSED_TEXTURE_FORMATS），只能在主线程中调用。
+     * 不支持时调用方应回退到未压缩的上传方式。
+    */
+    static bool IsSupported(TextureCompression compression);
+
+  private:
+    // 禁止实例化该类
+    TextureCooker() = delete;
+
+    static bool ReadCache(const std::string &cachePath, uint64_t sourceHash, TextureCompression compression,
+                          CookedTexture &cooked);
+    static bool WriteCache(const std::string &cachePath, uint64_t sourceHash, TextureCompression compression,
+                           const CookedTexture &cooked);
+};
@@ -6,6 +6,8 @@
 class TextureCubeMap : public Texture
 {
   protected:
+    static constexpr unsigned int FACE_NUM = 6;
+
     bool InnerInit(const std::vector<const char *> &faces);
 
     GLenum GetTextureTarget() const override;
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Texture2D.h"
+#include "glad/glad.h"
+#include <string>
+#include <unordered_map>
+
+/*
+ * 进程内共享的2D纹理注册表。
+ * 以 规范化路径 + 格式 + 环绕方式 + 压缩方式 + 颜色空间 作为键，同一张图片只解码和上传一次，重复请求直接返回已存在的纹理并增加引用计数。
+ * 所有通过 Acquire 获得的纹理都必须通过 Release 归还，引用计数归零时才真正删除纹理。
+*/
+class TextureRegistry
+{
+  private:
+    struct Entry
+    {
+        Texture2D *texture;
+        int ref_count;
+    };
+
+    std::unordered_map<std::string, Entry> m_entries;
+    std::unordered_map<const Texture2D *, std::string> m_keys;
+
+    TextureRegistry();
+
+    static std::string MakeKey(const std::string &filePath, GLenum format, GLint wrapMode,
+                               TextureCompression compression, bool srgb);
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    TextureRegistry(const TextureRegistry &) = delete;
+    TextureRegistry &operator=(const TextureRegistry &) = delete;
+    ~TextureRegistry();
+
+    // 获取单例实例
+    static TextureRegistry &getInstance();
+
+    /*
+     * 获取纹理，加载失败时返回 nullptr。
+     * async 只影响首次创建：为 true 时纹理在后台解码、分帧上传，返回的纹理可能尚未就绪（见 Texture2D::IsReady）。
+     * srgb 为 false 表示数据贴图（高光、法线等），mip 链在线性空间中滤波，见 Texture2D。
+    */
+    Texture2D *Acquire(const std::string &filePath, GLenum format = 0, GLint wrapMode = GL_REPEAT, bool async = false,
+                       TextureCompression compression = TextureCompression::None, bool srgb = true);
+
+    void Release(const Texture2D *texture);
+
+    size_t GetTextureNum() const;
+};
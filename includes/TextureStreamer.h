@@ -0,0 +1,96 @@
+#pragma once
+
+#include "MipChainBuilder.h"
+#include "TextureCooker.h"
+#include "glad/glad.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Texture2D;
+
+/*
+ * 异步2D纹理流式加载器。
+ * 图片解码和 mip 链生成在线程池中完成，解码结果由主线程在每帧的 Update 中通过像素解包缓冲（PBO）环上传到GPU，
+ * 每帧上传的字节数受预算限制，避免一次性上传大量纹理造成卡顿。
+ * 除解码任务外，所有接口都只能在持有OpenGL上下文的主线程中调用。
+*/
+class TextureStreamer
+{
+  private:
+    static constexpr size_t PBO_RING_SIZE = 3;
+    static constexpr size_t DEFAULT_FRAME_BUDGET = 8 * 1024 * 1024;
+
+    /* 未压缩的图片及其 mip 链保存在 chain 中，块压缩的纹理保存在 cooked 中，两者都为空表示加载失败 */
+    struct DecodedImage
+    {
+        uint64_t job_id;
+        std::shared_ptr<MipChain> chain;
+        std::shared_ptr<CookedTexture> cooked;
+    };
+
+    // 解码完成队列由解码任务与流式加载器共同持有，线程池晚于本单例析构时任务仍能安全写入
+    struct CompletedQueue
+    {
+        std::mutex mutex;
+        std::vector<DecodedImage> images;
+    };
+
+    struct PendingTexture
+    {
+        Texture2D *texture;
+        GLenum format;
+    };
+
+    std::shared_ptr<CompletedQueue> m_completed;
+    std::vector<DecodedImage> m_ready_images;
+
+    std::unordered_map<uint64_t, PendingTexture> m_pending;
+    uint64_t m_next_job_id;
+
+    GLuint m_pbos[PBO_RING_SIZE];
+    size_t m_pbo_capacity[PBO_RING_SIZE];
+    size_t m_pbo_cursor;
+
+    size_t m_frame_budget;
+
+    TextureStreamer();
+
+    static size_t GetImageBytes(const DecodedImage &image);
+
+    // 把数据写入环中的下一个PBO，成功时该PBO保持绑定在 GL_PIXEL_UNPACK_BUFFER 上
+    bool FillPixelBuffer(const void *data, size_t bytes);
+
+    void Upload(const DecodedImage &image, const PendingTexture &pending);
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+    ~TextureStreamer();
+
+    // 获取单例实例
+    static TextureStreamer &getInstance();
+
+    /*
+     * 提交一张图片的解码任务，返回任务编号。texture 在数据就绪前必须保持存活，提前销毁时需调用 Cancel。
+     * compression 不为 None 时在工作线程中烘焙（或读取缓存的）块压缩数据，失败时回退到未压缩的解码。
+     * srgb 决定未压缩时 mip 链的滤波方式，见 MipChainBuilder::Load。
+    */
+    uint64_t Enqueue(Texture2D *texture, const std::string &filePath, GLenum format,
+                     TextureCompression compression = TextureCompression::None, bool srgb = true);
+
+    void Cancel(uint64_t jobId);
+
+    /*
+     * 每帧调用一次，在预算内上传已解码完成的纹理。至少上传一张，保证超过预算的大图也能完成加载。
+    */
+    void Update();
+
+    void SetFrameBudget(size_t bytes);
+
+    size_t GetPendingNum() const;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * 简单的工作线程池，用于把与OpenGL无关的CPU计算（网格数据转换、图片解码等）分发到多个线程上执行。
+ * 注意：OpenGL上下文只绑定在主线程上，提交到线程池中的任务不能调用任何gl函数。
+*/
+class ThreadPool
+{
+  private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    bool m_stop;
+
+    ThreadPool(size_t threadNum);
+
+    void WorkerLoop();
+
+    void Enqueue(std::function<void()> task);
+
+  public:
+    // 删除复制构造函数和赋值操作符
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    // 获取单例实例
+    static ThreadPool &getInstance();
+
+    size_t GetThreadNum() const;
+
+    /*
+     * 提交一个任务，返回可以获取任务结果的 future。
+    */
+    template <typename F> std::future<std::invoke_result_t<F>> Submit(F &&func)
+    {
+        using Result = std::invoke_result_t<F>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+        std::future<Result> result = task->get_future();
+        Enqueue([task]() { (*task)(); });
+
+        return result;
+    }
+
+    /*
+     * 对 [0, count) 中的每个下标并行调用 func，所有下标处理完毕后才返回。
+     * 调用线程自身也会参与计算，所以即使在工作线程中嵌套调用也不会死锁。
+     * func 抛出异常时剩余的下标不再执行，所有参与者结束后在调用线程中重新抛出第一个异常。
+    */
+    void ParallelFor(size_t count, const std::function<void(size_t)> &func);
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "glad/glad.h"
+
+/*
+ * 引擎共享的 uniform block 及其固定的绑定点。
+ * GLSL 330 不支持 layout(binding = N)，Shader 在链接后按名字查找这些 block 并调用 glUniformBlockBinding，
+ * 着色器只需要声明（或 #include）对应的 block 即可使用，没有声明的 block 会被忽略。
+*/
+enum UniformBlockBinding : GLuint
+{
+    UNIFORM_BLOCK_CAMERA = 0, // CameraBlock，见 CameraUniformBuffer
+    UNIFORM_BLOCK_LIGHT,      // LightBlock，见 LightManager
+    UNIFORM_BLOCK_NUM,
+};
+
+/* 与 UniformBlockBinding 一一对应的 block 名字 */
+inline constexpr const char *UNIFORM_BLOCK_NAMES[UNIFORM_BLOCK_NUM] = {
+    "CameraBlock",
+    "LightBlock",
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/*
+ * uniform 变量的句柄：变量名的 FNV-1a 32位哈希。
+ * 从字符串字面量构造时哈希在编译期计算（consteval），Shader 的 Set* 接口接收 UniformId，
+ * 所以 shader.SetMat4f("model", model) 在运行时既不构造 std::string，也不调用 glGetUniformLocation，
+ * 只在程序链接后建立的反射表中查找哈希值。
+ * 运行时才确定的变量名（例如 Material 保存的参数名）使用 FromString，应在初始化时转换一次并保存结果。
+*/
+class UniformId
+{
+  private:
+    uint32_t m_hash;
+
+    // 只用于输出错误信息，从字面量构造时指向字面量本身，FromString 构造时为空
+    const char *m_name;
+
+    constexpr UniformId(uint32_t hash, const char *name) : m_hash(hash), m_name(name)
+    {
+    }
+
+  public:
+    consteval UniformId(const char *name) : m_hash(Hash(name)), m_name(name)
+    {
+    }
+
+    static constexpr uint32_t Hash(std::string_view name)
+    {
+        uint32_t hash = 2166136261u;
+        for (char c : name)
+        {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    static constexpr UniformId FromString(std::string_view name)
+    {
+        return UniformId(Hash(name), nullptr);
+    }
+
+    constexpr uint32_t GetHash() const
+    {
+        return m_hash;
+    }
+
+    constexpr const char *GetName() const
+    {
+        return m_name;
+    }
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "glad/glad.h"
+#include <cstdint>
 #include <vector>
 
 /*
@@ -36,6 +37,20 @@ struct VertexAttribute
     const void *pointer;
 };
 
+/*
+ * 压缩后的 位置-法线-纹理坐标 顶点，共16字节，是 VertexPNT 的一半。
+ *  position：16位无符号归一化整数，着色器中需要用每个网格的缩放/偏移还原（见 VertexEncoder）。
+ *  normal：GL_INT_2_10_10_10_REV 格式，xyz 各10位有符号归一化整数。
+ *  texCoords：半精度浮点数，可以表示超出 [0,1] 的重复纹理坐标。
+*/
+struct VertexPackedPNT
+{
+    uint16_t position[3];
+    uint16_t padding; // 保证法线按4字节对齐
+    uint32_t normal;
+    uint16_t texCoords[2];
+};
+
 /*
  * 顶点属性布局的一些预定义组合。
 */
@@ -52,6 +67,8 @@ class VertexAttributePresets
 
     static const std::vector<VertexAttribute> &GetPosNormalTexLayout(); /* 位置-法线-纹理坐标 */
 
+    static const std::vector<VertexAttribute> &GetPackedPosNormalTexLayout(); /* 压缩的 位置-法线-纹理坐标 */
+
   private:
     // 禁止实例化该类
     VertexAttributePresets() = delete;
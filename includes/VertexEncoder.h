@@ -0,0 +1,38 @@
+#pragma once
+
+#include "VertexAttribute.h"
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <vector>
+
+/*
+ * 压缩后的顶点数据以及还原位置所需的参数：原始位置 = position_offset + position_scale * 归一化位置。
+*/
+struct PackedVertices
+{
+    std::vector<VertexPackedPNT> vertices;
+    glm::vec3 position_scale;
+    glm::vec3 position_offset;
+};
+
+/*
+ * 把交错排列的 位置-法线-纹理坐标 浮点顶点数组（每个顶点8个浮点数）编码为 VertexPackedPNT。
+ * 只做CPU计算，可以在工作线程中执行。
+*/
+class VertexEncoder
+{
+  public:
+    /*
+     * boundsMin/boundsMax 是位置的量化范围，必须包含所有顶点的位置；
+     * 多个网格使用同一个范围时它们可以共享同一组还原参数。
+    */
+    static PackedVertices EncodePosNormalTex(const GLfloat *vertices, size_t vertexNum, const glm::vec3 &boundsMin,
+                                             const glm::vec3 &boundsMax);
+
+    static PackedVertices EncodePosNormalTex(const GLfloat *vertices, size_t vertexNum);
+
+  private:
+    // 禁止实例化该类
+    VertexEncoder() = delete;
+};
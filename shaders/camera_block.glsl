@@ -0,0 +1,13 @@
+/*
+ * 每帧只更新一次、所有着色器共享的相机参数，由 CameraUniformBuffer 绑定到固定的绑定点。
+ * 通过 #include "camera_block.glsl" 引入，成员直接作为全局名字使用（view、projection、camPos 等），
+ * 引入后不能再声明同名的 uniform。布局必须与 CameraUniformBuffer.h 中的 CameraBlockData 一致（std140）。
+*/
+layout(std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 camPos;
+    float time; // 程序运行的秒数
+};
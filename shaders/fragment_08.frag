@@ -12,8 +12,8 @@ in vec3 normal;
 // 世界坐标
 in vec3 worldPos;
 
-// 摄像机位置
-uniform vec3 camPos;
+// 摄像机位置 camPos 来自 CameraBlock
+#include "camera_block.glsl"
 
 // 材质结构体
 struct Material {
@@ -22,135 +22,81 @@ struct Material {
     float shininess;
 };
 
-// 方向光
-struct DirLight {
-    vec3 direction;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-// 点光源
-struct PointLight {
-    vec3 position;
-    float constant;
-    float linear;
-    float quadratic;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-// 聚光灯
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutOff;
-    float outerCutOff;
-    float constant;
-    float linear;
-    float quadratic;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
+#include "light_block.glsl"
+#include "light_cluster.glsl"
 
 uniform Material material;
-uniform DirLight dirLight;
-uniform PointLight pointLight;
-uniform SpotLight spotLight;
 
-vec3 calDirLight()
+vec3 calDirLight(DirectionLightData light, vec3 norm, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
 {
     // 计算环境光
-    vec3 ambient = dirLight.ambient * vec3(texture(material.diffuse, texCoord).rgb);
+    vec3 ambient = light.ambient.rgb * diffuseColor;
 
     // 计算漫反射颜色
-    vec3 norm = normalize(normal);
-    vec3 lightDir = normalize(-dirLight.direction);
+    vec3 lightDir = normalize(-light.direction.xyz);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = dirLight.diffuse * diff * vec3(texture(material.diffuse, texCoord).rgb);
+    vec3 diffuse = light.diffuse.rgb * diff * diffuseColor;
 
     // 计算镜面反射颜色
-    vec3 viewDir = normalize(camPos - worldPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = dirLight.specular * spec * vec3(texture(material.specular, texCoord).rgb);
-
-    vec3 result = diffuse + ambient + specular;
+    vec3 specular = light.specular.rgb * spec * specularColor;
 
-    return result;
+    return diffuse + ambient + specular;
 }
 
-vec3 calPointLight() {
-    float distance = length(pointLight.position - worldPos);
-    float attenuation = 1.0 / (pointLight.constant + pointLight.linear * distance + pointLight.quadratic * (distance * distance));
-
-    // 计算环境光
-    vec3 ambient = pointLight.ambient * vec3(texture(material.diffuse, texCoord).rgb);
-
-    // 计算漫反射颜色
-    vec3 norm = normalize(normal);
-    vec3 lightDir = normalize(pointLight.position - worldPos);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = pointLight.diffuse * diff * vec3(texture(material.diffuse, texCoord).rgb);
-
-    // 计算镜面反射颜色
-    vec3 viewDir = normalize(camPos - worldPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = pointLight.specular * spec * vec3(texture(material.specular, texCoord).rgb);
-
-    vec3 result = diffuse + ambient + specular;
-    result *= attenuation;
-
-    return result;
-}
-
-vec3 calSpotLight()
+// 点光源和聚光灯
+vec3 calLocalLight(LocalLightData light, vec3 norm, vec3 viewDir, vec3 diffuseColor, vec3 specularColor)
 {
-    vec3 lightDir = normalize(spotLight.position - worldPos);
-    float theta = dot(lightDir, normalize(-spotLight.direction));
+    vec3 lightDir = normalize(light.position.xyz - worldPos);
 
     // 计算环境光
-    vec3 ambient = spotLight.ambient * vec3(texture(material.diffuse, texCoord).rgb);
+    vec3 ambient = light.ambient.rgb * diffuseColor;
 
     // 计算漫反射颜色
-    vec3 norm = normalize(normal);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = spotLight.diffuse * diff * vec3(texture(material.diffuse, texCoord).rgb);
+    vec3 diffuse = light.diffuse.rgb * diff * diffuseColor;
 
     // 计算镜面反射颜色
-    vec3 viewDir = normalize(camPos - worldPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = spotLight.specular * spec * vec3(texture(material.specular, texCoord).rgb);
+    vec3 specular = light.specular.rgb * spec * specularColor;
 
-    // spotlight (soft edges)
-    float epsilon = (spotLight.cutOff - spotLight.outerCutOff);
-    float intensity = clamp((theta - spotLight.outerCutOff) / epsilon, 0.0, 1.0);
+    // spotlight (soft edges)，点光源的 intensity 恒为1
+    float theta = dot(lightDir, normalize(-light.direction.xyz));
+    float cutOff = light.direction.w;
+    float outerCutOff = light.ambient.w;
+    float intensity = clamp((theta - outerCutOff) / (cutOff - outerCutOff), 0.0, 1.0);
     diffuse *= intensity;
     specular *= intensity;
 
     // attenuation
-    float distance = length(spotLight.position - worldPos);
-    float attenuation = 1.0 / (spotLight.constant + spotLight.linear * distance + spotLight.quadratic * (distance * distance));
-    ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
-
-    vec3 result = diffuse + ambient + specular;
+    float distance = length(light.position.xyz - worldPos);
+    float attenuation = 1.0 / (light.position.w + light.diffuse.w * distance + light.specular.w * (distance * distance));
 
-    return result;
+    return (diffuse + ambient + specular) * attenuation;
 }
 
 void main()
 {
-    vec3 dir_light_vec3 = calDirLight();
-    vec3 point_light_vec3 = calPointLight();
-    vec3 spot_light_vec3 = calSpotLight();
-
-    vec3 result = dir_light_vec3 + point_light_vec3 + spot_light_vec3;
+    vec3 norm = normalize(normal);
+    vec3 viewDir = normalize(camPos - worldPos);
+    vec3 diffuseColor = texture(material.diffuse, texCoord).rgb;
+    vec3 specularColor = texture(material.specular, texCoord).rgb;
+
+    vec3 result = vec3(0.0);
+
+    for (int i = 0; i < lightCounts.x; i++)
+    {
+        result += calDirLight(dirLights[i], norm, viewDir, diffuseColor, specularColor);
+    }
+
+    // 只计算片元所在簇中的点光源和聚光灯
+    uvec2 cluster = getClusterLights(worldPos);
+    for (uint i = 0u; i < cluster.y; i++)
+    {
+        result += calLocalLight(localLights[getClusterLightIndex(cluster, i)], norm, viewDir, diffuseColor, specularColor);
+    }
 
     FragColor = vec4(result, 1.0);
 }
@@ -0,0 +1,46 @@
+/*
+ * 模型矩阵和法线矩阵的来源。以 INSTANCED 宏编译时来自逐实例顶点属性（见 InstanceBuffer.h，位置必须一致），
+ * 否则来自 model / normalMatrix uniform。着色器统一通过 getModelMatrix() / getNormalMatrix() 读取，
+ * 同一份源码可以同时用于普通绘制和实例化绘制。
+*/
+#ifdef INSTANCED
+layout(location = 8) in mat4 aInstanceModel;
+layout(location = 12) in mat3 aInstanceNormalMatrix;
+layout(location = 15) in vec4 aInstanceCustom;
+
+mat4 getModelMatrix()
+{
+    return aInstanceModel;
+}
+
+mat3 getNormalMatrix()
+{
+    return aInstanceNormalMatrix;
+}
+
+// 每个实例的自定义数据，含义由使用者决定
+vec4 getInstanceCustom()
+{
+    return aInstanceCustom;
+}
+#else
+uniform mat4 model;
+
+// 法线矩阵，用于将法向量从模型空间转换为世界空间
+uniform mat3 normalMatrix;
+
+mat4 getModelMatrix()
+{
+    return model;
+}
+
+mat3 getNormalMatrix()
+{
+    return normalMatrix;
+}
+
+vec4 getInstanceCustom()
+{
+    return vec4(0.0);
+}
+#endif
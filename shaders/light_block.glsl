@@ -0,0 +1,31 @@
+/*
+ * 场景中所有灯光，由 LightManager 每帧打包上传一次。
+ * 通过 #include "light_block.glsl" 引入，布局必须与 LightManager.h 中的 LightBlockData 一致（std140）。
+*/
+#define MAX_DIRECTION_LIGHT_NUM 4
+#define MAX_LOCAL_LIGHT_NUM 192
+
+struct DirectionLightData {
+    vec4 direction; // xyz 方向
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+};
+
+// 点光源和聚光灯，点光源的内外切光角余弦值为 -1/-2，锥形衰减恒为1
+struct LocalLightData {
+    vec4 position;  // xyz 位置，w 常量衰减系数
+    vec4 direction; // xyz 聚光方向，w 内切光角的余弦值
+    vec4 ambient;   // w 外切光角的余弦值
+    vec4 diffuse;   // w 一次衰减系数
+    vec4 specular;  // w 二次衰减系数
+};
+
+layout(std140) uniform LightBlock
+{
+    ivec4 lightCounts;       // x 方向光数量，y 点光源和聚光灯的总数
+    ivec4 clusterSize;       // xyz 簇网格的尺寸
+    vec4 clusterDepthParams; // xy 由观察空间深度计算簇层号的 scale 和 bias
+    DirectionLightData dirLights[MAX_DIRECTION_LIGHT_NUM];
+    LocalLightData localLights[MAX_LOCAL_LIGHT_NUM];
+};
@@ -0,0 +1,29 @@
+/*
+ * 分簇光照：片元只计算它所在簇中的点光源和聚光灯，簇的灯光索引表由 LightManager 每帧构建并上传（见 LightCluster）。
+ * 需要先 #include "camera_block.glsl" 和 "light_block.glsl"，两个采样器由 Shader 自动设置为固定的纹理单元。
+*/
+uniform usamplerBuffer clusterLightGrid;    // 每个簇的 (offset, count)
+uniform usamplerBuffer clusterLightIndices; // 所有簇的灯光索引
+
+// 世界坐标所在簇在灯光索引表中的 (offset, count)
+uvec2 getClusterLights(vec3 worldPos)
+{
+    vec4 viewPos = view * vec4(worldPos, 1.0);
+    vec4 clipPos = projection * viewPos;
+    vec2 ndc = clipPos.xy / clipPos.w;
+
+    // x、y 在NDC中均匀划分，z 按观察空间深度指数划分
+    ivec3 cell;
+    cell.xy = ivec2(floor((ndc * 0.5 + 0.5) * vec2(clusterSize.xy)));
+    cell.z = int(floor(log(-viewPos.z) * clusterDepthParams.x + clusterDepthParams.y));
+    cell = clamp(cell, ivec3(0), clusterSize.xyz - 1);
+
+    int clusterIndex = (cell.z * clusterSize.y + cell.y) * clusterSize.x + cell.x;
+    return texelFetch(clusterLightGrid, clusterIndex).xy;
+}
+
+// 簇中第 i 个灯光在 localLights 中的下标
+int getClusterLightIndex(uvec2 cluster, uint i)
+{
+    return int(texelFetch(clusterLightIndices, int(cluster.x + i)).r);
+}
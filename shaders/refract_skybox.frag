@@ -9,8 +9,8 @@ in vec3 normal;
 // 世界坐标
 in vec3 worldPos;
 
-// 摄像机位置
-uniform vec3 camPos;
+// 摄像机位置 camPos 来自 CameraBlock
+#include "camera_block.glsl"
 
 uniform samplerCube skybox;
 
@@ -10,10 +10,7 @@ layout(location = 0) in vec3 aPos;
 */
 out vec3 texCoord;
 
-// 去除了平移的视点矩阵
-uniform mat4 rotView;
-
-uniform mat4 projection;
+#include "camera_block.glsl"
 
 void main()
 {
@@ -22,6 +19,9 @@ void main()
     // 天空盒的网格通常是一个立方体，顶点的坐标范围在 [-1, 1] 之间。
     // 由于这些顶点坐标正好可以表示立方体中的方向向量，因此可以直接将顶点坐标 aPos 作为采样立方体贴图的纹理坐标。
     texCoord = aPos;
+
+    // 去除了平移的视点矩阵
+    mat4 rotView = mat4(mat3(view));
     vec4 pos = projection * rotView * vec4(aPos, 1.0);
 
     // 在 OpenGL 渲染天空盒时，gl_Position = pos.xyww 是一种优化技巧，目的是让天空盒的顶点在深度缓冲中始终位于最远处，避免影响场景中其他物体的深度值。
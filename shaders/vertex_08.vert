@@ -15,19 +15,31 @@ out vec3 normal;
 // 传递给片段着色器的世界坐标
 out vec3 worldPos;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "camera_block.glsl"
 
-// 法线矩阵，用于将法向量从模型空间转换为世界空间
-uniform mat3 normalMatrix;
+// 模型矩阵和法线矩阵来自 uniform 或逐实例属性（以 INSTANCED 宏编译时）
+#include "instance_attributes.glsl"
+
+#ifdef QUANTIZED_POSITION
+// 量化位置的还原参数，aPos 是 [0,1] 范围内的归一化坐标
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+#endif
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+#ifdef QUANTIZED_POSITION
+    vec3 position = positionOffset + positionScale * aPos;
+#else
+    vec3 position = aPos;
+#endif
+
+    mat4 modelMatrix = getModelMatrix();
+
+    gl_Position = viewProjection * modelMatrix * vec4(position, 1.0);
 
-    worldPos = vec3(model * vec4(aPos, 1.0));
+    worldPos = vec3(modelMatrix * vec4(position, 1.0));
 
     texCoord = aTexCoord;
-    normal = normalMatrix * aNormal; // 转换法向量
+    normal = getNormalMatrix() * aNormal; // 转换法向量
 }
@@ -7,12 +7,14 @@ layout(location = 2) in vec2 aTexCoord;
 
 out vec2 texCoord;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// 模型矩阵来自 uniform 或逐实例属性（以 INSTANCED 宏编译时）
+#include "instance_attributes.glsl"
+
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * getModelMatrix() * vec4(aPos, 1.0);
     texCoord = aTexCoord;
 }
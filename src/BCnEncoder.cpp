@@ -0,0 +1,558 @@
+#include "BCnEncoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BCN_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+/*
+ * 读取一个 4x4 块的 RGBA 像素，超出图像范围的像素重复使用边缘像素。
+*/
+void FetchBlock(const uint8_t *rgba, int width, int height, int blockX, int blockY, uint8_t block[64])
+{
+    for (int y = 0; y < 4; y++)
+    {
+        const int src_y = std::min(blockY * 4 + y, height - 1);
+        for (int x = 0; x < 4; x++)
+        {
+            const int src_x = std::min(blockX * 4 + x, width - 1);
+            std::memcpy(block + (y * 4 + x) * 4, rgba + (static_cast<size_t>(src_y) * width + src_x) * 4, 4);
+        }
+    }
+}
+
+uint16_t PackRGB565(int r, int g, int b)
+{
+    r = std::clamp(r, 0, 255);
+    g = std::clamp(g, 0, 255);
+    b = std::clamp(b, 0, 255);
+    return static_cast<uint16_t>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+}
+
+void UnpackRGB565(uint16_t color, int rgb[3])
+{
+    const int r = (color >> 11) & 0x1F;
+    const int g = (color >> 5) & 0x3F;
+    const int b = color & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+void BuildColorPalette(uint16_t color0, uint16_t color1, bool fourColor, int palette[4][3])
+{
+    UnpackRGB565(color0, palette[0]);
+    UnpackRGB565(color1, palette[1]);
+    for (int c = 0; c < 3; c++)
+    {
+        if (fourColor)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+}
+
+/*
+ * 计算块内 RGB 的最小值和最大值。
+*/
+void ComputeColorBounds(const uint8_t block[64], int minColor[3], int maxColor[3])
+{
+#ifdef BCN_USE_SSE2
+    // 每个寄存器存放一行4个像素，按字节求最小/最大值后再在4个像素之间归约
+    __m128i min_value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+    __m128i max_value = min_value;
+    for (int row = 1; row < 4; row++)
+    {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + row * 16));
+        min_value = _mm_min_epu8(min_value, pixels);
+        max_value = _mm_max_epu8(max_value, pixels);
+    }
+    min_value = _mm_min_epu8(min_value, _mm_shuffle_epi32(min_value, _MM_SHUFFLE(1, 0, 3, 2)));
+    min_value = _mm_min_epu8(min_value, _mm_shuffle_epi32(min_value, _MM_SHUFFLE(2, 3, 0, 1)));
+    max_value = _mm_max_epu8(max_value, _mm_shuffle_epi32(max_value, _MM_SHUFFLE(1, 0, 3, 2)));
+    max_value = _mm_max_epu8(max_value, _mm_shuffle_epi32(max_value, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    const uint32_t min_packed = static_cast<uint32_t>(_mm_cvtsi128_si32(min_value));
+    const uint32_t max_packed = static_cast<uint32_t>(_mm_cvtsi128_si32(max_value));
+    for (int c = 0; c < 3; c++)
+    {
+        minColor[c] = (min_packed >> (c * 8)) & 0xFF;
+        maxColor[c] = (max_packed >> (c * 8)) & 0xFF;
+    }
+#else
+    for (int c = 0; c < 3; c++)
+    {
+        minColor[c] = 255;
+        maxColor[c] = 0;
+    }
+    for (int idx = 0; idx < 16; idx++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            minColor[c] = std::min(minColor[c], static_cast<int>(block[idx * 4 + c]));
+            maxColor[c] = std::max(maxColor[c], static_cast<int>(block[idx * 4 + c]));
+        }
+    }
+#endif
+}
+
+/*
+ * 为每个像素选择调色板中距离最近的颜色，返回块的总平方误差。
+*/
+int SelectColorIndices(const uint8_t block[64], const int palette[4][3], uint32_t &indices)
+{
+#ifdef BCN_USE_SSE2
+    const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i palette_color[4];
+    for (int k = 0; k < 4; k++)
+    {
+        palette_color[k] = _mm_set1_epi32(palette[k][0] | palette[k][1] << 8 | palette[k][2] << 16);
+    }
+
+    int total_error = 0;
+    indices = 0;
+    for (int row = 0; row < 4; row++)
+    {
+        const __m128i pixels =
+            _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + row * 16)), rgb_mask);
+
+        __m128i best_error = _mm_set1_epi32(std::numeric_limits<int>::max());
+        __m128i best_index = zero;
+        for (int k = 0; k < 4; k++)
+        {
+            // 无符号饱和减法求逐字节的差的绝对值，扩展为16位后用 madd 求平方和
+            const __m128i diff =
+                _mm_or_si128(_mm_subs_epu8(pixels, palette_color[k]), _mm_subs_epu8(palette_color[k], pixels));
+            const __m128i diff_lo = _mm_unpacklo_epi8(diff, zero);
+            const __m128i diff_hi = _mm_unpackhi_epi8(diff, zero);
+            const __m128 sum_lo = _mm_castsi128_ps(_mm_madd_epi16(diff_lo, diff_lo));
+            const __m128 sum_hi = _mm_castsi128_ps(_mm_madd_epi16(diff_hi, diff_hi));
+
+            // 每个像素的 (r²+g²) 与 (b²+a²) 分别位于相邻的两个32位通道，重排后相加得到4个像素的距离
+            const __m128i even = _mm_castps_si128(_mm_shuffle_ps(sum_lo, sum_hi, _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(sum_lo, sum_hi, _MM_SHUFFLE(3, 1, 3, 1)));
+            const __m128i error = _mm_add_epi32(even, odd);
+
+            const __m128i better = _mm_cmplt_epi32(error, best_error);
+            best_error = _mm_or_si128(_mm_and_si128(better, error), _mm_andnot_si128(better, best_error));
+            best_index =
+                _mm_or_si128(_mm_and_si128(better, _mm_set1_epi32(k)), _mm_andnot_si128(better, best_index));
+        }
+
+        alignas(16) int errors[4];
+        alignas(16) int row_indices[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(errors), best_error);
+        _mm_store_si128(reinterpret_cast<__m128i *>(row_indices), best_index);
+        for (int x = 0; x < 4; x++)
+        {
+            total_error += errors[x];
+            indices |= static_cast<uint32_t>(row_indices[x]) << ((row * 4 + x) * 2);
+        }
+    }
+    return total_error;
+#else
+    int total_error = 0;
+    indices = 0;
+    for (int idx = 0; idx < 16; idx++)
+    {
+        int best_error = std::numeric_limits<int>::max();
+        uint32_t best_index = 0;
+        for (int k = 0; k < 4; k++)
+        {
+            int error = 0;
+            for (int c = 0; c < 3; c++)
+            {
+                const int diff = block[idx * 4 + c] - palette[k][c];
+                error += diff * diff;
+            }
+            if (error < best_error)
+            {
+                best_error = error;
+                best_index = static_cast<uint32_t>(k);
+            }
+        }
+        total_error += best_error;
+        indices |= best_index << (idx * 2);
+    }
+    return total_error;
+#endif
+}
+
+/*
+ * 用给定的端点编码颜色块，保证 color0 > color1（四色模式），返回块的总平方误差。
+*/
+int EncodeColorEndpoints(const uint8_t block[64], uint16_t &color0, uint16_t &color1, uint32_t &indices)
+{
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    int palette[4][3];
+    BuildColorPalette(color0, color1, true, palette);
+
+    if (color0 == color1)
+    {
+        // 两个端点相同时解码器进入三色模式，只使用下标0（等于 color0）仍然是正确的
+        indices = 0;
+        int error = 0;
+        for (int idx = 0; idx < 16; idx++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                const int diff = block[idx * 4 + c] - palette[0][c];
+                error += diff * diff;
+            }
+        }
+        return error;
+    }
+
+    return SelectColorIndices(block, palette, indices);
+}
+
+/*
+ * 固定每个像素的下标，用最小二乘法求使误差最小的两个端点。
+ * 下标0、1、2、3对应的 color0 权重分别为 1、0、2/3、1/3。
+*/
+bool SolveColorEndpoints(const uint8_t block[64], uint32_t indices, float endpoint0[3], float endpoint1[3])
+{
+    static const float WEIGHTS[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+    float alpha2 = 0.0f, beta2 = 0.0f, alpha_beta = 0.0f;
+    float alpha_x[3] = {0.0f, 0.0f, 0.0f};
+    float beta_x[3] = {0.0f, 0.0f, 0.0f};
+
+    for (int idx = 0; idx < 16; idx++)
+    {
+        const float alpha = WEIGHTS[(indices >> (idx * 2)) & 3];
+        const float beta = 1.0f - alpha;
+        alpha2 += alpha * alpha;
+        beta2 += beta * beta;
+        alpha_beta += alpha * beta;
+        for (int c = 0; c < 3; c++)
+        {
+            alpha_x[c] += alpha * block[idx * 4 + c];
+            beta_x[c] += beta * block[idx * 4 + c];
+        }
+    }
+
+    const float denominator = alpha2 * beta2 - alpha_beta * alpha_beta;
+    if (std::fabs(denominator) < 1e-6f)
+        return false;
+
+    const float inv = 1.0f / denominator;
+    for (int c = 0; c < 3; c++)
+    {
+        endpoint0[c] = (alpha_x[c] * beta2 - beta_x[c] * alpha_beta) * inv;
+        endpoint1[c] = (beta_x[c] * alpha2 - alpha_x[c] * alpha_beta) * inv;
+    }
+    return true;
+}
+
+void WriteColorBlock(uint16_t color0, uint16_t color1, uint32_t indices, uint8_t *output)
+{
+    output[0] = static_cast<uint8_t>(color0 & 0xFF);
+    output[1] = static_cast<uint8_t>(color0 >> 8);
+    output[2] = static_cast<uint8_t>(color1 & 0xFF);
+    output[3] = static_cast<uint8_t>(color1 >> 8);
+    for (int byte = 0; byte < 4; byte++)
+        output[4 + byte] = static_cast<uint8_t>(indices >> (byte * 8));
+}
+
+/*
+ * BC1 颜色块：包围盒向内收缩1/16作为初始端点，再用最小二乘修正一次，保留误差更小的结果。
+*/
+void EncodeColorBlock(const uint8_t block[64], uint8_t *output)
+{
+    int min_color[3], max_color[3];
+    ComputeColorBounds(block, min_color, max_color);
+
+    // 包围盒的角点通常不在像素分布的主轴上，向内收缩可以减小平均误差
+    for (int c = 0; c < 3; c++)
+    {
+        const int inset = (max_color[c] - min_color[c]) >> 4;
+        min_color[c] += inset;
+        max_color[c] -= inset;
+    }
+
+    uint16_t color0 = PackRGB565(max_color[0], max_color[1], max_color[2]);
+    uint16_t color1 = PackRGB565(min_color[0], min_color[1], min_color[2]);
+    uint32_t indices;
+    const int error = EncodeColorEndpoints(block, color0, color1, indices);
+
+    if (error > 0 && color0 != color1)
+    {
+        float endpoint0[3], endpoint1[3];
+        if (SolveColorEndpoints(block, indices, endpoint0, endpoint1))
+        {
+            uint16_t refined0 = PackRGB565(static_cast<int>(std::lround(endpoint0[0])),
+                                           static_cast<int>(std::lround(endpoint0[1])),
+                                           static_cast<int>(std::lround(endpoint0[2])));
+            uint16_t refined1 = PackRGB565(static_cast<int>(std::lround(endpoint1[0])),
+                                           static_cast<int>(std::lround(endpoint1[1])),
+                                           static_cast<int>(std::lround(endpoint1[2])));
+            uint32_t refined_indices;
+            if (EncodeColorEndpoints(block, refined0, refined1, refined_indices) < error)
+            {
+                color0 = refined0;
+                color1 = refined1;
+                indices = refined_indices;
+            }
+        }
+    }
+
+    WriteColorBlock(color0, color1, indices, output);
+}
+
+/*
+ * 8值模式的单通道调色板（endpoint0 > endpoint1），插值按四舍五入取整。
+*/
+void BuildAlphaPalette(int endpoint0, int endpoint1, int palette[8])
+{
+    palette[0] = endpoint0;
+    palette[1] = endpoint1;
+    if (endpoint0 > endpoint1)
+    {
+        for (int code = 2; code < 8; code++)
+            palette[code] = ((8 - code) * endpoint0 + (code - 1) * endpoint1 + 3) / 7;
+    }
+    else
+    {
+        for (int code = 2; code < 6; code++)
+            palette[code] = ((6 - code) * endpoint0 + (code - 1) * endpoint1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+/*
+ * BC4 单通道块：使用块内的最大值和最小值作为端点，在8个插值中为每个像素选择最近的一个。
+ * channel 为源像素中读取的通道（0-3）。
+*/
+void EncodeAlphaBlock(const uint8_t block[64], int channel, uint8_t *output)
+{
+    int min_value = 255, max_value = 0;
+    for (int idx = 0; idx < 16; idx++)
+    {
+        min_value = std::min(min_value, static_cast<int>(block[idx * 4 + channel]));
+        max_value = std::max(max_value, static_cast<int>(block[idx * 4 + channel]));
+    }
+
+    output[0] = static_cast<uint8_t>(max_value);
+    output[1] = static_cast<uint8_t>(min_value);
+
+    uint64_t bits = 0;
+    if (max_value > min_value)
+    {
+        int palette[8];
+        BuildAlphaPalette(max_value, min_value, palette);
+
+        for (int idx = 0; idx < 16; idx++)
+        {
+            const int value = block[idx * 4 + channel];
+            int best_code = 0;
+            int best_error = std::numeric_limits<int>::max();
+            for (int code = 0; code < 8; code++)
+            {
+                const int error = std::abs(value - palette[code]);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best_code = code;
+                }
+            }
+            bits |= static_cast<uint64_t>(best_code) << (idx * 3);
+        }
+    }
+
+    for (int byte = 0; byte < 6; byte++)
+        output[2 + byte] = static_cast<uint8_t>(bits >> (byte * 8));
+}
+
+void DecodeColorBlock(const uint8_t *input, bool forceFourColor, uint8_t block[64])
+{
+    const uint16_t color0 = static_cast<uint16_t>(input[0] | input[1] << 8);
+    const uint16_t color1 = static_cast<uint16_t>(input[2] | input[3] << 8);
+    const uint32_t indices = static_cast<uint32_t>(input[4]) | static_cast<uint32_t>(input[5]) << 8 |
+                             static_cast<uint32_t>(input[6]) << 16 | static_cast<uint32_t>(input[7]) << 24;
+
+    const bool four_color = forceFourColor || color0 > color1;
+    int palette[4][3];
+    BuildColorPalette(color0, color1, four_color, palette);
+
+    for (int idx = 0; idx < 16; idx++)
+    {
+        const uint32_t code = (indices >> (idx * 2)) & 3;
+        for (int c = 0; c < 3; c++)
+            block[idx * 4 + c] = static_cast<uint8_t>(palette[code][c]);
+        block[idx * 4 + 3] = (!four_color && code == 3) ? 0 : 255;
+    }
+}
+
+void DecodeAlphaBlock(const uint8_t *input, int channel, uint8_t block[64])
+{
+    int palette[8];
+    BuildAlphaPalette(input[0], input[1], palette);
+
+    uint64_t bits = 0;
+    for (int byte = 0; byte < 6; byte++)
+        bits |= static_cast<uint64_t>(input[2 + byte]) << (byte * 8);
+
+    for (int idx = 0; idx < 16; idx++)
+        block[idx * 4 + channel] = static_cast<uint8_t>(palette[(bits >> (idx * 3)) & 7]);
+}
+} // namespace
+
+size_t BCnEncoder::GetBlockSize(BCFormat format)
+{
+    return (format == BCFormat::BC1 || format == BCFormat::BC4) ? 8 : 16;
+}
+
+size_t BCnEncoder::GetCompressedSize(BCFormat format, int width, int height)
+{
+    const size_t blocks_x = static_cast<size_t>(std::max(1, (width + 3) / 4));
+    const size_t blocks_y = static_cast<size_t>(std::max(1, (height + 3) / 4));
+    return blocks_x * blocks_y * GetBlockSize(format);
+}
+
+GLenum BCnEncoder::GetGLFormat(BCFormat format)
+{
+    switch (format)
+    {
+    case BCFormat::BC1:
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BCFormat::BC3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BCFormat::BC4:
+        return GL_COMPRESSED_RED_RGTC1;
+    case BCFormat::BC5:
+        return GL_COMPRESSED_RG_RGTC2;
+    }
+    return 0;
+}
+
+void BCnEncoder::Encode(BCFormat format, const uint8_t *rgba, int width, int height, uint8_t *output)
+{
+    const int blocks_x = (width + 3) / 4;
+    const int blocks_y = (height + 3) / 4;
+    const size_t block_size = GetBlockSize(format);
+
+    uint8_t block[64];
+    for (int block_y = 0; block_y < blocks_y; block_y++)
+    {
+        for (int block_x = 0; block_x < blocks_x; block_x++)
+        {
+            FetchBlock(rgba, width, height, block_x, block_y, block);
+            uint8_t *dst = output + (static_cast<size_t>(block_y) * blocks_x + block_x) * block_size;
+
+            switch (format)
+            {
+            case BCFormat::BC1:
+                EncodeColorBlock(block, dst);
+                break;
+            case BCFormat::BC3:
+                EncodeAlphaBlock(block, 3, dst);
+                EncodeColorBlock(block, dst + 8);
+                break;
+            case BCFormat::BC4:
+                EncodeAlphaBlock(block, 0, dst);
+                break;
+            case BCFormat::BC5:
+                EncodeAlphaBlock(block, 0, dst);
+                EncodeAlphaBlock(block, 1, dst + 8);
+                break;
+            }
+        }
+    }
+}
+
+void BCnEncoder::Decode(BCFormat format, const uint8_t *blocks, int width, int height, uint8_t *rgba)
+{
+    const int blocks_x = (width + 3) / 4;
+    const int blocks_y = (height + 3) / 4;
+    const size_t block_size = GetBlockSize(format);
+
+    uint8_t block[64];
+    for (int block_y = 0; block_y < blocks_y; block_y++)
+    {
+        for (int block_x = 0; block_x < blocks_x; block_x++)
+        {
+            const uint8_t *src = blocks + (static_cast<size_t>(block_y) * blocks_x + block_x) * block_size;
+
+            for (int idx = 0; idx < 16; idx++)
+            {
+                block[idx * 4] = block[idx * 4 + 1] = block[idx * 4 + 2] = 0;
+                block[idx * 4 + 3] = 255;
+            }
+
+            switch (format)
+            {
+            case BCFormat::BC1:
+                DecodeColorBlock(src, false, block);
+                break;
+            case BCFormat::BC3:
+                // BC3 的颜色块总是按四色模式解码
+                DecodeColorBlock(src + 8, true, block);
+                DecodeAlphaBlock(src, 3, block);
+                break;
+            case BCFormat::BC4:
+                DecodeAlphaBlock(src, 0, block);
+                break;
+            case BCFormat::BC5:
+                DecodeAlphaBlock(src, 0, block);
+                DecodeAlphaBlock(src + 8, 1, block);
+                break;
+            }
+
+            for (int y = 0; y < 4 && block_y * 4 + y < height; y++)
+            {
+                for (int x = 0; x < 4 && block_x * 4 + x < width; x++)
+                {
+                    const size_t dst = (static_cast<size_t>(block_y * 4 + y) * width + block_x * 4 + x) * 4;
+                    std::memcpy(rgba + dst, block + (y * 4 + x) * 4, 4);
+                }
+            }
+        }
+    }
+}
+
+double BCnEncoder::ComputePSNR(BCFormat format, const uint8_t *reference, const uint8_t *decoded, int width,
+                               int height)
+{
+    int channel_num = 3;
+    if (format == BCFormat::BC3)
+        channel_num = 4;
+    else if (format == BCFormat::BC4)
+        channel_num = 1;
+    else if (format == BCFormat::BC5)
+        channel_num = 2;
+
+    const size_t pixel_num = static_cast<size_t>(width) * height;
+    double squared_error = 0.0;
+    for (size_t idx = 0; idx < pixel_num; idx++)
+    {
+        for (int c = 0; c < channel_num; c++)
+        {
+            const double diff = static_cast<double>(reference[idx * 4 + c]) - decoded[idx * 4 + c];
+            squared_error += diff * diff;
+        }
+    }
+
+    if (pixel_num == 0 || squared_error == 0.0)
+        return std::numeric_limits<double>::infinity();
+
+    const double mse = squared_error / static_cast<double>(pixel_num * channel_num);
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
@@ -8,4 +8,19 @@ BaseLight::BaseLight(const glm::vec3 &ambient, const glm::vec3 &diffuse, const g
 
 BaseLight::~BaseLight()
 {
-}
\ No newline at end of file
+}
+
+const glm::vec3 &BaseLight::GetAmbient() const
+{
+    return m_ambient;
+}
+
+const glm::vec3 &BaseLight::GetDiffuse() const
+{
+    return m_diffuse;
+}
+
+const glm::vec3 &BaseLight::GetSpecular() const
+{
+    return m_specular;
+}
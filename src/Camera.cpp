@@ -26,6 +26,21 @@ glm::vec3 Camera::GetFront() const
     return m_front;
 }
 
+double Camera::GetFov() const
+{
+    return m_fov;
+}
+
+double Camera::GetNear() const
+{
+    return m_near;
+}
+
+double Camera::GetFar() const
+{
+    return m_far;
+}
+
 glm::mat4 Camera::GetViewMatrix()
 {
     /*
@@ -67,6 +82,32 @@ glm::mat4 Camera::GetProjectionMatrix()
     return projection;
 }
 
+void Camera::GetFrustumPlanes(glm::vec4 planes[6])
+{
+    /*
+     * Gribb-Hartmann 方法：裁剪空间中点在视锥体内的条件为 -w <= x, y, z <= w，
+     * 设 M = projection * view，第 i 行为 r_i，则 x >= -w 即 dot(r_3 + r_0, p) >= 0，其余平面同理。
+     * glm 的矩阵按列存储，m[c][r] 为第 c 列第 r 行。
+    */
+    const glm::mat4 m = GetProjectionMatrix() * GetViewMatrix();
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0; // 左
+    planes[1] = row3 - row0; // 右
+    planes[2] = row3 + row1; // 下
+    planes[3] = row3 - row1; // 上
+    planes[4] = row3 + row2; // 近
+    planes[5] = row3 - row2; // 远
+
+    for (int idx = 0; idx < 6; idx++)
+    {
+        planes[idx] /= glm::length(glm::vec3(planes[idx]));
+    }
+}
+
 void Camera::MoveForwardOrBackward(float delta)
 {
     m_pos += glm::normalize(m_front) * delta;
@@ -0,0 +1,46 @@
+#include "CameraUniformBuffer.h"
+#include "UniformBlockBinding.h"
+#include <iostream>
+
+CameraUniformBuffer::CameraUniformBuffer() : m_ring(nullptr), m_data()
+{
+}
+
+CameraUniformBuffer::~CameraUniformBuffer()
+{
+}
+
+bool CameraUniformBuffer::Init(FrameRingBuffer *ring)
+{
+    if (!ring || ring->GetBufferID() == 0)
+    {
+        std::cerr << "CameraUniformBuffer init failed!" << std::endl;
+        return false;
+    }
+
+    m_ring = ring;
+    return true;
+}
+
+void CameraUniformBuffer::Update(Camera &camera, float time)
+{
+    if (!m_ring)
+        return;
+
+    m_data.view = camera.GetViewMatrix();
+    m_data.projection = camera.GetProjectionMatrix();
+    m_data.view_projection = m_data.projection * m_data.view;
+    m_data.cam_pos = camera.GetPos();
+    m_data.time = time;
+
+    /*
+     * 每帧写入环形缓冲区中新的一段，再把绑定点指向这一段，
+     * GPU 可能仍在读取的上一帧数据不会被覆盖，也不需要 glBufferSubData 的驱动复制。
+    */
+    m_ring->UploadUniformBlock(UNIFORM_BLOCK_CAMERA, &m_data, sizeof(CameraBlockData));
+}
+
+const CameraBlockData &CameraUniformBuffer::GetData() const
+{
+    return m_data;
+}
@@ -8,4 +8,19 @@ DirectionLight::DirectionLight(const glm::vec3 &direction, const glm::vec3 &ambi
 
 DirectionLight::~DirectionLight()
 {
-}
\ No newline at end of file
+}
+
+LightType DirectionLight::GetType() const
+{
+    return LightType::Direction;
+}
+
+const glm::vec3 &DirectionLight::GetDirection() const
+{
+    return m_direction;
+}
+
+void DirectionLight::SetDirection(const glm::vec3 &direction)
+{
+    m_direction = direction;
+}
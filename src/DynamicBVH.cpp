@@ -0,0 +1,589 @@
+#include "DynamicBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+float SurfaceArea(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    const glm::vec3 size = boundsMax - boundsMin;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+float UnionArea(const glm::vec3 &min0, const glm::vec3 &max0, const glm::vec3 &min1, const glm::vec3 &max1)
+{
+    return SurfaceArea(glm::min(min0, min1), glm::max(max0, max1));
+}
+
+bool Contains(const glm::vec3 &outerMin, const glm::vec3 &outerMax, const glm::vec3 &innerMin,
+              const glm::vec3 &innerMax)
+{
+    return glm::all(glm::lessThanEqual(outerMin, innerMin)) && glm::all(glm::lessThanEqual(innerMax, outerMax));
+}
+
+/* 包围盒与视锥体的关系 */
+enum class FrustumTest
+{
+    Outside,
+    Intersect,
+    Inside,
+};
+
+FrustumTest TestFrustum(const glm::vec4 planes[6], const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    const glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+
+    FrustumTest result = FrustumTest::Inside;
+    for (int idx = 0; idx < 6; idx++)
+    {
+        const glm::vec3 normal(planes[idx]);
+        const float distance = glm::dot(normal, center) + planes[idx].w;
+        const float radius = glm::dot(glm::abs(normal), extent);
+
+        if (distance + radius < 0.0f)
+            return FrustumTest::Outside;
+        if (distance - radius < 0.0f)
+            result = FrustumTest::Intersect;
+    }
+    return result;
+}
+
+bool TestSphere(const glm::vec3 &center, float radius, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    const glm::vec3 offset = glm::clamp(center, boundsMin, boundsMax) - center;
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+/* 射线与包围盒的 slab 测试，相交时返回 true 并给出进入距离（起点在内部时为0） */
+bool TestRay(const glm::vec3 &origin, const glm::vec3 &invDirection, float maxDistance, const glm::vec3 &boundsMin,
+             const glm::vec3 &boundsMax, float &distance)
+{
+    float t_min = 0.0f;
+    float t_max = maxDistance;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        // 方向分量为0时 invDirection 为无穷大，起点在 slab 内时得到 [-inf, inf]，否则得到空区间
+        float t0 = (boundsMin[axis] - origin[axis]) * invDirection[axis];
+        float t1 = (boundsMax[axis] - origin[axis]) * invDirection[axis];
+        if (std::isnan(t0) || std::isnan(t1))
+        {
+            // 起点恰好在 slab 边界上且方向分量为0
+            if (origin[axis] < boundsMin[axis] || origin[axis] > boundsMax[axis])
+                return false;
+            continue;
+        }
+        if (t0 > t1)
+            std::swap(t0, t1);
+
+        t_min = std::max(t_min, t0);
+        t_max = std::min(t_max, t1);
+        if (t_min > t_max)
+            return false;
+    }
+
+    distance = t_min;
+    return true;
+}
+} // namespace
+
+DynamicBVH::DynamicBVH(float margin) : m_root(NULL_NODE), m_free_list(NULL_NODE), m_proxy_num(0), m_margin(margin)
+{
+}
+
+DynamicBVH::~DynamicBVH()
+{
+}
+
+int DynamicBVH::AllocateNode()
+{
+    int node = m_free_list;
+    if (node == NULL_NODE)
+    {
+        node = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    else
+    {
+        m_free_list = m_nodes[node].parent;
+    }
+
+    Node &new_node = m_nodes[node];
+    new_node.parent = NULL_NODE;
+    new_node.child1 = NULL_NODE;
+    new_node.child2 = NULL_NODE;
+    new_node.height = 0;
+    new_node.user_index = INVALID_USER_INDEX;
+    return node;
+}
+
+void DynamicBVH::FreeNode(int node)
+{
+    m_nodes[node].parent = m_free_list;
+    m_nodes[node].height = -1;
+    m_free_list = node;
+}
+
+int DynamicBVH::CreateProxy(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, uint32_t userIndex)
+{
+    const int proxy = AllocateNode();
+
+    Node &node = m_nodes[proxy];
+    node.min = boundsMin;
+    node.max = boundsMax;
+    node.fat_min = boundsMin - glm::vec3(m_margin);
+    node.fat_max = boundsMax + glm::vec3(m_margin);
+    node.user_index = userIndex;
+
+    InsertLeaf(proxy);
+    m_proxy_num++;
+
+    return proxy;
+}
+
+void DynamicBVH::DestroyProxy(int proxy)
+{
+    if (proxy < 0 || proxy >= static_cast<int>(m_nodes.size()) || !m_nodes[proxy].IsLeaf() ||
+        m_nodes[proxy].height < 0)
+        return;
+
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    m_proxy_num--;
+}
+
+bool DynamicBVH::MoveProxy(int proxy, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    Node &node = m_nodes[proxy];
+    node.min = boundsMin;
+    node.max = boundsMax;
+
+    /*
+     * 仍在宽松包围盒内时不需要修改树。
+     * 但如果宽松包围盒比需要的大得多（例如实例缩小了），也重新插入，避免查询时产生过多误判。
+    */
+    const glm::vec3 fat_min = boundsMin - glm::vec3(m_margin);
+    const glm::vec3 fat_max = boundsMax + glm::vec3(m_margin);
+    const glm::vec3 huge_min = fat_min - glm::vec3(4.0f * m_margin);
+    const glm::vec3 huge_max = fat_max + glm::vec3(4.0f * m_margin);
+    if (Contains(node.fat_min, node.fat_max, boundsMin, boundsMax) &&
+        Contains(huge_min, huge_max, node.fat_min, node.fat_max))
+        return false;
+
+    RemoveLeaf(proxy);
+    m_nodes[proxy].fat_min = fat_min;
+    m_nodes[proxy].fat_max = fat_max;
+    InsertLeaf(proxy);
+
+    return true;
+}
+
+uint32_t DynamicBVH::GetUserIndex(int proxy) const
+{
+    return m_nodes[proxy].user_index;
+}
+
+void DynamicBVH::Clear()
+{
+    m_nodes.clear();
+    m_root = NULL_NODE;
+    m_free_list = NULL_NODE;
+    m_proxy_num = 0;
+}
+
+void DynamicBVH::InsertLeaf(int leaf)
+{
+    if (m_root == NULL_NODE)
+    {
+        m_root = leaf;
+        m_nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    const glm::vec3 leaf_min = m_nodes[leaf].fat_min;
+    const glm::vec3 leaf_max = m_nodes[leaf].fat_max;
+
+    /*
+     * 从根向下选择兄弟节点：在当前节点处与新叶节点合并的代价为合并后的表面积的2倍，
+     * 继续向下时，当前节点的包围盒至少要扩大到包含新叶节点（继承代价），再加上在子节点处合并的代价。
+     * 在当前节点处合并更便宜时停止。
+    */
+    int index = m_root;
+    while (!m_nodes[index].IsLeaf())
+    {
+        const Node &node = m_nodes[index];
+        const float area = SurfaceArea(node.fat_min, node.fat_max);
+        const float combined_area = UnionArea(node.fat_min, node.fat_max, leaf_min, leaf_max);
+
+        const float cost = 2.0f * combined_area;
+        const float inheritance_cost = 2.0f * (combined_area - area);
+
+        auto child_cost = [&](int child) {
+            const Node &child_node = m_nodes[child];
+            const float union_area = UnionArea(child_node.fat_min, child_node.fat_max, leaf_min, leaf_max);
+            if (child_node.IsLeaf())
+                return union_area + inheritance_cost;
+            return union_area - SurfaceArea(child_node.fat_min, child_node.fat_max) + inheritance_cost;
+        };
+
+        const float cost1 = child_cost(node.child1);
+        const float cost2 = child_cost(node.child2);
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const int sibling = index;
+    const int old_parent = m_nodes[sibling].parent;
+
+    const int new_parent = AllocateNode();
+    Node &parent_node = m_nodes[new_parent];
+    parent_node.parent = old_parent;
+    parent_node.fat_min = glm::min(leaf_min, m_nodes[sibling].fat_min);
+    parent_node.fat_max = glm::max(leaf_max, m_nodes[sibling].fat_max);
+    parent_node.height = m_nodes[sibling].height + 1;
+    parent_node.child1 = sibling;
+    parent_node.child2 = leaf;
+
+    if (old_parent != NULL_NODE)
+    {
+        if (m_nodes[old_parent].child1 == sibling)
+            m_nodes[old_parent].child1 = new_parent;
+        else
+            m_nodes[old_parent].child2 = new_parent;
+    }
+    else
+    {
+        m_root = new_parent;
+    }
+
+    m_nodes[sibling].parent = new_parent;
+    m_nodes[leaf].parent = new_parent;
+
+    Refit(m_nodes[leaf].parent);
+}
+
+void DynamicBVH::RemoveLeaf(int leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = NULL_NODE;
+        return;
+    }
+
+    const int parent = m_nodes[leaf].parent;
+    const int grand_parent = m_nodes[parent].parent;
+    const int sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    // 父节点被删除，兄弟节点接替它的位置
+    if (grand_parent != NULL_NODE)
+    {
+        if (m_nodes[grand_parent].child1 == parent)
+            m_nodes[grand_parent].child1 = sibling;
+        else
+            m_nodes[grand_parent].child2 = sibling;
+
+        m_nodes[sibling].parent = grand_parent;
+        FreeNode(parent);
+
+        Refit(grand_parent);
+    }
+    else
+    {
+        m_root = sibling;
+        m_nodes[sibling].parent = NULL_NODE;
+        FreeNode(parent);
+    }
+}
+
+void DynamicBVH::Refit(int node)
+{
+    int index = node;
+    while (index != NULL_NODE)
+    {
+        index = Balance(index);
+
+        Node &current = m_nodes[index];
+        const Node &child1 = m_nodes[current.child1];
+        const Node &child2 = m_nodes[current.child2];
+
+        current.height = 1 + std::max(child1.height, child2.height);
+        current.fat_min = glm::min(child1.fat_min, child2.fat_min);
+        current.fat_max = glm::max(child1.fat_max, child2.fat_max);
+
+        index = current.parent;
+    }
+}
+
+int DynamicBVH::Balance(int indexA)
+{
+    Node &a = m_nodes[indexA];
+    if (a.IsLeaf() || a.height < 2)
+        return indexA;
+
+    const int index_b = a.child1;
+    const int index_c = a.child2;
+    Node &b = m_nodes[index_b];
+    Node &c = m_nodes[index_c];
+
+    const int balance = c.height - b.height;
+
+    // 右子树过高：把 C 旋转为子树的根
+    if (balance > 1)
+    {
+        const int index_f = c.child1;
+        const int index_g = c.child2;
+        Node &f = m_nodes[index_f];
+        Node &g = m_nodes[index_g];
+
+        c.child1 = indexA;
+        c.parent = a.parent;
+        a.parent = index_c;
+
+        if (c.parent != NULL_NODE)
+        {
+            if (m_nodes[c.parent].child1 == indexA)
+                m_nodes[c.parent].child1 = index_c;
+            else
+                m_nodes[c.parent].child2 = index_c;
+        }
+        else
+        {
+            m_root = index_c;
+        }
+
+        // 较高的孙节点留在 C 下，较矮的交给 A
+        if (f.height > g.height)
+        {
+            c.child2 = index_f;
+            a.child2 = index_g;
+            g.parent = indexA;
+            a.fat_min = glm::min(b.fat_min, g.fat_min);
+            a.fat_max = glm::max(b.fat_max, g.fat_max);
+            c.fat_min = glm::min(a.fat_min, f.fat_min);
+            c.fat_max = glm::max(a.fat_max, f.fat_max);
+            a.height = 1 + std::max(b.height, g.height);
+            c.height = 1 + std::max(a.height, f.height);
+        }
+        else
+        {
+            c.child2 = index_g;
+            a.child2 = index_f;
+            f.parent = indexA;
+            a.fat_min = glm::min(b.fat_min, f.fat_min);
+            a.fat_max = glm::max(b.fat_max, f.fat_max);
+            c.fat_min = glm::min(a.fat_min, g.fat_min);
+            c.fat_max = glm::max(a.fat_max, g.fat_max);
+            a.height = 1 + std::max(b.height, f.height);
+            c.height = 1 + std::max(a.height, g.height);
+        }
+
+        return index_c;
+    }
+
+    // 左子树过高：把 B 旋转为子树的根
+    if (balance < -1)
+    {
+        const int index_d = b.child1;
+        const int index_e = b.child2;
+        Node &d = m_nodes[index_d];
+        Node &e = m_nodes[index_e];
+
+        b.child1 = indexA;
+        b.parent = a.parent;
+        a.parent = index_b;
+
+        if (b.parent != NULL_NODE)
+        {
+            if (m_nodes[b.parent].child1 == indexA)
+                m_nodes[b.parent].child1 = index_b;
+            else
+                m_nodes[b.parent].child2 = index_b;
+        }
+        else
+        {
+            m_root = index_b;
+        }
+
+        if (d.height > e.height)
+        {
+            b.child2 = index_d;
+            a.child1 = index_e;
+            e.parent = indexA;
+            a.fat_min = glm::min(c.fat_min, e.fat_min);
+            a.fat_max = glm::max(c.fat_max, e.fat_max);
+            b.fat_min = glm::min(a.fat_min, d.fat_min);
+            b.fat_max = glm::max(a.fat_max, d.fat_max);
+            a.height = 1 + std::max(c.height, e.height);
+            b.height = 1 + std::max(a.height, d.height);
+        }
+        else
+        {
+            b.child2 = index_e;
+            a.child1 = index_d;
+            d.parent = indexA;
+            a.fat_min = glm::min(c.fat_min, d.fat_min);
+            a.fat_max = glm::max(c.fat_max, d.fat_max);
+            b.fat_min = glm::min(a.fat_min, e.fat_min);
+            b.fat_max = glm::max(a.fat_max, e.fat_max);
+            a.height = 1 + std::max(c.height, d.height);
+            b.height = 1 + std::max(a.height, e.height);
+        }
+
+        return index_b;
+    }
+
+    return indexA;
+}
+
+void DynamicBVH::CollectLeaves(int node, std::vector<uint32_t> &result) const
+{
+    const size_t stack_base = m_stack.size();
+    m_stack.push_back(node);
+    while (m_stack.size() > stack_base)
+    {
+        const Node &current = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+
+        if (current.IsLeaf())
+        {
+            result.push_back(current.user_index);
+            continue;
+        }
+
+        m_stack.push_back(current.child1);
+        m_stack.push_back(current.child2);
+    }
+}
+
+void DynamicBVH::QueryFrustum(const glm::vec4 planes[6], std::vector<uint32_t> &result) const
+{
+    if (m_root == NULL_NODE)
+        return;
+
+    m_leaf_candidates.clear();
+    m_stack.clear();
+    m_stack.push_back(m_root);
+    while (!m_stack.empty())
+    {
+        const int index = m_stack.back();
+        m_stack.pop_back();
+        const Node &node = m_nodes[index];
+
+        const FrustumTest test = TestFrustum(planes, node.fat_min, node.fat_max);
+        if (test == FrustumTest::Outside)
+            continue;
+
+        // 宽松包围盒完全在视锥体内时，整棵子树都可见，不再逐个测试
+        if (test == FrustumTest::Inside)
+        {
+            CollectLeaves(index, result);
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            m_leaf_candidates.push_back(index);
+            continue;
+        }
+
+        m_stack.push_back(node.child1);
+        m_stack.push_back(node.child2);
+    }
+
+    // 与视锥体边界相交的叶节点用精确包围盒批量测试
+    m_leaf_culler.Begin();
+    for (int leaf : m_leaf_candidates)
+    {
+        m_leaf_culler.Add(m_nodes[leaf].min, m_nodes[leaf].max);
+    }
+    m_leaf_culler.Cull(planes);
+
+    for (size_t idx = 0; idx < m_leaf_candidates.size(); idx++)
+    {
+        if (m_leaf_culler.IsVisible(idx))
+            result.push_back(m_nodes[m_leaf_candidates[idx]].user_index);
+    }
+}
+
+void DynamicBVH::QuerySphere(const glm::vec3 &center, float radius, std::vector<uint32_t> &result) const
+{
+    if (m_root == NULL_NODE)
+        return;
+
+    m_stack.clear();
+    m_stack.push_back(m_root);
+    while (!m_stack.empty())
+    {
+        const Node &node = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+
+        if (!TestSphere(center, radius, node.fat_min, node.fat_max))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            if (TestSphere(center, radius, node.min, node.max))
+                result.push_back(node.user_index);
+            continue;
+        }
+
+        m_stack.push_back(node.child1);
+        m_stack.push_back(node.child2);
+    }
+}
+
+uint32_t DynamicBVH::RayCast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+                             float &hitDistance) const
+{
+    if (m_root == NULL_NODE)
+        return INVALID_USER_INDEX;
+
+    const glm::vec3 inv_direction = 1.0f / direction;
+
+    uint32_t hit_user_index = INVALID_USER_INDEX;
+    float best_distance = maxDistance;
+
+    m_stack.clear();
+    m_stack.push_back(m_root);
+    while (!m_stack.empty())
+    {
+        const Node &node = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+
+        // 只需要比当前最近的命中更近的节点
+        float distance = 0.0f;
+        if (!TestRay(origin, inv_direction, best_distance, node.fat_min, node.fat_max, distance))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            if (TestRay(origin, inv_direction, best_distance, node.min, node.max, distance) &&
+                (hit_user_index == INVALID_USER_INDEX || distance < best_distance))
+            {
+                best_distance = distance;
+                hit_user_index = node.user_index;
+            }
+            continue;
+        }
+
+        m_stack.push_back(node.child1);
+        m_stack.push_back(node.child2);
+    }
+
+    if (hit_user_index != INVALID_USER_INDEX)
+        hitDistance = best_distance;
+    return hit_user_index;
+}
+
+size_t DynamicBVH::GetProxyNum() const
+{
+    return m_proxy_num;
+}
+
+int DynamicBVH::GetHeight() const
+{
+    return m_root == NULL_NODE ? 0 : m_nodes[m_root].height;
+}
@@ -1,4 +1,5 @@
 #include "FrameBuffer.h"
+#include "GLStateCache.h"
 
 /*
  * 在 OpenGL 中，`RenderBuffer Object`（RBO）和 `Texture Object` 是两种可以附加到 `FrameBuffer Object`（FBO）上的图像数据存储对象。它们有不同的用途和特性，适合于不同的渲染场景。
@@ -79,10 +80,12 @@ FrameBuffer::FrameBuffer()
 FrameBuffer::~FrameBuffer()
 {
     glDeleteFramebuffers(1, &m_fbo);
+    GLStateCache::getInstance().OnFramebufferDeleted(m_fbo);
 
     for (auto texture : m_textures)
     {
         glDeleteTextures(1, &texture);
+        GLStateCache::getInstance().OnTextureDeleted(texture);
     }
 
     for (auto renderBuffer : m_renderBuffers)
@@ -120,7 +123,7 @@ void FrameBuffer::Bind() const
      *  解绑 FBO：在完成离屏渲染后，通常需要将 FBO 解绑（通过 glBindFramebuffer(GL_FRAMEBUFFER, 0)），以恢复到默认的帧缓冲区。这也是一个好习惯，以确保不会意外地继续向 FBO 渲染。
      *  影响渲染状态：绑定 FBO 可能会改变视口和其他 OpenGL 状态，特别是在切换回默认帧缓冲区时，应注意重置这些状态。
     */
-    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    GLStateCache::getInstance().BindFramebuffer(m_fbo);
 }
 
 void FrameBuffer::Unbind()
@@ -128,7 +131,7 @@ void FrameBuffer::Unbind()
     /*
      * 恢复到默认的帧缓冲区
     */
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::getInstance().BindFramebuffer(0);
 }
 
 /*
@@ -139,7 +142,7 @@ void FrameBuffer::AttachTexture(GLenum attachment, GLenum internalFormat, GLenum
 {
     GLuint texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, texture);
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -348,6 +351,5 @@ GLuint FrameBuffer::GetRenderBufferID(int idx) const
 void FrameBuffer::BindTexture(int idx, int textureIdx)
 {
     GLuint texture_id = GetTextrueID(idx);
-    glActiveTexture(GL_TEXTURE0 + textureIdx);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    GLStateCache::getInstance().BindTextureUnit(static_cast<GLuint>(textureIdx), GL_TEXTURE_2D, texture_id);
 }
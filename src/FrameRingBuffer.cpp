@@ -0,0 +1,243 @@
+#include "FrameRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+// 等待 fence 时每次最多等待的时间（纳秒），超时后继续等待，直到 fence 被触发或出错
+constexpr GLuint64 FENCE_WAIT_TIMEOUT = 1000000000;
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+} // namespace
+
+FrameRingBuffer::FrameRingBuffer()
+    : m_buffer(0), m_persistent(false), m_mapped(nullptr), m_region_size(0), m_region_num(0), m_region_index(0),
+      m_head(0), m_uniform_alignment(256), m_stall_num(0), m_overflow_reported(false)
+{
+}
+
+FrameRingBuffer::~FrameRingBuffer()
+{
+    for (GLsync &fence : m_fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (m_buffer != 0)
+    {
+        if (m_mapped)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            m_mapped = nullptr;
+        }
+
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+}
+
+bool FrameRingBuffer::Init(size_t regionSize, uint32_t regionNum)
+{
+    if (m_buffer != 0)
+        return true;
+
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_uniform_alignment);
+    m_uniform_alignment = std::max(m_uniform_alignment, 1);
+
+    // 每个区域的起点也满足 uniform block 的对齐要求
+    m_region_num = std::max(regionNum, 1u);
+    m_region_size = AlignUp(std::max<size_t>(regionSize, 1), static_cast<size_t>(m_uniform_alignment));
+    const GLsizeiptr total_size = static_cast<GLsizeiptr>(m_region_size * m_region_num);
+
+    glGenBuffers(1, &m_buffer);
+    if (m_buffer == 0)
+    {
+        std::cerr << "FrameRingBuffer init failed!" << std::endl;
+        return false;
+    }
+
+    // 只用于创建和映射，不影响 GL_ARRAY_BUFFER / GL_UNIFORM_BUFFER 上的绑定
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+
+    /*
+     * glBufferStorage 创建大小不可变的存储，带 GL_MAP_PERSISTENT_BIT 时映射可以一直保留，
+     * 映射期间缓冲区仍然可以被绘制命令读取；GL_MAP_COHERENT_BIT 使CPU的写入不需要 glFlushMappedBufferRange 就对GPU可见。
+    */
+    if (GLAD_GL_VERSION_4_4 && glBufferStorage)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, total_size, nullptr, flags);
+        m_mapped = static_cast<uint8_t *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total_size, flags));
+        m_persistent = m_mapped != nullptr;
+    }
+
+    if (!m_persistent)
+    {
+        // 不可变存储无法重新分配，持久映射失败时重新创建一个普通的缓冲区
+        if (GLAD_GL_VERSION_4_4 && glBufferStorage)
+        {
+            glDeleteBuffers(1, &m_buffer);
+            glGenBuffers(1, &m_buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        }
+        glBufferData(GL_COPY_WRITE_BUFFER, total_size, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    m_fences.assign(m_region_num, nullptr);
+    m_region_index = 0;
+    m_head = 0;
+
+    return true;
+}
+
+void FrameRingBuffer::BeginFrame()
+{
+    if (m_buffer == 0)
+        return;
+
+    m_head = 0;
+
+    GLsync &fence = m_fences[m_region_index];
+    if (!fence)
+        return;
+
+    /*
+     * 先不等待地查询一次，区域足够多时 GPU 早已读完，不会阻塞。
+     * 需要等待时带上 GL_SYNC_FLUSH_COMMANDS_BIT，确保 fence 之前的命令已经提交给GPU，否则可能永远等不到。
+    */
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        m_stall_num++;
+        do
+        {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    if (result == GL_WAIT_FAILED)
+        std::cerr << "FrameRingBuffer: wait for fence failed!" << std::endl;
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void FrameRingBuffer::EndFrame()
+{
+    if (m_buffer == 0)
+        return;
+
+    GLsync &fence = m_fences[m_region_index];
+    if (fence)
+        glDeleteSync(fence);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_region_index = (m_region_index + 1) % m_region_num;
+    m_head = 0;
+}
+
+FrameRingBuffer::Allocation FrameRingBuffer::Allocate(size_t size, size_t alignment)
+{
+    Allocation allocation = {nullptr, 0, 0};
+    if (m_buffer == 0 || size == 0)
+        return allocation;
+
+    const size_t offset = AlignUp(m_head, alignment);
+    if (offset + size > m_region_size)
+    {
+        if (!m_overflow_reported)
+        {
+            std::cerr << "FrameRingBuffer: region of " << m_region_size << " bytes is full, allocation of " << size
+                      << " bytes failed!" << std::endl;
+            m_overflow_reported = true;
+        }
+        return allocation;
+    }
+
+    m_head = offset + size;
+
+    allocation.offset = static_cast<GLintptr>(m_region_index * m_region_size + offset);
+    allocation.size = static_cast<GLsizeiptr>(size);
+
+    if (m_persistent)
+    {
+        allocation.data = m_mapped + allocation.offset;
+        return allocation;
+    }
+
+    /*
+     * GL_MAP_UNSYNCHRONIZED_BIT：驱动不检查 GPU 是否仍在使用这段数据，映射不会阻塞，由区域的 fence 保证安全。
+     * GL_MAP_INVALIDATE_RANGE_BIT：不需要保留这段范围原来的内容，驱动不需要把旧数据复制回来。
+    */
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    allocation.data = glMapBufferRange(GL_COPY_WRITE_BUFFER, allocation.offset, allocation.size,
+                                       GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return allocation;
+}
+
+void FrameRingBuffer::Commit(const Allocation &allocation)
+{
+    // 持久映射的缓冲区是 coherent 的，写入后不需要任何操作
+    if (m_persistent || !allocation.data)
+        return;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+bool FrameRingBuffer::UploadUniformBlock(GLuint binding, const void *data, size_t size)
+{
+    const Allocation allocation = Allocate(size, static_cast<size_t>(m_uniform_alignment));
+    if (!allocation.data)
+        return false;
+
+    std::memcpy(allocation.data, data, size);
+    Commit(allocation);
+
+    // 只把本帧写入的范围绑定到绑定点，着色器读取的是这一帧的数据
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_buffer, allocation.offset, allocation.size);
+    return true;
+}
+
+GLuint FrameRingBuffer::GetBufferID() const
+{
+    return m_buffer;
+}
+
+bool FrameRingBuffer::IsPersistent() const
+{
+    return m_persistent;
+}
+
+size_t FrameRingBuffer::GetUniformAlignment() const
+{
+    return static_cast<size_t>(m_uniform_alignment);
+}
+
+size_t FrameRingBuffer::GetRegionSize() const
+{
+    return m_region_size;
+}
+
+size_t FrameRingBuffer::GetUsedSize() const
+{
+    return m_head;
+}
+
+size_t FrameRingBuffer::GetStallNum() const
+{
+    return m_stall_num;
+}
@@ -0,0 +1,185 @@
+#include "FrustumCuller.h"
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FRUSTUM_CULLER_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+constexpr size_t SIMD_WIDTH = 4;
+} // namespace
+
+FrustumCuller::FrustumCuller() : m_bounds_num(0), m_visible_num(0), m_culled_num(0)
+{
+}
+
+FrustumCuller::~FrustumCuller()
+{
+}
+
+void FrustumCuller::Begin()
+{
+    m_center_x.clear();
+    m_center_y.clear();
+    m_center_z.clear();
+    m_extent_x.clear();
+    m_extent_y.clear();
+    m_extent_z.clear();
+    m_bounds_num = 0;
+}
+
+size_t FrustumCuller::Push(const glm::vec3 &center, const glm::vec3 &extent)
+{
+    m_center_x.push_back(center.x);
+    m_center_y.push_back(center.y);
+    m_center_z.push_back(center.z);
+    m_extent_x.push_back(extent.x);
+    m_extent_y.push_back(extent.y);
+    m_extent_z.push_back(extent.z);
+    return m_bounds_num++;
+}
+
+size_t FrustumCuller::Add(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, const glm::mat4 &model)
+{
+    /*
+     * 变换后的AABB：中心直接变换，半长为模型矩阵3x3部分各元素取绝对值后乘以原半长（Arvo 方法），
+     * 结果包含旋转后的原包围盒。
+    */
+    const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    const glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+
+    const glm::vec3 world_center = glm::vec3(model * glm::vec4(center, 1.0f));
+
+    const glm::mat3 rotation(model);
+    const glm::mat3 abs_rotation(glm::abs(rotation[0]), glm::abs(rotation[1]), glm::abs(rotation[2]));
+    const glm::vec3 world_extent = abs_rotation * extent;
+
+    return Push(world_center, world_extent);
+}
+
+size_t FrustumCuller::Add(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    return Push((boundsMin + boundsMax) * 0.5f, (boundsMax - boundsMin) * 0.5f);
+}
+
+size_t FrustumCuller::AddUnbounded()
+{
+    return Push(glm::vec3(0.0f), glm::vec3(UNBOUNDED_EXTENT));
+}
+
+void FrustumCuller::CullScalar(const glm::vec4 planes[6], size_t begin, size_t end)
+{
+    for (size_t idx = begin; idx < end; idx++)
+    {
+        bool visible = true;
+        for (int plane_idx = 0; plane_idx < 6 && visible; plane_idx++)
+        {
+            const glm::vec4 &plane = planes[plane_idx];
+
+            // 中心到平面的有向距离加上包围盒在平面法线方向上的投影半径，小于0时完全位于平面外侧
+            const float distance = plane.x * m_center_x[idx] + plane.y * m_center_y[idx] + plane.z * m_center_z[idx] +
+                                   plane.w;
+            const float radius = std::fabs(plane.x) * m_extent_x[idx] + std::fabs(plane.y) * m_extent_y[idx] +
+                                 std::fabs(plane.z) * m_extent_z[idx];
+            visible = distance + radius >= 0.0f;
+        }
+        m_visible[idx] = visible ? 1 : 0;
+    }
+}
+
+#ifdef FRUSTUM_CULLER_SSE
+void FrustumCuller::CullSimd(const glm::vec4 planes[6], size_t end)
+{
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+    __m128 abs_x[6], abs_y[6], abs_z[6];
+    for (int plane_idx = 0; plane_idx < 6; plane_idx++)
+    {
+        const glm::vec4 &plane = planes[plane_idx];
+        plane_x[plane_idx] = _mm_set1_ps(plane.x);
+        plane_y[plane_idx] = _mm_set1_ps(plane.y);
+        plane_z[plane_idx] = _mm_set1_ps(plane.z);
+        plane_w[plane_idx] = _mm_set1_ps(plane.w);
+        abs_x[plane_idx] = _mm_set1_ps(std::fabs(plane.x));
+        abs_y[plane_idx] = _mm_set1_ps(std::fabs(plane.y));
+        abs_z[plane_idx] = _mm_set1_ps(std::fabs(plane.z));
+    }
+
+    for (size_t idx = 0; idx < end; idx += SIMD_WIDTH)
+    {
+        const __m128 center_x = _mm_loadu_ps(&m_center_x[idx]);
+        const __m128 center_y = _mm_loadu_ps(&m_center_y[idx]);
+        const __m128 center_z = _mm_loadu_ps(&m_center_z[idx]);
+        const __m128 extent_x = _mm_loadu_ps(&m_extent_x[idx]);
+        const __m128 extent_y = _mm_loadu_ps(&m_extent_y[idx]);
+        const __m128 extent_z = _mm_loadu_ps(&m_extent_z[idx]);
+
+        // 4个包围盒同时与同一个平面测试，结果按位与
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (int plane_idx = 0; plane_idx < 6; plane_idx++)
+        {
+            __m128 distance = _mm_mul_ps(plane_x[plane_idx], center_x);
+            distance = _mm_add_ps(distance, _mm_mul_ps(plane_y[plane_idx], center_y));
+            distance = _mm_add_ps(distance, _mm_mul_ps(plane_z[plane_idx], center_z));
+            distance = _mm_add_ps(distance, plane_w[plane_idx]);
+
+            __m128 radius = _mm_mul_ps(abs_x[plane_idx], extent_x);
+            radius = _mm_add_ps(radius, _mm_mul_ps(abs_y[plane_idx], extent_y));
+            radius = _mm_add_ps(radius, _mm_mul_ps(abs_z[plane_idx], extent_z));
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (size_t lane = 0; lane < SIMD_WIDTH; lane++)
+        {
+            m_visible[idx + lane] = (mask >> lane) & 1;
+        }
+    }
+}
+#else
+void FrustumCuller::CullSimd(const glm::vec4 planes[6], size_t end)
+{
+    CullScalar(planes, 0, end);
+}
+#endif
+
+void FrustumCuller::Cull(const glm::vec4 planes[6])
+{
+    // 补齐到4的倍数，补齐的元素只参与计算
+    const size_t padded_num = (m_bounds_num + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    m_center_x.resize(padded_num, 0.0f);
+    m_center_y.resize(padded_num, 0.0f);
+    m_center_z.resize(padded_num, 0.0f);
+    m_extent_x.resize(padded_num, 0.0f);
+    m_extent_y.resize(padded_num, 0.0f);
+    m_extent_z.resize(padded_num, 0.0f);
+    m_visible.resize(padded_num);
+
+    CullSimd(planes, padded_num);
+
+    m_visible_num = 0;
+    for (size_t idx = 0; idx < m_bounds_num; idx++)
+    {
+        m_visible_num += m_visible[idx];
+    }
+    m_culled_num = m_bounds_num - m_visible_num;
+}
+
+bool FrustumCuller::IsVisible(size_t idx) const
+{
+    return idx < m_bounds_num && idx < m_visible.size() && m_visible[idx] != 0;
+}
+
+size_t FrustumCuller::GetVisibleNum() const
+{
+    return m_visible_num;
+}
+
+size_t FrustumCuller::GetCulledNum() const
+{
+    return m_culled_num;
+}
@@ -0,0 +1,311 @@
+#include "GLStateCache.h"
+
+namespace
+{
+constexpr GLenum UNKNOWN_ENUM = ~0u;
+} // namespace
+
+GLStateCache::GLStateCache() : m_issued_num(0), m_skipped_num(0)
+{
+    Invalidate();
+}
+
+GLStateCache::~GLStateCache()
+{
+}
+
+GLStateCache &GLStateCache::getInstance()
+{
+    static GLStateCache instance; // Guaranteed to be destroyed.
+                                  // Instantiated on first use.
+    return instance;
+}
+
+void GLStateCache::Invalidate()
+{
+    m_program = UNKNOWN_NAME;
+    m_vertex_array = UNKNOWN_NAME;
+    m_framebuffer = UNKNOWN_NAME;
+
+    m_active_texture_unit = UNKNOWN_NAME;
+    for (GLuint unit = 0; unit < MAX_TEXTURE_UNIT_NUM; unit++)
+    {
+        for (int slot = 0; slot < TEXTURE_SLOT_NUM; slot++)
+        {
+            m_textures[unit][slot] = UNKNOWN_NAME;
+        }
+    }
+
+    for (int slot = 0; slot < CAPABILITY_NUM; slot++)
+    {
+        m_capabilities[slot] = -1;
+    }
+
+    m_depth_mask = -1;
+    m_depth_func = UNKNOWN_ENUM;
+    m_stencil_mask = UNKNOWN_NAME;
+    m_stencil_func = UNKNOWN_ENUM;
+    m_stencil_ref = 0;
+    m_stencil_func_mask = 0;
+    m_stencil_fail_op = m_stencil_depth_fail_op = m_stencil_pass_op = UNKNOWN_ENUM;
+    m_blend_src = m_blend_dst = UNKNOWN_ENUM;
+    m_cull_face = UNKNOWN_ENUM;
+}
+
+int GLStateCache::GetTextureSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D:
+        return TEXTURE_SLOT_2D;
+    case GL_TEXTURE_CUBE_MAP:
+        return TEXTURE_SLOT_CUBE_MAP;
+    case GL_TEXTURE_BUFFER:
+        return TEXTURE_SLOT_BUFFER;
+    default:
+        return -1;
+    }
+}
+
+int GLStateCache::GetCapabilitySlot(GLenum capability)
+{
+    switch (capability)
+    {
+    case GL_DEPTH_TEST:
+        return CAPABILITY_DEPTH_TEST;
+    case GL_STENCIL_TEST:
+        return CAPABILITY_STENCIL_TEST;
+    case GL_BLEND:
+        return CAPABILITY_BLEND;
+    case GL_CULL_FACE:
+        return CAPABILITY_CULL_FACE;
+    default:
+        return -1;
+    }
+}
+
+bool GLStateCache::Record(bool changed)
+{
+    if (changed)
+        m_issued_num++;
+    else
+        m_skipped_num++;
+    return changed;
+}
+
+void GLStateCache::UseProgram(GLuint program)
+{
+    if (!Record(m_program != program))
+        return;
+
+    m_program = program;
+    glUseProgram(program);
+}
+
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+    if (!Record(m_vertex_array != vertexArray))
+        return;
+
+    m_vertex_array = vertexArray;
+    glBindVertexArray(vertexArray);
+}
+
+void GLStateCache::BindFramebuffer(GLuint framebuffer)
+{
+    if (!Record(m_framebuffer != framebuffer))
+        return;
+
+    m_framebuffer = framebuffer;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void GLStateCache::ActiveTexture(GLuint unit)
+{
+    if (!Record(m_active_texture_unit != unit))
+        return;
+
+    m_active_texture_unit = unit;
+    glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GLStateCache::BindTexture(GLenum target, GLuint texture)
+{
+    const int slot = GetTextureSlot(target);
+    if (slot < 0 || m_active_texture_unit >= MAX_TEXTURE_UNIT_NUM)
+    {
+        // 不记录的纹理类型或纹理单元，同一纹理单元上该类型的记录不受影响
+        Record(true);
+        glBindTexture(target, texture);
+        return;
+    }
+
+    GLuint &bound = m_textures[m_active_texture_unit][slot];
+    if (!Record(bound != texture))
+        return;
+
+    bound = texture;
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::BindTextureUnit(GLuint unit, GLenum target, GLuint texture)
+{
+    const int slot = GetTextureSlot(target);
+    if (slot >= 0 && unit < MAX_TEXTURE_UNIT_NUM && m_textures[unit][slot] == texture)
+    {
+        Record(false);
+        return;
+    }
+
+    ActiveTexture(unit);
+    BindTexture(target, texture);
+}
+
+void GLStateCache::Enable(GLenum capability)
+{
+    const int slot = GetCapabilitySlot(capability);
+    if (slot >= 0)
+    {
+        if (!Record(m_capabilities[slot] != 1))
+            return;
+        m_capabilities[slot] = 1;
+    }
+    else
+    {
+        Record(true);
+    }
+
+    glEnable(capability);
+}
+
+void GLStateCache::Disable(GLenum capability)
+{
+    const int slot = GetCapabilitySlot(capability);
+    if (slot >= 0)
+    {
+        if (!Record(m_capabilities[slot] != 0))
+            return;
+        m_capabilities[slot] = 0;
+    }
+    else
+    {
+        Record(true);
+    }
+
+    glDisable(capability);
+}
+
+void GLStateCache::DepthMask(GLboolean flag)
+{
+    if (!Record(m_depth_mask != static_cast<GLint>(flag)))
+        return;
+
+    m_depth_mask = flag;
+    glDepthMask(flag);
+}
+
+void GLStateCache::DepthFunc(GLenum func)
+{
+    if (!Record(m_depth_func != func))
+        return;
+
+    m_depth_func = func;
+    glDepthFunc(func);
+}
+
+void GLStateCache::StencilMask(GLuint mask)
+{
+    if (!Record(m_stencil_mask != mask))
+        return;
+
+    m_stencil_mask = mask;
+    glStencilMask(mask);
+}
+
+void GLStateCache::StencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+    if (!Record(m_stencil_func != func || m_stencil_ref != ref || m_stencil_func_mask != mask))
+        return;
+
+    m_stencil_func = func;
+    m_stencil_ref = ref;
+    m_stencil_func_mask = mask;
+    glStencilFunc(func, ref, mask);
+}
+
+void GLStateCache::StencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass)
+{
+    if (!Record(m_stencil_fail_op != stencilFail || m_stencil_depth_fail_op != depthFail ||
+                m_stencil_pass_op != depthPass))
+        return;
+
+    m_stencil_fail_op = stencilFail;
+    m_stencil_depth_fail_op = depthFail;
+    m_stencil_pass_op = depthPass;
+    glStencilOp(stencilFail, depthFail, depthPass);
+}
+
+void GLStateCache::BlendFunc(GLenum src, GLenum dst)
+{
+    if (!Record(m_blend_src != src || m_blend_dst != dst))
+        return;
+
+    m_blend_src = src;
+    m_blend_dst = dst;
+    glBlendFunc(src, dst);
+}
+
+void GLStateCache::CullFace(GLenum mode)
+{
+    if (!Record(m_cull_face != mode))
+        return;
+
+    m_cull_face = mode;
+    glCullFace(mode);
+}
+
+void GLStateCache::OnProgramDeleted(GLuint program)
+{
+    if (m_program == program)
+        m_program = UNKNOWN_NAME;
+}
+
+void GLStateCache::OnVertexArrayDeleted(GLuint vertexArray)
+{
+    if (m_vertex_array == vertexArray)
+        m_vertex_array = UNKNOWN_NAME;
+}
+
+void GLStateCache::OnFramebufferDeleted(GLuint framebuffer)
+{
+    if (m_framebuffer == framebuffer)
+        m_framebuffer = UNKNOWN_NAME;
+}
+
+void GLStateCache::OnTextureDeleted(GLuint texture)
+{
+    for (GLuint unit = 0; unit < MAX_TEXTURE_UNIT_NUM; unit++)
+    {
+        for (int slot = 0; slot < TEXTURE_SLOT_NUM; slot++)
+        {
+            if (m_textures[unit][slot] == texture)
+                m_textures[unit][slot] = UNKNOWN_NAME;
+        }
+    }
+}
+
+size_t GLStateCache::GetIssuedNum() const
+{
+    return m_issued_num;
+}
+
+size_t GLStateCache::GetSkippedNum() const
+{
+    return m_skipped_num;
+}
+
+void GLStateCache::ResetCounters()
+{
+    m_issued_num = 0;
+    m_skipped_num = 0;
+}
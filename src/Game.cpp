@@ -2,6 +2,8 @@
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 #include "Game.h"
+#include "GLStateCache.h"
+#include "TextureStreamer.h"
 #include <iostream>
 #include "Util.h"
 
@@ -188,7 +190,7 @@ static void APIENTRY glfw_debug_output(GLenum source, GLenum type, unsigned int
 }
 /***********************************************************************************************************/
 
-Game::Game() : window(nullptr), scene() {};
+Game::Game() : window(nullptr), scene(), title(), stats_start_time(0.0), stats_frame_num(0) {};
 
 Game::~Game()
 {
@@ -220,6 +222,7 @@ bool Game::Init(const char *title, int width, int height)
     SetupWindowHint();
 
     window = glfwCreateWindow(width, height, title, NULL, NULL);
+    this->title = title;
     if (!window)
     {
         glfwTerminate();
@@ -270,7 +273,7 @@ bool Game::Init(const char *title, int width, int height)
     glfwGetFramebufferSize(window, &fb_width, &fb_height);
     glViewport(0, 0, fb_width, fb_height);
 
-    glEnable(GL_DEPTH_TEST); // 开启深度测试
+    GLStateCache::getInstance().Enable(GL_DEPTH_TEST); // 开启深度测试
 
     /*
      * 在 OpenGL 中，如果启用了模板测试（Stencil Test）但没有明确指定任何模板函数，OpenGL 会使用默认的模板测试设置。默认情况下，模板测试的行为如下：
@@ -291,7 +294,7 @@ bool Game::Init(const char *title, int width, int height)
      * 综合来看，如果启用了模板测试但没有指定任何模板函数，模板测试将始终通过，并且不会对模板缓冲区进行任何修改。
      * 这意味着模板测试对最终的绘制结果不会产生影响，因为它的默认行为等效于模板测试被关闭的情况。
     */
-    glEnable(GL_STENCIL_TEST); // 开启模板测试
+    GLStateCache::getInstance().Enable(GL_STENCIL_TEST); // 开启模板测试
 
     scene.Init(fb_width, fb_height);
 
@@ -423,14 +426,14 @@ void Game::SetupGLDebugContext() const
          * 启用OpenGL的调试输出功能。
          * 这允许OpenGL生成调试消息，这些消息可以帮助开发者识别错误、性能问题和其他重要信息。
         */
-        glEnable(GL_DEBUG_OUTPUT);
+        GLStateCache::getInstance().Enable(GL_DEBUG_OUTPUT);
 
         /*
          * 启用同步调试输出。
          * 当启用时，调试消息会在导致该消息的OpenGL命令执行完毕后立即生成。
          * 这对于调试非常有用，因为它可以确保调试消息与导致它的OpenGL调用直接关联。
         */
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        GLStateCache::getInstance().Enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
 
         /*
          * 设置调试消息回调函数。
@@ -461,6 +464,9 @@ void Game::Run()
 
 void Game::Draw()
 {
+    // 状态缓存的计数按帧统计
+    GLStateCache::getInstance().ResetCounters();
+
     // 清理缓冲区并设置为指定的颜色
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f); // 状态值设置，用于指定颜色值
 
@@ -483,12 +489,43 @@ void Game::Draw()
         GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT |
         GL_STENCIL_BUFFER_BIT); // 状态值应用，清理掉颜色缓冲区并设置为指定的颜色，同时也清理掉深度缓冲区、模板缓冲区
 
+    // 在预算内上传后台解码完成的纹理
+    TextureStreamer::getInstance().Update();
+
     scene.Render();
 
+    UpdateStats();
+
     // 交换缓冲区，将渲染结果显示到窗口中
     glfwSwapBuffers(window);
 }
 
+void Game::UpdateStats()
+{
+    const double now_time = glfwGetTime();
+    if (stats_frame_num == 0 && stats_start_time <= 0.0)
+        stats_start_time = now_time;
+
+    stats_frame_num++;
+
+    // 每秒刷新两次，glfwSetWindowTitle 本身有一定开销，也避免数字跳动得太快无法阅读
+    const double elapsed = now_time - stats_start_time;
+    if (elapsed < 0.5)
+        return;
+
+    // 可见/剔除数量和状态缓存的计数都是最近一帧的值
+    const GLStateCache &state_cache = GLStateCache::getInstance();
+    const std::string stats = title + " | " + std::to_string(static_cast<int>(stats_frame_num / elapsed + 0.5)) +
+                              " FPS | draws " + std::to_string(scene.GetVisibleDrawNum()) + " visible, " +
+                              std::to_string(scene.GetCulledDrawNum()) + " culled | GL state " +
+                              std::to_string(state_cache.GetIssuedNum()) + " issued, " +
+                              std::to_string(state_cache.GetSkippedNum()) + " skipped";
+    glfwSetWindowTitle(window, stats.c_str());
+
+    stats_start_time = now_time;
+    stats_frame_num = 0;
+}
+
 void Game::On_Key_W_Press()
 {
     scene.MoveCamForward();
@@ -0,0 +1,79 @@
+#include "InstanceBuffer.h"
+#include <algorithm>
+#include <iostream>
+
+InstanceData InstanceData::Make(const glm::mat4 &model, const glm::vec4 &custom)
+{
+    InstanceData instance;
+    instance.model = model;
+
+    // 将法向量从模型空间变换到世界空间中需要用到的矩阵
+    const glm::mat3 normal_matrix = glm::transpose(glm::inverse(glm::mat3(model)));
+    for (int column = 0; column < 3; column++)
+    {
+        instance.normal_matrix[column] = glm::vec4(normal_matrix[column], 0.0f);
+    }
+
+    instance.custom = custom;
+    return instance;
+}
+
+InstanceBuffer::InstanceBuffer(size_t capacity) : m_vbo(0), m_capacity(std::max<size_t>(capacity, 1)), m_instance_num(0)
+{
+    glGenBuffers(1, &m_vbo);
+    if (m_vbo == 0)
+    {
+        std::cerr << "InstanceBuffer init failed!" << std::endl;
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_capacity * sizeof(InstanceData)), nullptr,
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+    if (m_vbo != 0)
+    {
+        glDeleteBuffers(1, &m_vbo);
+        m_vbo = 0;
+    }
+}
+
+bool InstanceBuffer::Update(const InstanceData *instances, size_t instanceNum)
+{
+    if (m_vbo == 0)
+        return false;
+
+    // 容量不够时按2倍扩大，避免实例数量逐渐增加时每次都重新分配
+    if (instanceNum > m_capacity)
+        m_capacity = std::max(instanceNum, m_capacity * 2);
+
+    // 先废弃旧的存储（orphaning），上一帧仍在使用旧数据的绘制不会阻塞这次上传
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_capacity * sizeof(InstanceData)), nullptr,
+                 GL_DYNAMIC_DRAW);
+    if (instanceNum > 0)
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(instanceNum * sizeof(InstanceData)), instances);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_instance_num = instanceNum;
+    return true;
+}
+
+GLuint InstanceBuffer::GetBufferID() const
+{
+    return m_vbo;
+}
+
+size_t InstanceBuffer::GetInstanceNum() const
+{
+    return m_instance_num;
+}
+
+size_t InstanceBuffer::GetCapacity() const
+{
+    return m_capacity;
+}
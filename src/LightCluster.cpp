@@ -0,0 +1,234 @@
+#include "LightCluster.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// 灯光下标保存在16位整数中
+constexpr size_t MAX_CLUSTER_LIGHT_NUM = 65536;
+} // namespace
+
+LightCluster::LightCluster()
+    : m_proj_x(0.0f), m_proj_y(0.0f), m_near(0.0f), m_far(0.0f), m_slice_depths(), m_x_bounds(), m_y_bounds(),
+      m_clusters(CLUSTER_NUM, ClusterRange{0, 0}), m_slices(GRID_Z), m_dropped_num(0)
+{
+}
+
+LightCluster::~LightCluster()
+{
+}
+
+void LightCluster::SetupGrid(const glm::mat4 &projection, float near, float far)
+{
+    const float proj_x = projection[0][0];
+    const float proj_y = projection[1][1];
+    if (proj_x == m_proj_x && proj_y == m_proj_y && near == m_near && far == m_far)
+        return;
+
+    m_proj_x = proj_x;
+    m_proj_y = proj_y;
+    m_near = near;
+    m_far = far;
+
+    for (uint32_t z = 0; z <= GRID_Z; z++)
+    {
+        m_slice_depths[z] = near * std::pow(far / near, static_cast<float>(z) / GRID_Z);
+    }
+
+    /*
+     * 对称透视投影下，观察空间深度为 d 的点 x_view = x_ndc * d / projection[0][0]，y 同理。
+     * 簇的AABB取它在近、远两个深度上的四个角点的范围。
+    */
+    auto bounds = [](uint32_t idx, uint32_t num, float proj, float depth_near, float depth_far) {
+        const float ndc_min = -1.0f + 2.0f * idx / num;
+        const float ndc_max = -1.0f + 2.0f * (idx + 1) / num;
+        return glm::vec2(std::min(ndc_min * depth_near, ndc_min * depth_far) / proj,
+                         std::max(ndc_max * depth_near, ndc_max * depth_far) / proj);
+    };
+
+    for (uint32_t z = 0; z < GRID_Z; z++)
+    {
+        const float depth_near = m_slice_depths[z];
+        const float depth_far = m_slice_depths[z + 1];
+
+        for (uint32_t x = 0; x < GRID_X; x++)
+        {
+            m_x_bounds[z][x] = bounds(x, GRID_X, proj_x, depth_near, depth_far);
+        }
+
+        for (uint32_t y = 0; y < GRID_Y; y++)
+        {
+            m_y_bounds[z][y] = bounds(y, GRID_Y, proj_y, depth_near, depth_far);
+        }
+    }
+}
+
+bool LightCluster::Intersects(uint32_t x, uint32_t y, uint32_t z, const ClusterLight &light) const
+{
+    // 观察空间中相机看向 -z
+    const glm::vec3 box_min(m_x_bounds[z][x].x, m_y_bounds[z][y].x, -m_slice_depths[z + 1]);
+    const glm::vec3 box_max(m_x_bounds[z][x].y, m_y_bounds[z][y].y, -m_slice_depths[z]);
+
+    const glm::vec3 closest = glm::clamp(light.view_pos, box_min, box_max);
+    const glm::vec3 offset = closest - light.view_pos;
+
+    return glm::dot(offset, offset) <= light.range * light.range;
+}
+
+void LightCluster::CullSlice(uint32_t z, const std::vector<ClusterLight> &lights)
+{
+    SliceResult &slice = m_slices[z];
+    slice.pairs.clear();
+
+    const float depth_near = m_slice_depths[z];
+    const float depth_far = m_slice_depths[z + 1];
+    const size_t light_num = std::min(lights.size(), MAX_CLUSTER_LIGHT_NUM);
+
+    for (size_t idx = 0; idx < light_num; idx++)
+    {
+        const ClusterLight &light = lights[idx];
+        const float depth = -light.view_pos.z;
+        if (depth + light.range < depth_near || depth - light.range > depth_far)
+            continue;
+
+        /*
+         * 簇AABB的 x 范围只与列有关、y 范围只与行有关，先按轴筛掉与包围球的AABB不相交的行和列，
+         * 剩下的簇再做精确的球与AABB相交测试，结果与逐簇测试相同。
+        */
+        bool x_overlaps[GRID_X];
+        for (uint32_t x = 0; x < GRID_X; x++)
+        {
+            const glm::vec2 &bounds = m_x_bounds[z][x];
+            x_overlaps[x] = bounds.y >= light.view_pos.x - light.range && bounds.x <= light.view_pos.x + light.range;
+        }
+
+        for (uint32_t y = 0; y < GRID_Y; y++)
+        {
+            const glm::vec2 &bounds = m_y_bounds[z][y];
+            if (bounds.y < light.view_pos.y - light.range || bounds.x > light.view_pos.y + light.range)
+                continue;
+
+            for (uint32_t x = 0; x < GRID_X; x++)
+            {
+                if (x_overlaps[x] && Intersects(x, y, z, light))
+                    slice.pairs.push_back(((y * GRID_X + x) << 16) | static_cast<uint32_t>(idx));
+            }
+        }
+    }
+
+    // 按簇计数排序，同一个簇内保持灯光下标的升序
+    for (ClusterRange &cluster : slice.clusters)
+    {
+        cluster = ClusterRange{0, 0};
+    }
+    for (uint32_t pair : slice.pairs)
+    {
+        slice.clusters[pair >> 16].count++;
+    }
+
+    uint32_t offset = 0;
+    for (ClusterRange &cluster : slice.clusters)
+    {
+        cluster.offset = offset;
+        offset += cluster.count;
+    }
+
+    slice.light_indices.resize(slice.pairs.size());
+    uint32_t cursors[GRID_X * GRID_Y];
+    for (uint32_t idx = 0; idx < GRID_X * GRID_Y; idx++)
+    {
+        cursors[idx] = slice.clusters[idx].offset;
+    }
+    for (uint32_t pair : slice.pairs)
+    {
+        slice.light_indices[cursors[pair >> 16]++] = static_cast<uint16_t>(pair & 0xFFFF);
+    }
+}
+
+void LightCluster::Build(const glm::mat4 &projection, float near, float far, const std::vector<ClusterLight> &lights)
+{
+    SetupGrid(projection, near, far);
+
+    ThreadPool::getInstance().ParallelFor(GRID_Z, [this, &lights](size_t z) {
+        CullSlice(static_cast<uint32_t>(z), lights);
+    });
+
+    // 按层拼接成紧凑的索引表，超出容量的部分丢弃
+    m_light_indices.clear();
+    m_dropped_num = 0;
+    for (uint32_t z = 0; z < GRID_Z; z++)
+    {
+        const SliceResult &slice = m_slices[z];
+        for (uint32_t idx = 0; idx < GRID_X * GRID_Y; idx++)
+        {
+            const ClusterRange &range = slice.clusters[idx];
+            const size_t count = std::min<size_t>(range.count, MAX_LIGHT_INDEX_NUM - m_light_indices.size());
+            m_dropped_num += range.count - count;
+
+            const auto first = slice.light_indices.begin() + range.offset;
+            m_clusters[z * GRID_X * GRID_Y + idx] =
+                ClusterRange{static_cast<uint32_t>(m_light_indices.size()), static_cast<uint32_t>(count)};
+            m_light_indices.insert(m_light_indices.end(), first, first + count);
+        }
+    }
+}
+
+void LightCluster::BuildReference(const glm::mat4 &projection, float near, float far,
+                                  const std::vector<ClusterLight> &lights)
+{
+    SetupGrid(projection, near, far);
+
+    m_light_indices.clear();
+    m_dropped_num = 0;
+
+    const size_t light_num = std::min(lights.size(), MAX_CLUSTER_LIGHT_NUM);
+    for (uint32_t z = 0; z < GRID_Z; z++)
+    {
+        for (uint32_t y = 0; y < GRID_Y; y++)
+        {
+            for (uint32_t x = 0; x < GRID_X; x++)
+            {
+                ClusterRange &range = m_clusters[(z * GRID_Y + y) * GRID_X + x];
+                range = ClusterRange{static_cast<uint32_t>(m_light_indices.size()), 0};
+
+                for (size_t idx = 0; idx < light_num; idx++)
+                {
+                    if (!Intersects(x, y, z, lights[idx]))
+                        continue;
+
+                    if (m_light_indices.size() >= MAX_LIGHT_INDEX_NUM)
+                    {
+                        m_dropped_num++;
+                        continue;
+                    }
+
+                    m_light_indices.push_back(static_cast<uint16_t>(idx));
+                    range.count++;
+                }
+            }
+        }
+    }
+}
+
+const std::vector<ClusterRange> &LightCluster::GetClusters() const
+{
+    return m_clusters;
+}
+
+const std::vector<uint16_t> &LightCluster::GetLightIndices() const
+{
+    return m_light_indices;
+}
+
+size_t LightCluster::GetDroppedNum() const
+{
+    return m_dropped_num;
+}
+
+glm::vec2 LightCluster::GetDepthSliceParams() const
+{
+    // 第 z 层满足 near * (far / near)^(z / GRID_Z) <= d，即 z = log(d / near) * GRID_Z / log(far / near)
+    const float log_ratio = std::log(m_far / m_near);
+    return glm::vec2(GRID_Z / log_ratio, -static_cast<float>(GRID_Z) * std::log(m_near) / log_ratio);
+}
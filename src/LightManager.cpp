@@ -0,0 +1,223 @@
+#include "LightManager.h"
+#include "Camera.h"
+#include "SharedTextureUnit.h"
+#include "UniformBlockBinding.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+LightManager::LightManager()
+    : m_ring(nullptr), m_data(), m_cluster(), m_cluster_grid(nullptr), m_cluster_light_indices(nullptr),
+      m_overflow_reported(false)
+{
+}
+
+LightManager::~LightManager()
+{
+    Clear();
+
+    delete m_cluster_grid;
+    m_cluster_grid = nullptr;
+
+    delete m_cluster_light_indices;
+    m_cluster_light_indices = nullptr;
+}
+
+bool LightManager::Init(FrameRingBuffer *ring)
+{
+    if (m_ring)
+        return true;
+
+    if (!ring || ring->GetBufferID() == 0)
+    {
+        std::cerr << "LightManager init failed!" << std::endl;
+        return false;
+    }
+
+    m_cluster_grid = new TextureBuffer(GL_RG32UI, LightCluster::CLUSTER_NUM * sizeof(ClusterRange));
+    m_cluster_light_indices = new TextureBuffer(GL_R16UI, LightCluster::MAX_LIGHT_INDEX_NUM * sizeof(uint16_t));
+    if (!m_cluster_grid->IsValidTexture() || !m_cluster_light_indices->IsValidTexture())
+    {
+        std::cerr << "LightManager init cluster buffers failed!" << std::endl;
+        delete m_cluster_grid;
+        m_cluster_grid = nullptr;
+        delete m_cluster_light_indices;
+        m_cluster_light_indices = nullptr;
+        return false;
+    }
+
+    m_ring = ring;
+    return true;
+}
+
+bool LightManager::AddLight(BaseLight *light)
+{
+    if (!light)
+        return false;
+
+    if (light->GetType() == LightType::Direction)
+    {
+        if (m_direction_lights.size() >= LightBlockData::MAX_DIRECTION_LIGHT_NUM)
+        {
+            std::cerr << "LightManager: too many direction lights!" << std::endl;
+            return false;
+        }
+        m_direction_lights.push_back(static_cast<DirectionLight *>(light));
+        return true;
+    }
+
+    if (m_local_lights.size() >= LightBlockData::MAX_LOCAL_LIGHT_NUM)
+    {
+        std::cerr << "LightManager: too many point/spot lights!" << std::endl;
+        return false;
+    }
+
+    // SpotLight 继承自 PointLight
+    m_local_lights.push_back(static_cast<PointLight *>(light));
+    return true;
+}
+
+void LightManager::RemoveLight(BaseLight *light)
+{
+    auto direction_iter = std::find(m_direction_lights.begin(), m_direction_lights.end(), light);
+    if (direction_iter != m_direction_lights.end())
+    {
+        m_direction_lights.erase(direction_iter);
+        delete light;
+        return;
+    }
+
+    auto local_iter = std::find(m_local_lights.begin(), m_local_lights.end(), light);
+    if (local_iter != m_local_lights.end())
+    {
+        m_local_lights.erase(local_iter);
+        delete light;
+    }
+}
+
+void LightManager::Clear()
+{
+    for (auto light : m_direction_lights)
+        delete light;
+    m_direction_lights.clear();
+
+    for (auto light : m_local_lights)
+        delete light;
+    m_local_lights.clear();
+}
+
+void LightManager::Pack()
+{
+    m_data.light_counts = glm::ivec4(static_cast<int>(m_direction_lights.size()),
+                                     static_cast<int>(m_local_lights.size()), 0, 0);
+
+    for (size_t idx = 0; idx < m_direction_lights.size(); idx++)
+    {
+        const DirectionLight *light = m_direction_lights[idx];
+        DirectionLightData &data = m_data.direction_lights[idx];
+        data.direction = glm::vec4(light->GetDirection(), 0.0f);
+        data.ambient = glm::vec4(light->GetAmbient(), 0.0f);
+        data.diffuse = glm::vec4(light->GetDiffuse(), 0.0f);
+        data.specular = glm::vec4(light->GetSpecular(), 0.0f);
+    }
+
+    for (size_t idx = 0; idx < m_local_lights.size(); idx++)
+    {
+        const PointLight *light = m_local_lights[idx];
+        LocalLightData &data = m_data.local_lights[idx];
+
+        // 点光源没有锥形范围：cos(内切光角) = -1，cos(外切光角) = -2，任意方向上的锥形衰减都是1
+        glm::vec3 direction(0.0f, 0.0f, -1.0f);
+        float cut_off = -1.0f;
+        float outer_cut_off = -2.0f;
+        if (light->GetType() == LightType::Spot)
+        {
+            const SpotLight *spot_light = static_cast<const SpotLight *>(light);
+            direction = spot_light->GetDirection();
+            cut_off = spot_light->GetCutOff();
+            outer_cut_off = spot_light->GetOuterCutOff();
+        }
+
+        data.position = glm::vec4(light->GetPosition(), light->GetConstant());
+        data.direction = glm::vec4(direction, cut_off);
+        data.ambient = glm::vec4(light->GetAmbient(), outer_cut_off);
+        data.diffuse = glm::vec4(light->GetDiffuse(), light->GetLinear());
+        data.specular = glm::vec4(light->GetSpecular(), light->GetQuadratic());
+    }
+}
+
+void LightManager::BuildClusters(Camera &camera)
+{
+    const glm::mat4 view = camera.GetViewMatrix();
+
+    // 聚光灯同样使用以位置为中心的包围球，不考虑锥形范围
+    m_cluster_lights.resize(m_local_lights.size());
+    for (size_t idx = 0; idx < m_local_lights.size(); idx++)
+    {
+        const PointLight *light = m_local_lights[idx];
+        m_cluster_lights[idx].view_pos = glm::vec3(view * glm::vec4(light->GetPosition(), 1.0f));
+        m_cluster_lights[idx].range = light->GetRange();
+    }
+
+    const float near = static_cast<float>(camera.GetNear());
+    const float far = static_cast<float>(camera.GetFar());
+    m_cluster.Build(camera.GetProjectionMatrix(), near, far, m_cluster_lights);
+
+    if (m_cluster.GetDroppedNum() > 0 && !m_overflow_reported)
+    {
+        std::cerr << "LightManager: cluster light index list overflow, " << m_cluster.GetDroppedNum()
+                  << " light indices dropped!" << std::endl;
+        m_overflow_reported = true;
+    }
+
+    m_data.cluster_size = glm::ivec4(LightCluster::GRID_X, LightCluster::GRID_Y, LightCluster::GRID_Z, 0);
+    m_data.cluster_depth_params = glm::vec4(m_cluster.GetDepthSliceParams(), 0.0f, 0.0f);
+
+    const std::vector<ClusterRange> &clusters = m_cluster.GetClusters();
+    const std::vector<uint16_t> &light_indices = m_cluster.GetLightIndices();
+    m_cluster_grid->Update(clusters.data(), clusters.size() * sizeof(ClusterRange));
+    m_cluster_light_indices->Update(light_indices.data(), light_indices.size() * sizeof(uint16_t));
+
+    m_cluster_grid->Use(TEXTURE_UNIT_CLUSTER_GRID);
+    m_cluster_light_indices->Use(TEXTURE_UNIT_CLUSTER_LIGHT_INDICES);
+}
+
+void LightManager::Update(Camera &camera)
+{
+    if (!m_ring || !m_cluster_grid || !m_cluster_light_indices)
+        return;
+
+    Pack();
+    BuildClusters(camera);
+
+    // 只上传实际使用的部分，数组中多余的元素着色器不会读取
+    const size_t upload_size =
+        offsetof(LightBlockData, local_lights) + m_local_lights.size() * sizeof(LocalLightData);
+
+    // 绑定的范围必须覆盖整个 block，分配完整的大小，但只写入实际使用的部分
+    const FrameRingBuffer::Allocation allocation =
+        m_ring->Allocate(sizeof(LightBlockData), m_ring->GetUniformAlignment());
+    if (!allocation.data)
+        return;
+
+    std::memcpy(allocation.data, &m_data, upload_size);
+    m_ring->Commit(allocation);
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, UNIFORM_BLOCK_LIGHT, m_ring->GetBufferID(), allocation.offset,
+                      allocation.size);
+}
+
+size_t LightManager::GetDirectionLightNum() const
+{
+    return m_direction_lights.size();
+}
+
+size_t LightManager::GetLocalLightNum() const
+{
+    return m_local_lights.size();
+}
+
+const std::vector<PointLight *> &LightManager::GetLocalLights() const
+{
+    return m_local_lights;
+}
@@ -0,0 +1,84 @@
+#include "Material.h"
+
+std::atomic<uint32_t> Material::next_sort_id{1};
+
+Material::Material(Shader *shader) : m_shader(shader), m_sort_id(next_sort_id.fetch_add(1))
+{
+}
+
+Material::~Material()
+{
+}
+
+void Material::SetTexture(const std::string &name, const Texture *texture)
+{
+    for (auto &param : m_textures)
+    {
+        if (param.name == name)
+        {
+            param.texture = texture;
+            return;
+        }
+    }
+    m_textures.push_back({name, UniformId::FromString(name), texture});
+}
+
+void Material::SetFloat(const std::string &name, const GLfloat value)
+{
+    for (auto &param : m_floats)
+    {
+        if (param.name == name)
+        {
+            param.value = value;
+            return;
+        }
+    }
+    m_floats.push_back({name, UniformId::FromString(name), value});
+}
+
+void Material::SetVec3f(const std::string &name, const glm::vec3 &value)
+{
+    for (auto &param : m_vec3s)
+    {
+        if (param.name == name)
+        {
+            param.value = value;
+            return;
+        }
+    }
+    m_vec3s.push_back({name, UniformId::FromString(name), value});
+}
+
+Shader *Material::GetShader() const
+{
+    return m_shader;
+}
+
+uint32_t Material::GetSortId() const
+{
+    return m_sort_id;
+}
+
+void Material::Use() const
+{
+    if (!m_shader)
+        return;
+
+    for (size_t idx = 0; idx < m_textures.size(); idx++)
+    {
+        m_textures[idx].texture->Use(static_cast<int>(idx));
+        m_shader->SetInt(m_textures[idx].id, static_cast<GLint>(idx));
+    }
+
+    for (const auto &param : m_floats)
+    {
+        m_shader->SetFloat(param.id, param.value);
+    }
+
+    for (const auto &param : m_vec3s)
+    {
+        m_shader->SetVec3f(param.id, param.value);
+    }
+
+    m_shader->Use();
+}
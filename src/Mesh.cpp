@@ -1,17 +1,43 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
 #include <vector>
 #include "Mesh.h"
+#include "GLStateCache.h"
 
-Mesh::Mesh(Shader *shader) : shader(shader)
+Mesh::Mesh(Shader *shader)
+    : shader(shader), material(nullptr), lod_index(0), quantized(false), position_scale(1.0f), position_offset(0.0f),
+      has_bounds(false), bounds_min(0.0f), bounds_max(0.0f), instance_buffer(nullptr)
 {
 }
 
 Mesh::Mesh(const std::vector<GLfloat> &vertices, const std::vector<GLuint> &indices,
            const std::vector<VertexAttribute> &attributes, Shader *shader)
-    : shader(shader)
+    : shader(shader), material(nullptr), lod_index(0), quantized(false), position_scale(1.0f), position_offset(0.0f),
+      has_bounds(false), bounds_min(0.0f), bounds_max(0.0f), instance_buffer(nullptr)
 {
     SetupMesh(vertices, indices, attributes);
 }
 
+Mesh::Mesh(const GLfloat *vertices, size_t vertexFloatNum, const GLuint *indices, size_t indexNum,
+           const std::vector<VertexAttribute> &attributes, Shader *shader)
+    : shader(shader), material(nullptr), lod_index(0), quantized(false), position_scale(1.0f), position_offset(0.0f),
+      has_bounds(false), bounds_min(0.0f), bounds_max(0.0f), instance_buffer(nullptr)
+{
+    SetupMesh(vertices, vertexFloatNum, indices, indexNum, attributes);
+}
+
+Mesh::Mesh(const void *vertexData, size_t vertexBytes, const GLuint *indices, size_t indexNum,
+           const std::vector<VertexAttribute> &attributes, Shader *shader)
+    : shader(shader), material(nullptr), lod_index(0), quantized(false), position_scale(1.0f), position_offset(0.0f),
+      has_bounds(false), bounds_min(0.0f), bounds_max(0.0f), instance_buffer(nullptr)
+{
+    SetupMesh(vertexData, vertexBytes, indices, indexNum, attributes);
+}
+
 Mesh::~Mesh()
 {
     /*
@@ -45,18 +71,31 @@ Mesh::~Mesh()
      * 如果该顶点数组对象当前绑定，则在删除后它将自动解除绑定。
     */
     glDeleteVertexArrays(1, &vao);
+    GLStateCache::getInstance().OnVertexArrayDeleted(vao);
 }
 
 void Mesh::Draw() const
 {
-    if (vao == 0 || !shader || !shader->IsValidProgram())
+    if (shader)
+        Draw(*shader, material);
+}
+
+void Mesh::Draw(Shader &drawShader, Material *drawMaterial) const
+{
+    if (vao == 0 || !drawShader.IsValidProgram())
         return;
 
+    // uniform 在 Use() 中统一上传，所以必须在绑定材质之前设置
+    SetQuantizationUniforms(drawShader);
+
     // 准备好渲染所需要的材质
-    shader->Use();
+    if (drawMaterial)
+        drawMaterial->Use();
+    else
+        drawShader.Use();
 
     // draw mesh content
-    glBindVertexArray(vao);
+    BindVertexArray();
 
     if (index_num > 0)
     {
@@ -80,7 +119,17 @@ void Mesh::Draw() const
          *  5. 使用索引数据从绑定到GL_ARRAY_BUFFER目标的缓冲区对象或客户端内存中的顶点数组中获取顶点数据。
          *  6. 根据索引数据和图元类型，绘制指定的图元。
         */
-        glDrawElements(GL_TRIANGLES, index_num, GL_UNSIGNED_INT, 0);
+        if (lods.empty())
+        {
+            glDrawElements(GL_TRIANGLES, index_num, GL_UNSIGNED_INT, 0);
+        }
+        else
+        {
+            // 只绘制当前 LOD 对应的索引范围，偏移量以字节为单位
+            const MeshLod &lod = lods[lod_index];
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(lod.index_num), GL_UNSIGNED_INT,
+                           reinterpret_cast<const void *>(static_cast<uintptr_t>(lod.index_offset) * sizeof(GLuint)));
+        }
     }
     else
     {
@@ -103,6 +152,163 @@ void Mesh::Draw() const
     }
 }
 
+void Mesh::SetInstanceBuffer(const InstanceBuffer *buffer)
+{
+    if (vao == 0)
+        return;
+
+    instance_buffer = buffer;
+    BindVertexArray();
+
+    if (!buffer)
+    {
+        for (GLuint location = INSTANCE_ATTRIBUTE_MODEL; location <= INSTANCE_ATTRIBUTE_CUSTOM; location++)
+        {
+            glDisableVertexAttribArray(location);
+        }
+        return;
+    }
+
+    /*
+     * 逐实例属性与顶点属性一样通过 glVertexAttribPointer 设置，区别在于 glVertexAttribDivisor：
+     * 除数为0时每个顶点前进一个元素，除数为 N 时每绘制 N 个实例才前进一个元素。
+     * 矩阵属性每一列占用一个属性位置，需要分别设置。
+    */
+    glBindBuffer(GL_ARRAY_BUFFER, buffer->GetBufferID());
+
+    const GLsizei stride = sizeof(InstanceData);
+    auto set_attribute = [stride](GLuint location, GLint size, size_t offset) {
+        glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<const void *>(static_cast<uintptr_t>(offset)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    };
+
+    for (GLuint column = 0; column < 4; column++)
+    {
+        set_attribute(INSTANCE_ATTRIBUTE_MODEL + column, 4, offsetof(InstanceData, model) + column * sizeof(glm::vec4));
+    }
+    for (GLuint column = 0; column < 3; column++)
+    {
+        set_attribute(INSTANCE_ATTRIBUTE_NORMAL_MATRIX + column, 3,
+                      offsetof(InstanceData, normal_matrix) + column * sizeof(glm::vec4));
+    }
+    set_attribute(INSTANCE_ATTRIBUTE_CUSTOM, 4, offsetof(InstanceData, custom));
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::DrawInstanced(GLsizei instanceNum) const
+{
+    if (shader)
+        DrawInstanced(instanceNum, *shader, material);
+}
+
+void Mesh::DrawInstanced(GLsizei instanceNum, Shader &drawShader, Material *drawMaterial) const
+{
+    if (vao == 0 || !drawShader.IsValidProgram() || !instance_buffer || instanceNum <= 0)
+        return;
+
+    // 超出缓冲区中实例数量的部分会读取缓冲区之外的逐实例属性，只绘制已有的实例
+    if (static_cast<size_t>(instanceNum) > instance_buffer->GetInstanceNum())
+    {
+        std::cerr << "Mesh::DrawInstanced: instanceNum " << instanceNum << " exceeds the "
+                  << instance_buffer->GetInstanceNum() << " instances in the buffer" << std::endl;
+        instanceNum = static_cast<GLsizei>(instance_buffer->GetInstanceNum());
+        if (instanceNum == 0)
+            return;
+    }
+
+    SetQuantizationUniforms(drawShader);
+
+    if (drawMaterial)
+        drawMaterial->Use();
+    else
+        drawShader.Use();
+
+    BindVertexArray();
+
+    /*
+     * glDrawElementsInstanced 与 glDrawElements 相同，但把同一段索引绘制 instancecount 次，
+     * 着色器中的 gl_InstanceID 依次为 0 ~ instancecount - 1，逐实例属性每个实例读取一个元素。
+    */
+    if (index_num > 0)
+    {
+        if (lods.empty())
+        {
+            glDrawElementsInstanced(GL_TRIANGLES, index_num, GL_UNSIGNED_INT, 0, instanceNum);
+        }
+        else
+        {
+            const MeshLod &lod = lods[lod_index];
+            glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(lod.index_num), GL_UNSIGNED_INT,
+                                    reinterpret_cast<const void *>(static_cast<uintptr_t>(lod.index_offset) *
+                                                                   sizeof(GLuint)),
+                                    instanceNum);
+        }
+    }
+    else
+    {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 3, instanceNum);
+    }
+}
+
+void Mesh::SetQuantizationUniforms() const
+{
+    if (shader)
+        SetQuantizationUniforms(*shader);
+}
+
+void Mesh::SetQuantizationUniforms(Shader &drawShader) const
+{
+    if (quantized)
+    {
+        drawShader.SetVec3f("positionScale", position_scale);
+        drawShader.SetVec3f("positionOffset", position_offset);
+    }
+}
+
+void Mesh::BindVertexArray() const
+{
+    GLStateCache::getInstance().BindVertexArray(vao);
+}
+
+void Mesh::MultiDraw(const GLsizei *counts, const void *const *indexOffsets, const GLint *baseVertices,
+                     GLsizei drawNum) const
+{
+    if (vao == 0 || drawNum <= 0)
+        return;
+
+    BindVertexArray();
+
+    /*
+     * glMultiDrawElementsBaseVertex 相当于循环调用 glDrawElementsBaseVertex，但只需要一次驱动调用。
+     * 函数原型：void glMultiDrawElementsBaseVertex(GLenum mode, const GLsizei *count, GLenum type,
+     *                                            const void *const *indices, GLsizei drawcount, const GLint *basevertex);
+     *  count：每次绘制的索引数量。
+     *  indices：每次绘制的索引在索引缓冲区中的字节偏移量。
+     *  basevertex：每次绘制时加到索引上的值，用于定位合并后缓冲区中各子网格的第一个顶点。
+    */
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts, GL_UNSIGNED_INT, indexOffsets, drawNum, baseVertices);
+}
+
+void Mesh::MultiDrawIndirect(GLuint indirectBuffer, size_t byteOffset, GLsizei drawNum) const
+{
+    if (vao == 0 || drawNum <= 0)
+        return;
+
+    BindVertexArray();
+
+    /*
+     * 绘制参数（索引数量、实例数量、起始索引、base vertex、起始实例）从间接绘制缓冲区中读取，
+     * 参数只在 LOD 改变时才需要更新，每帧不需要再从CPU传入。
+    */
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                reinterpret_cast<const void *>(static_cast<uintptr_t>(byteOffset)), drawNum, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
 Shader &Mesh::GetShader() const
 {
     return *shader;
@@ -111,10 +317,146 @@ Shader &Mesh::GetShader() const
 void Mesh::ChangeShader(Shader *shader)
 {
     this->shader = shader;
+    this->material = nullptr;
+}
+
+void Mesh::SetMaterial(Material *material)
+{
+    this->material = material;
+    if (material)
+        this->shader = material->GetShader();
+}
+
+Material *Mesh::GetMaterial() const
+{
+    return material;
+}
+
+void Mesh::SetPositionDequantization(const glm::vec3 &scale, const glm::vec3 &offset)
+{
+    quantized = true;
+    position_scale = scale;
+    position_offset = offset;
+}
+
+void Mesh::SetLods(const MeshLod *meshLods, size_t lodNum)
+{
+    lods.assign(meshLods, meshLods + lodNum);
+    lod_index = 0;
+}
+
+void Mesh::SelectLod(size_t lodIndex)
+{
+    if (lods.empty())
+        return;
+
+    lod_index = std::min(lodIndex, lods.size() - 1);
+}
+
+void Mesh::ComputeBounds(const void *vertexData, size_t vertexBytes, const VertexAttribute &position)
+{
+    has_bounds = false;
+
+    GLsizei component_bytes = 0;
+    if (position.type == GL_FLOAT)
+        component_bytes = sizeof(GLfloat);
+    else if (position.type == GL_UNSIGNED_SHORT)
+        component_bytes = sizeof(uint16_t);
+
+    if (!vertexData || component_bytes == 0 || position.size < 3)
+        return;
+
+    // stride 为0表示紧密排列
+    const size_t stride = position.stride > 0 ? position.stride : position.size * component_bytes;
+    const size_t offset = reinterpret_cast<size_t>(position.pointer);
+    if (vertexBytes < offset + 3 * component_bytes)
+        return;
+
+    const size_t vertex_num = (vertexBytes - offset - 3 * component_bytes) / stride + 1;
+    const uint8_t *data = static_cast<const uint8_t *>(vertexData) + offset;
+
+    bounds_min = glm::vec3(std::numeric_limits<float>::max());
+    bounds_max = glm::vec3(std::numeric_limits<float>::lowest());
+    for (size_t idx = 0; idx < vertex_num; idx++)
+    {
+        const uint8_t *vertex = data + idx * stride;
+
+        glm::vec3 pos;
+        if (position.type == GL_FLOAT)
+        {
+            std::memcpy(&pos, vertex, sizeof(pos));
+        }
+        else
+        {
+            uint16_t values[3];
+            std::memcpy(values, vertex, sizeof(values));
+            pos = glm::vec3(values[0], values[1], values[2]);
+            if (position.normalized)
+                pos /= 65535.0f;
+        }
+
+        bounds_min = glm::min(bounds_min, pos);
+        bounds_max = glm::max(bounds_max, pos);
+    }
+
+    has_bounds = vertex_num > 0;
+}
+
+bool Mesh::GetBoundingBox(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const
+{
+    if (!has_bounds)
+        return false;
+
+    if (!quantized)
+    {
+        boundsMin = bounds_min;
+        boundsMax = bounds_max;
+        return true;
+    }
+
+    // 还原公式与顶点着色器一致：position = offset + scale * aPos
+    const glm::vec3 corner0 = position_offset + position_scale * bounds_min;
+    const glm::vec3 corner1 = position_offset + position_scale * bounds_max;
+    boundsMin = glm::min(corner0, corner1);
+    boundsMax = glm::max(corner0, corner1);
+    return true;
+}
+
+bool Mesh::GetBoundingSphere(glm::vec3 &center, float &radius) const
+{
+    glm::vec3 bounds_min_value, bounds_max_value;
+    if (!GetBoundingBox(bounds_min_value, bounds_max_value))
+        return false;
+
+    center = (bounds_min_value + bounds_max_value) * 0.5f;
+    radius = glm::length(bounds_max_value - bounds_min_value) * 0.5f;
+    return true;
+}
+
+size_t Mesh::GetLodNum() const
+{
+    return lods.empty() ? 1 : lods.size();
+}
+
+const MeshLod *Mesh::GetLod(size_t lodIndex) const
+{
+    return lodIndex < lods.size() ? &lods[lodIndex] : nullptr;
 }
 
 void Mesh::SetupMesh(const std::vector<GLfloat> &vertices, const std::vector<GLuint> &indices,
                      const std::vector<VertexAttribute> &attributes)
+{
+    SetupMesh(vertices.data(), vertices.size(), indices.data(), indices.size(), attributes);
+}
+
+void Mesh::SetupMesh(const GLfloat *vertices, size_t vertexFloatNum, const GLuint *indices, size_t indexNum,
+                     const std::vector<VertexAttribute> &attributes)
+{
+    SetupMesh(static_cast<const void *>(vertices), vertexFloatNum * sizeof(GLfloat), indices, indexNum, attributes);
+}
+
+void Mesh::SetupMesh(const void *vertexData, size_t vertexBytes, const GLuint *indices, size_t indexNum,
+                     const std::vector<VertexAttribute> &attributes)
 {
     /*
      * glGenVertexArrays 是 OpenGL 中的一个函数，用于生成一个或多个顶点数组对象 (VAO, Vertex Array Object)。
@@ -143,7 +485,7 @@ void Mesh::SetupMesh(const std::vector<GLfloat> &vertices, const std::vector<GLu
 
      * bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
     */
-    glBindVertexArray(vao);
+    GLStateCache::getInstance().BindVertexArray(vao);
 
     /*
      * 在OpenGL中，glBindBuffer函数用于将一个缓冲区对象（Buffer Object）绑定到一个指定的缓冲区绑定点。
@@ -173,7 +515,11 @@ void Mesh::SetupMesh(const std::vector<GLfloat> &vertices, const std::vector<GLu
      *  3. 如果数据参数不为NULL，那么新的数据存储会被初始化为这个参数指向的数据。
      *  4. glBufferData函数会创建一个数据在“快速内存”（即GPU可以直接访问的RAM）中的工作副本，而不是每次调用glDrawElements或glDrawArrays时都需要在内存域（即CPU→GPU）之间传输顶点属性。
     */
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertexData, GL_STATIC_DRAW);
+
+    // 上传后不再保留顶点数据，包围盒只能在这里计算
+    if (!attributes.empty())
+        ComputeBounds(vertexData, vertexBytes, attributes[0]);
 
     /*
      * 在OpenGL中，glBindBuffer函数用于将一个缓冲区对象（Buffer Object）绑定到一个指定的缓冲区绑定点。
@@ -203,7 +549,7 @@ void Mesh::SetupMesh(const std::vector<GLfloat> &vertices, const std::vector<GLu
      *  3. 如果数据参数不为NULL，那么新的数据存储会被初始化为这个参数指向的数据。
      *  4. glBufferData函数会创建一个数据在“快速内存”（即GPU可以直接访问的RAM）中的工作副本，而不是每次调用glDrawElements或glDrawArrays时都需要在内存域（即CPU→GPU）之间传输顶点属性。
     */
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexNum * sizeof(GLuint), indices, GL_STATIC_DRAW);
 
     // 设置顶点属性指针
     for (size_t i = 0; i < attributes.size(); ++i)
@@ -269,7 +615,7 @@ void Mesh::SetupMesh(const std::vector<GLfloat> &vertices, const std::vector<GLu
      * You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens.
      * Modifying other VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
     */
-    glBindVertexArray(0);
+    GLStateCache::getInstance().BindVertexArray(0);
 
-    index_num = indices.size();
+    index_num = static_cast<GLsizei>(indexNum);
 }
\ No newline at end of file
@@ -0,0 +1,318 @@
+#include "MeshCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+const char CACHE_MAGIC[4] = {'L', 'G', 'M', 'C'};
+
+/* 顶点布局固定为 位置(3)-法线(3)-纹理坐标(2) */
+const uint32_t VERTEX_STRIDE = 8;
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t source_hash;
+    uint32_t mesh_num;
+    uint32_t vertex_stride;
+};
+
+struct MeshHeader
+{
+    uint32_t vertex_float_num;
+    uint32_t index_num;
+    uint32_t material_index;
+    float bounds_min[3];
+    float bounds_max[3];
+    uint32_t diffuse_num;
+    uint32_t specular_num;
+    uint32_t lod_num;
+};
+
+/*
+ * 在映射的内存上顺序读取数据，每次读取前都检查是否越界，防止损坏或截断的缓存文件导致非法访问。
+ * 文件中所有字段都按4字节对齐，所以可以直接把指针当作 float/uint32 数组使用。
+*/
+class CacheReader
+{
+  private:
+    const uint8_t *m_cur;
+    const uint8_t *m_end;
+
+  public:
+    CacheReader(const uint8_t *data, size_t size) : m_cur(data), m_end(data + size)
+    {
+    }
+
+    size_t Remaining() const
+    {
+        return static_cast<size_t>(m_end - m_cur);
+    }
+
+    const uint8_t *Take(size_t size)
+    {
+        if (static_cast<size_t>(m_end - m_cur) < size)
+            return nullptr;
+
+        const uint8_t *ptr = m_cur;
+        m_cur += (size + 3) & ~static_cast<size_t>(3);
+        if (m_cur > m_end)
+            m_cur = m_end;
+        return ptr;
+    }
+
+    template <typename T> bool Read(T &value)
+    {
+        const uint8_t *ptr = Take(sizeof(T));
+        if (!ptr)
+            return false;
+
+        std::memcpy(&value, ptr, sizeof(T));
+        return true;
+    }
+
+    bool ReadString(std::string &str)
+    {
+        uint32_t length = 0;
+        if (!Read(length))
+            return false;
+
+        const uint8_t *ptr = Take(length);
+        if (!ptr)
+            return false;
+
+        str.assign(reinterpret_cast<const char *>(ptr), length);
+        return true;
+    }
+};
+
+void WritePadding(std::ofstream &out, size_t size)
+{
+    static const char zeros[4] = {0, 0, 0, 0};
+    size_t padding = ((size + 3) & ~static_cast<size_t>(3)) - size;
+    out.write(zeros, static_cast<std::streamsize>(padding));
+}
+
+template <typename T> void WriteValue(std::ofstream &out, const T &value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    WritePadding(out, sizeof(T));
+}
+
+void WriteString(std::ofstream &out, const std::string &str)
+{
+    WriteValue(out, static_cast<uint32_t>(str.size()));
+    out.write(str.data(), static_cast<std::streamsize>(str.size()));
+    WritePadding(out, str.size());
+}
+} // namespace
+
+MeshCache::MeshCache()
+{
+}
+
+MeshCache::~MeshCache()
+{
+}
+
+bool MeshCache::Open(const std::string &cachePath, uint64_t sourceHash)
+{
+    m_meshes.clear();
+    m_materials.clear();
+
+    if (!m_file.Open(cachePath))
+        return false;
+
+    CacheReader reader(m_file.GetData(), m_file.GetSize());
+
+    FileHeader header;
+    if (!reader.Read(header) || std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.version != VERSION || header.source_hash != sourceHash || header.vertex_stride != VERTEX_STRIDE)
+    {
+        m_file.Close();
+        return false;
+    }
+
+    // 数量来自文件，分配之前先确认剩余的数据至少能容纳这么多网格头，防止损坏的文件导致巨大的分配
+    if (header.mesh_num > reader.Remaining() / sizeof(MeshHeader))
+    {
+        std::cerr << "Mesh cache is corrupted: " << cachePath << std::endl;
+        m_file.Close();
+        return false;
+    }
+
+    // 先把材质数组的空间分配好，保证 MeshView 中指向材质的指针不会因扩容而失效
+    m_materials.resize(header.mesh_num);
+    m_meshes.resize(header.mesh_num);
+
+    bool valid = true;
+    for (uint32_t idx = 0; valid && idx < header.mesh_num; idx++)
+    {
+        MeshHeader mesh_header;
+        if (!reader.Read(mesh_header))
+        {
+            valid = false;
+            break;
+        }
+
+        // 每个纹理路径至少占用4字节的长度字段
+        const uint64_t texture_num = static_cast<uint64_t>(mesh_header.diffuse_num) + mesh_header.specular_num;
+        if (texture_num > reader.Remaining() / sizeof(uint32_t))
+        {
+            valid = false;
+            break;
+        }
+
+        MeshMaterialData &material = m_materials[idx];
+
+        material.diffuse_textures.resize(mesh_header.diffuse_num);
+        for (std::string &path : material.diffuse_textures)
+            valid = valid && reader.ReadString(path);
+
+        material.specular_textures.resize(mesh_header.specular_num);
+        for (std::string &path : material.specular_textures)
+            valid = valid && reader.ReadString(path);
+
+        const uint8_t *lods = reader.Take(mesh_header.lod_num * sizeof(MeshLod));
+        const uint8_t *vertices = reader.Take(mesh_header.vertex_float_num * sizeof(GLfloat));
+        const uint8_t *indices = reader.Take(mesh_header.index_num * sizeof(GLuint));
+        if (!lods || !vertices || !indices || mesh_header.vertex_float_num % VERTEX_STRIDE != 0)
+            valid = false;
+
+        // 越界的索引会让GPU读取顶点缓冲区之外的数据，必须在上传之前拒绝
+        const uint32_t vertex_num = mesh_header.vertex_float_num / VERTEX_STRIDE;
+        const GLuint *index_data = reinterpret_cast<const GLuint *>(indices);
+        for (uint32_t index = 0; valid && index < mesh_header.index_num; index++)
+        {
+            if (index_data[index] >= vertex_num)
+                valid = false;
+        }
+
+        // LOD 的索引范围不能超出索引数组
+        for (uint32_t lod = 0; valid && lod < mesh_header.lod_num; lod++)
+        {
+            const MeshLod *mesh_lod = reinterpret_cast<const MeshLod *>(lods) + lod;
+            if (static_cast<uint64_t>(mesh_lod->index_offset) + mesh_lod->index_num > mesh_header.index_num)
+                valid = false;
+        }
+
+        MeshView &view = m_meshes[idx];
+        view.vertices = reinterpret_cast<const GLfloat *>(vertices);
+        view.vertex_float_num = mesh_header.vertex_float_num;
+        view.indices = reinterpret_cast<const GLuint *>(indices);
+        view.index_num = mesh_header.index_num;
+        view.lods = reinterpret_cast<const MeshLod *>(lods);
+        view.lod_num = mesh_header.lod_num;
+        view.material_index = mesh_header.material_index;
+        view.material = &material;
+        view.bounds_min = glm::vec3(mesh_header.bounds_min[0], mesh_header.bounds_min[1], mesh_header.bounds_min[2]);
+        view.bounds_max = glm::vec3(mesh_header.bounds_max[0], mesh_header.bounds_max[1], mesh_header.bounds_max[2]);
+    }
+
+    // 文件被截断或已损坏
+    if (!valid)
+    {
+        std::cerr << "Mesh cache is corrupted: " << cachePath << std::endl;
+        m_meshes.clear();
+        m_materials.clear();
+        m_file.Close();
+        return false;
+    }
+
+    return true;
+}
+
+const std::vector<MeshView> &MeshCache::GetMeshes() const
+{
+    return m_meshes;
+}
+
+bool MeshCache::Write(const std::string &cachePath, uint64_t sourceHash, const std::vector<MeshData> &meshes)
+{
+    // 先写入临时文件再重命名，避免写入中途失败时留下半个缓存文件
+    const std::string temp_path = cachePath + ".tmp";
+
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "Failed to create mesh cache: " << cachePath << std::endl;
+            return false;
+        }
+
+        FileHeader header;
+        std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = VERSION;
+        header.source_hash = sourceHash;
+        header.mesh_num = static_cast<uint32_t>(meshes.size());
+        header.vertex_stride = VERTEX_STRIDE;
+        WriteValue(out, header);
+
+        for (const MeshData &mesh : meshes)
+        {
+            MeshHeader mesh_header;
+            mesh_header.vertex_float_num = static_cast<uint32_t>(mesh.vertices.size());
+            mesh_header.index_num = static_cast<uint32_t>(mesh.indices.size());
+            mesh_header.material_index = mesh.material_index;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                mesh_header.bounds_min[axis] = mesh.bounds_min[axis];
+                mesh_header.bounds_max[axis] = mesh.bounds_max[axis];
+            }
+            mesh_header.diffuse_num = static_cast<uint32_t>(mesh.material.diffuse_textures.size());
+            mesh_header.specular_num = static_cast<uint32_t>(mesh.material.specular_textures.size());
+            mesh_header.lod_num = static_cast<uint32_t>(mesh.lods.size());
+            WriteValue(out, mesh_header);
+
+            for (const std::string &path : mesh.material.diffuse_textures)
+                WriteString(out, path);
+            for (const std::string &path : mesh.material.specular_textures)
+                WriteString(out, path);
+
+            out.write(reinterpret_cast<const char *>(mesh.lods.data()),
+                      static_cast<std::streamsize>(mesh.lods.size() * sizeof(MeshLod)));
+            out.write(reinterpret_cast<const char *>(mesh.vertices.data()),
+                      static_cast<std::streamsize>(mesh.vertices.size() * sizeof(GLfloat)));
+            out.write(reinterpret_cast<const char *>(mesh.indices.data()),
+                      static_cast<std::streamsize>(mesh.indices.size() * sizeof(GLuint)));
+        }
+
+        if (!out.good())
+        {
+            std::cerr << "Failed to write mesh cache: " << cachePath << std::endl;
+            out.close();
+            std::error_code error;
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, cachePath, error);
+    if (error)
+    {
+        std::cerr << "Failed to write mesh cache: " << cachePath << ", " << error.message() << std::endl;
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+
+    return true;
+}
+
+std::string MeshCache::GetCachePath(const std::string &sourcePath)
+{
+    return sourcePath + ".meshcache";
+}
+
+bool MeshCache::HashFile(const std::string &path, uint64_t &hash)
+{
+    MappedFile file;
+    if (!file.Open(path))
+        return false;
+
+    hash = file.ComputeHash();
+    return true;
+}
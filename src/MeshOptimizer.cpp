@@ -0,0 +1,472 @@
+#include "MeshOptimizer.h"
+#include "glm/glm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+constexpr GLuint INVALID_INDEX = ~0u;
+
+/*
+ * 顶点缓存优化使用的评分参数，取自 Forsyth 的原文。
+*/
+constexpr int FORSYTH_CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRI_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+float VertexScore(int cachePosition, unsigned int remainingValence)
+{
+    // 没有剩余三角形的顶点不再参与评分
+    if (remainingValence == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // 刚刚使用过的三个顶点得分固定，避免算法总是选择与上一个三角形共边的三角形形成长条
+        if (cachePosition < 3)
+            score = LAST_TRI_SCORE;
+        else
+        {
+            const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+
+    // 剩余三角形越少的顶点得分越高，尽快把它用完，避免之后再次被加载
+    score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingValence), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+uint64_t HashVertex(const GLfloat *vertex, size_t stride)
+{
+    // FNV-1a，按位比较浮点数，只有完全相同的顶点才会被焊接
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(vertex);
+    for (size_t idx = 0; idx < stride * sizeof(GLfloat); idx++)
+    {
+        hash ^= bytes[idx];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+glm::vec3 GetPosition(const std::vector<GLfloat> &vertices, size_t stride, GLuint index)
+{
+    const GLfloat *src = vertices.data() + static_cast<size_t>(index) * stride;
+    return glm::vec3(src[0], src[1], src[2]);
+}
+} // namespace
+
+MeshOptimizeStats MeshOptimizer::Optimize(std::vector<GLfloat> &vertices, std::vector<GLuint> &indices, size_t stride)
+{
+    MeshOptimizeStats stats{};
+    stats.triangle_num = indices.size() / 3;
+    stats.vertex_num_before = vertices.size() / stride;
+    stats.acmr_before = ComputeACMR(indices, stats.vertex_num_before);
+
+    const size_t vertex_num = WeldVertices(vertices, indices, stride);
+    OptimizeVertexCache(indices, vertex_num);
+    OptimizeOverdraw(indices, vertices, stride);
+    OptimizeVertexFetch(vertices, indices, stride);
+
+    stats.vertex_num_after = vertices.size() / stride;
+    stats.acmr_after = ComputeACMR(indices, stats.vertex_num_after);
+
+    return stats;
+}
+
+size_t MeshOptimizer::WeldVertices(std::vector<GLfloat> &vertices, std::vector<GLuint> &indices, size_t stride)
+{
+    const size_t vertex_num = vertices.size() / stride;
+    if (vertex_num == 0)
+        return 0;
+
+    // 开放寻址哈希表，容量取不小于两倍顶点数的2的幂
+    size_t table_size = 1;
+    while (table_size < vertex_num * 2)
+        table_size <<= 1;
+    std::vector<GLuint> table(table_size, INVALID_INDEX);
+
+    std::vector<GLuint> remap(vertex_num);
+    size_t unique_num = 0;
+
+    for (size_t idx = 0; idx < vertex_num; idx++)
+    {
+        const GLfloat *vertex = vertices.data() + idx * stride;
+        size_t slot = HashVertex(vertex, stride) & (table_size - 1);
+
+        while (true)
+        {
+            const GLuint candidate = table[slot];
+            if (candidate == INVALID_INDEX)
+            {
+                // 新顶点直接压缩到数组前部
+                if (unique_num != idx)
+                    std::memmove(vertices.data() + unique_num * stride, vertex, stride * sizeof(GLfloat));
+                table[slot] = static_cast<GLuint>(unique_num);
+                remap[idx] = static_cast<GLuint>(unique_num);
+                unique_num++;
+                break;
+            }
+
+            if (std::memcmp(vertices.data() + static_cast<size_t>(candidate) * stride, vertex,
+                            stride * sizeof(GLfloat)) == 0)
+            {
+                remap[idx] = candidate;
+                break;
+            }
+
+            slot = (slot + 1) & (table_size - 1);
+        }
+    }
+
+    vertices.resize(unique_num * stride);
+    for (GLuint &index : indices)
+    {
+        index = remap[index];
+    }
+
+    return unique_num;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<GLuint> &indices, size_t vertexNum)
+{
+    const size_t triangle_num = indices.size() / 3;
+    if (triangle_num == 0 || vertexNum == 0)
+        return;
+
+    // 建立顶点到三角形的邻接表
+    std::vector<unsigned int> valence(vertexNum, 0);
+    for (GLuint index : indices)
+    {
+        valence[index]++;
+    }
+
+    std::vector<unsigned int> adjacency_offset(vertexNum + 1, 0);
+    for (size_t idx = 0; idx < vertexNum; idx++)
+    {
+        adjacency_offset[idx + 1] = adjacency_offset[idx] + valence[idx];
+    }
+
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> fill(adjacency_offset.begin(), adjacency_offset.end() - 1);
+        for (size_t tri = 0; tri < triangle_num; tri++)
+        {
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                adjacency[fill[indices[tri * 3 + corner]]++] = static_cast<unsigned int>(tri);
+            }
+        }
+    }
+
+    std::vector<int> cache_position(vertexNum, -1);
+    std::vector<float> vertex_score(vertexNum);
+    for (size_t idx = 0; idx < vertexNum; idx++)
+    {
+        vertex_score[idx] = VertexScore(-1, valence[idx]);
+    }
+
+    std::vector<float> triangle_score(triangle_num);
+    std::vector<bool> emitted(triangle_num, false);
+    for (size_t tri = 0; tri < triangle_num; tri++)
+    {
+        triangle_score[tri] = vertex_score[indices[tri * 3]] + vertex_score[indices[tri * 3 + 1]] +
+                              vertex_score[indices[tri * 3 + 2]];
+    }
+
+    // 多保留3个位置，用于容纳新加入的三角形顶点，超出 FORSYTH_CACHE_SIZE 的部分会被淘汰
+    std::vector<GLuint> cache;
+    std::vector<GLuint> new_cache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    new_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+
+    size_t best_triangle = static_cast<size_t>(
+        std::max_element(triangle_score.begin(), triangle_score.end()) - triangle_score.begin());
+    size_t scan_cursor = 0;
+
+    for (size_t output = 0; output < triangle_num; output++)
+    {
+        // 缓存中没有可用的候选三角形时，按原顺序找到下一个未输出的三角形
+        if (best_triangle == SIZE_MAX)
+        {
+            while (emitted[scan_cursor])
+                scan_cursor++;
+            best_triangle = scan_cursor;
+        }
+
+        const GLuint *tri_indices = indices.data() + best_triangle * 3;
+        emitted[best_triangle] = true;
+        result.insert(result.end(), tri_indices, tri_indices + 3);
+
+        // 从三个顶点的邻接表中移除该三角形
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            const GLuint vertex = tri_indices[corner];
+            unsigned int *begin = adjacency.data() + adjacency_offset[vertex];
+            unsigned int *end = begin + valence[vertex];
+            unsigned int *found = std::find(begin, end, static_cast<unsigned int>(best_triangle));
+            if (found != end)
+            {
+                std::swap(*found, *(end - 1));
+                valence[vertex]--;
+            }
+        }
+
+        // 新三角形的顶点放在缓存最前面，其余顶点依次后移
+        new_cache.assign(tri_indices, tri_indices + 3);
+        for (GLuint vertex : cache)
+        {
+            if (vertex != tri_indices[0] && vertex != tri_indices[1] && vertex != tri_indices[2])
+                new_cache.push_back(vertex);
+        }
+
+        // 被挤出缓存的顶点位置置为 -1
+        for (size_t idx = FORSYTH_CACHE_SIZE; idx < new_cache.size(); idx++)
+        {
+            cache_position[new_cache[idx]] = -1;
+            vertex_score[new_cache[idx]] = VertexScore(-1, valence[new_cache[idx]]);
+        }
+        if (new_cache.size() > static_cast<size_t>(FORSYTH_CACHE_SIZE))
+            new_cache.resize(FORSYTH_CACHE_SIZE);
+
+        std::swap(cache, new_cache);
+
+        for (size_t idx = 0; idx < cache.size(); idx++)
+        {
+            cache_position[cache[idx]] = static_cast<int>(idx);
+            vertex_score[cache[idx]] = VertexScore(static_cast<int>(idx), valence[cache[idx]]);
+        }
+
+        // 只需要重新计算缓存中顶点相邻的三角形的分数，并从中挑选下一个三角形
+        best_triangle = SIZE_MAX;
+        float best_score = -1.0f;
+        for (GLuint vertex : cache)
+        {
+            const unsigned int *begin = adjacency.data() + adjacency_offset[vertex];
+            for (unsigned int idx = 0; idx < valence[vertex]; idx++)
+            {
+                const unsigned int tri = begin[idx];
+                const float score = vertex_score[indices[tri * 3]] + vertex_score[indices[tri * 3 + 1]] +
+                                    vertex_score[indices[tri * 3 + 2]];
+                triangle_score[tri] = score;
+
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_triangle = tri;
+                }
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<GLuint> &indices, const std::vector<GLfloat> &vertices,
+                                     size_t stride, float threshold)
+{
+    const size_t triangle_num = indices.size() / 3;
+    const size_t vertex_num = vertices.size() / stride;
+    if (triangle_num < 2 || vertex_num == 0)
+        return;
+
+    /*
+     * 第一步：模拟顶点缓存，三个顶点全部未命中的三角形意味着缓存局部性在此处已经中断，
+     * 在这些位置切分不会带来额外的缓存代价（硬边界）。
+    */
+    std::vector<size_t> hard_clusters;
+    {
+        std::vector<unsigned int> timestamp(vertex_num, 0);
+        unsigned int time = CACHE_SIZE + 1;
+
+        for (size_t tri = 0; tri < triangle_num; tri++)
+        {
+            unsigned int misses = 0;
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                const GLuint vertex = indices[tri * 3 + corner];
+                if (time - timestamp[vertex] > CACHE_SIZE)
+                {
+                    timestamp[vertex] = time++;
+                    misses++;
+                }
+            }
+
+            if (tri == 0 || misses == 3)
+                hard_clusters.push_back(tri);
+        }
+    }
+
+    /*
+     * 第二步：在每个硬边界簇内继续切分（软边界）。从簇起点开始重置缓存并累计未命中次数，
+     * 当累计 ACMR 不超过整个簇 ACMR 的 threshold 倍时就可以在此切分，簇越小越利于后续排序。
+    */
+    std::vector<size_t> clusters;
+    {
+        std::vector<unsigned int> timestamp(vertex_num, 0);
+        unsigned int time = 0;
+
+        auto count_misses = [&](size_t tri) {
+            unsigned int misses = 0;
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                const GLuint vertex = indices[tri * 3 + corner];
+                if (time - timestamp[vertex] > CACHE_SIZE)
+                {
+                    timestamp[vertex] = time++;
+                    misses++;
+                }
+            }
+            return misses;
+        };
+
+        for (size_t cluster = 0; cluster < hard_clusters.size(); cluster++)
+        {
+            const size_t start = hard_clusters[cluster];
+            const size_t end = cluster + 1 < hard_clusters.size() ? hard_clusters[cluster + 1] : triangle_num;
+
+            // 整个簇的 ACMR
+            time += CACHE_SIZE + 1;
+            unsigned int cluster_misses = 0;
+            for (size_t tri = start; tri < end; tri++)
+                cluster_misses += count_misses(tri);
+            const float cluster_acmr = static_cast<float>(cluster_misses) / (end - start);
+
+            time += CACHE_SIZE + 1;
+            clusters.push_back(start);
+            unsigned int running_misses = 0;
+            size_t running_start = start;
+            for (size_t tri = start; tri < end; tri++)
+            {
+                running_misses += count_misses(tri);
+                const float running_acmr = static_cast<float>(running_misses) / (tri - running_start + 1);
+
+                if (tri + 1 < end && running_acmr <= cluster_acmr * threshold)
+                {
+                    clusters.push_back(tri + 1);
+                    running_start = tri + 1;
+                    running_misses = 0;
+                    time += CACHE_SIZE + 1;
+                }
+            }
+        }
+    }
+
+    if (clusters.size() < 2)
+        return;
+
+    /*
+     * 第三步：计算网格中心以及每个簇的面积加权中心和平均法线，
+     * 簇中心相对网格中心的位置与法线的点积越大，簇越朝外，越可能遮挡其他簇，应该先绘制。
+    */
+    glm::vec3 mesh_centroid(0.0f);
+    for (size_t idx = 0; idx < vertex_num; idx++)
+    {
+        mesh_centroid += GetPosition(vertices, stride, static_cast<GLuint>(idx));
+    }
+    mesh_centroid /= static_cast<float>(vertex_num);
+
+    std::vector<float> sort_keys(clusters.size());
+    for (size_t cluster = 0; cluster < clusters.size(); cluster++)
+    {
+        const size_t start = clusters[cluster];
+        const size_t end = cluster + 1 < clusters.size() ? clusters[cluster + 1] : triangle_num;
+
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area_sum = 0.0f;
+        for (size_t tri = start; tri < end; tri++)
+        {
+            const glm::vec3 p0 = GetPosition(vertices, stride, indices[tri * 3]);
+            const glm::vec3 p1 = GetPosition(vertices, stride, indices[tri * 3 + 1]);
+            const glm::vec3 p2 = GetPosition(vertices, stride, indices[tri * 3 + 2]);
+
+            // 叉积的长度是三角形面积的两倍，直接累加叉积即得到面积加权的法线
+            const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            const float area = glm::length(cross);
+
+            centroid += (p0 + p1 + p2) * (area / 3.0f);
+            normal += cross;
+            area_sum += area;
+        }
+
+        if (area_sum > 0.0f)
+            centroid /= area_sum;
+
+        const float normal_length = glm::length(normal);
+        if (normal_length > 0.0f)
+            normal /= normal_length;
+
+        sort_keys[cluster] = glm::dot(centroid - mesh_centroid, normal);
+    }
+
+    std::vector<size_t> order(clusters.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sort_keys[a] > sort_keys[b]; });
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+    for (size_t cluster : order)
+    {
+        const size_t start = clusters[cluster];
+        const size_t end = cluster + 1 < clusters.size() ? clusters[cluster + 1] : triangle_num;
+        result.insert(result.end(), indices.begin() + start * 3, indices.begin() + end * 3);
+    }
+
+    indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<GLfloat> &vertices, std::vector<GLuint> &indices, size_t stride)
+{
+    const size_t vertex_num = vertices.size() / stride;
+    std::vector<GLuint> remap(vertex_num, INVALID_INDEX);
+    std::vector<GLfloat> result;
+    result.reserve(vertices.size());
+
+    GLuint next_index = 0;
+    for (GLuint &index : indices)
+    {
+        if (remap[index] == INVALID_INDEX)
+        {
+            remap[index] = next_index++;
+            const GLfloat *src = vertices.data() + static_cast<size_t>(index) * stride;
+            result.insert(result.end(), src, src + stride);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(result);
+}
+
+float MeshOptimizer::ComputeACMR(const std::vector<GLuint> &indices, size_t vertexNum, unsigned int cacheSize)
+{
+    const size_t triangle_num = indices.size() / 3;
+    if (triangle_num == 0)
+        return 0.0f;
+
+    // 用时间戳模拟FIFO缓存：顶点进入缓存后，再有 cacheSize 个顶点进入就会被淘汰
+    std::vector<unsigned int> timestamp(vertexNum, 0);
+    unsigned int time = cacheSize + 1;
+    size_t misses = 0;
+
+    for (GLuint index : indices)
+    {
+        if (time - timestamp[index] > cacheSize)
+        {
+            timestamp[index] = time++;
+            misses++;
+        }
+    }
+
+    return static_cast<float>(misses) / triangle_num;
+}
@@ -0,0 +1,343 @@
+#include "MeshSimplifier.h"
+#include "glm/glm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+/*
+ * 对称的4x4二次误差矩阵，只保存上三角的10个元素。
+ * 平面 ax+by+cz+d=0 的二次型为 [a b c d]^T [a b c d]，点到平面距离的平方为 v^T Q v，v=(x,y,z,1)。
+*/
+struct Quadric
+{
+    double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+    double ab = 0, ac = 0, ad = 0, bc = 0, bd = 0, cd = 0;
+
+    static Quadric FromPlane(double a, double b, double c, double d)
+    {
+        Quadric q;
+        q.a2 = a * a;
+        q.b2 = b * b;
+        q.c2 = c * c;
+        q.d2 = d * d;
+        q.ab = a * b;
+        q.ac = a * c;
+        q.ad = a * d;
+        q.bc = b * c;
+        q.bd = b * d;
+        q.cd = c * d;
+        return q;
+    }
+
+    Quadric &operator+=(const Quadric &other)
+    {
+        a2 += other.a2;
+        b2 += other.b2;
+        c2 += other.c2;
+        d2 += other.d2;
+        ab += other.ab;
+        ac += other.ac;
+        ad += other.ad;
+        bc += other.bc;
+        bd += other.bd;
+        cd += other.cd;
+        return *this;
+    }
+
+    double Evaluate(const glm::vec3 &p) const
+    {
+        const double x = p.x, y = p.y, z = p.z;
+        const double result = a2 * x * x + b2 * y * y + c2 * z * z + d2 + 2.0 * (ab * x * y + ac * x * z + ad * x +
+                                                                                 bc * y * z + bd * y + cd * z);
+        // 浮点误差可能导致结果略小于0
+        return std::max(result, 0.0);
+    }
+};
+
+struct Collapse
+{
+    double cost;
+    GLuint from;
+    GLuint to;
+
+    bool operator<(const Collapse &other) const
+    {
+        if (cost != other.cost)
+            return cost < other.cost;
+        if (from != other.from)
+            return from < other.from;
+        return to < other.to;
+    }
+};
+
+struct PositionHash
+{
+    size_t operator()(const glm::vec3 &p) const
+    {
+        uint32_t bits[3];
+        std::memcpy(bits, &p, sizeof(bits));
+        return (static_cast<size_t>(bits[0]) * 73856093u) ^ (static_cast<size_t>(bits[1]) * 19349663u) ^
+               (static_cast<size_t>(bits[2]) * 83492791u);
+    }
+};
+} // namespace
+
+std::vector<GLuint> MeshSimplifier::Simplify(const GLfloat *vertices, size_t vertexNum, size_t stride,
+                                             const GLuint *indices, size_t indexNum, size_t targetIndexNum,
+                                             float targetError, float *resultError)
+{
+    std::vector<GLuint> result(indices, indices + indexNum);
+    if (resultError)
+        *resultError = 0.0f;
+
+    if (vertexNum == 0 || indexNum < 3)
+        return result;
+
+    std::vector<glm::vec3> positions(vertexNum);
+    glm::vec3 bounds_min(vertices[0], vertices[1], vertices[2]);
+    glm::vec3 bounds_max = bounds_min;
+    for (size_t idx = 0; idx < vertexNum; idx++)
+    {
+        const GLfloat *src = vertices + idx * stride;
+        positions[idx] = glm::vec3(src[0], src[1], src[2]);
+        bounds_min = glm::min(bounds_min, positions[idx]);
+        bounds_max = glm::max(bounds_max, positions[idx]);
+    }
+
+    const double extent = glm::length(bounds_max - bounds_min);
+    if (extent <= 0.0)
+        return result;
+
+    const double error_limit = static_cast<double>(targetError) * extent;
+    const double cost_limit = error_limit * error_limit;
+
+    // 每个顶点的二次误差为相邻三角形所在平面的二次型之和
+    std::vector<Quadric> quadrics(vertexNum);
+    for (size_t tri = 0; tri + 2 < indexNum; tri += 3)
+    {
+        const glm::vec3 &p0 = positions[indices[tri]];
+        const glm::vec3 &p1 = positions[indices[tri + 1]];
+        const glm::vec3 &p2 = positions[indices[tri + 2]];
+
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const float length = glm::length(normal);
+        if (length <= 0.0f)
+            continue;
+        normal /= length;
+
+        const Quadric q = Quadric::FromPlane(normal.x, normal.y, normal.z, -glm::dot(normal, p0));
+        for (size_t corner = 0; corner < 3; corner++)
+            quadrics[indices[tri + corner]] += q;
+    }
+
+    /*
+     * 锁定不能折叠的顶点：
+     *  接缝顶点：存在其他位置相同的顶点，折叠后会在纹理或法线不连续处产生裂缝。
+     *  边界顶点：只属于一个三角形的边的端点，折叠后会改变网格轮廓。
+    */
+    std::vector<bool> locked(vertexNum, false);
+    {
+        std::unordered_map<glm::vec3, GLuint, PositionHash> first_vertex;
+        first_vertex.reserve(vertexNum);
+        for (size_t idx = 0; idx < vertexNum; idx++)
+        {
+            auto inserted = first_vertex.emplace(positions[idx], static_cast<GLuint>(idx));
+            if (!inserted.second)
+            {
+                locked[idx] = true;
+                locked[inserted.first->second] = true;
+            }
+        }
+
+        std::vector<std::pair<GLuint, GLuint>> edges;
+        edges.reserve(indexNum);
+        for (size_t tri = 0; tri + 2 < indexNum; tri += 3)
+        {
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                GLuint a = indices[tri + corner];
+                GLuint b = indices[tri + (corner + 1) % 3];
+                edges.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        for (size_t idx = 0; idx < edges.size();)
+        {
+            size_t end = idx + 1;
+            while (end < edges.size() && edges[end] == edges[idx])
+                end++;
+
+            if (end - idx == 1)
+            {
+                locked[edges[idx].first] = true;
+                locked[edges[idx].second] = true;
+            }
+            idx = end;
+        }
+    }
+
+    double max_cost = 0.0;
+
+    std::vector<unsigned int> adjacency_offset(vertexNum + 1);
+    std::vector<unsigned int> adjacency;
+    std::vector<std::pair<GLuint, GLuint>> edges;
+    std::vector<Collapse> collapses;
+    std::vector<bool> touched(vertexNum);
+    std::vector<GLuint> remap(vertexNum);
+
+    /*
+     * 按轮次进行折叠：每一轮收集当前网格的所有边，按折叠代价从小到大排序后依次尝试，
+     * 同一轮内相互影响的折叠（共享顶点或相邻三角形）只执行第一个，剩余的留到下一轮重新计算。
+    */
+    while (result.size() > targetIndexNum)
+    {
+        const size_t triangle_num = result.size() / 3;
+
+        // 顶点到三角形的邻接表
+        std::fill(adjacency_offset.begin(), adjacency_offset.end(), 0);
+        for (GLuint index : result)
+            adjacency_offset[index + 1]++;
+        for (size_t idx = 0; idx < vertexNum; idx++)
+            adjacency_offset[idx + 1] += adjacency_offset[idx];
+
+        adjacency.resize(result.size());
+        {
+            std::vector<unsigned int> fill(adjacency_offset.begin(), adjacency_offset.end() - 1);
+            for (size_t tri = 0; tri < triangle_num; tri++)
+            {
+                for (size_t corner = 0; corner < 3; corner++)
+                    adjacency[fill[result[tri * 3 + corner]]++] = static_cast<unsigned int>(tri);
+            }
+        }
+
+        // 收集当前网格中不重复的边
+        edges.clear();
+        for (size_t tri = 0; tri < triangle_num; tri++)
+        {
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                GLuint a = result[tri * 3 + corner];
+                GLuint b = result[tri * 3 + (corner + 1) % 3];
+                edges.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        // 每条边选择代价更小的折叠方向
+        collapses.clear();
+        for (const auto &edge : edges)
+        {
+            Quadric q = quadrics[edge.first];
+            q += quadrics[edge.second];
+
+            const bool can_first = !locked[edge.first];
+            const bool can_second = !locked[edge.second];
+            if (!can_first && !can_second)
+                continue;
+
+            const double cost_first = can_first ? q.Evaluate(positions[edge.second]) : -1.0;
+            const double cost_second = can_second ? q.Evaluate(positions[edge.first]) : -1.0;
+
+            if (can_first && (!can_second || cost_first <= cost_second))
+                collapses.push_back({cost_first, edge.first, edge.second});
+            else
+                collapses.push_back({cost_second, edge.second, edge.first});
+        }
+        std::sort(collapses.begin(), collapses.end());
+
+        std::fill(touched.begin(), touched.end(), false);
+        for (size_t idx = 0; idx < vertexNum; idx++)
+            remap[idx] = static_cast<GLuint>(idx);
+
+        size_t remaining_index_num = result.size();
+        size_t collapse_num = 0;
+
+        for (const Collapse &collapse : collapses)
+        {
+            if (collapse.cost > cost_limit || remaining_index_num <= targetIndexNum)
+                break;
+
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+
+            // 检查与被折叠顶点相邻的三角形：折叠后不能翻转，也不能涉及本轮已经改变过的顶点
+            bool valid = true;
+            size_t removed_triangle_num = 0;
+            for (unsigned int adj = adjacency_offset[collapse.from]; valid && adj < adjacency_offset[collapse.from + 1];
+                 adj++)
+            {
+                const GLuint *tri = result.data() + static_cast<size_t>(adjacency[adj]) * 3;
+
+                if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to)
+                {
+                    removed_triangle_num++;
+                    continue;
+                }
+
+                glm::vec3 before[3], after[3];
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    if (touched[tri[corner]])
+                        valid = false;
+
+                    before[corner] = positions[tri[corner]];
+                    after[corner] = tri[corner] == collapse.from ? positions[collapse.to] : before[corner];
+                }
+
+                const glm::vec3 normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+                const glm::vec3 normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+                if (glm::dot(normal_before, normal_after) <= 0.0f)
+                    valid = false;
+            }
+
+            if (!valid)
+                continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            max_cost = std::max(max_cost, collapse.cost);
+
+            touched[collapse.from] = true;
+            touched[collapse.to] = true;
+            for (unsigned int adj = adjacency_offset[collapse.from]; adj < adjacency_offset[collapse.from + 1]; adj++)
+            {
+                const GLuint *tri = result.data() + static_cast<size_t>(adjacency[adj]) * 3;
+                for (size_t corner = 0; corner < 3; corner++)
+                    touched[tri[corner]] = true;
+            }
+
+            remaining_index_num -= removed_triangle_num * 3;
+            collapse_num++;
+        }
+
+        if (collapse_num == 0)
+            break;
+
+        // 应用本轮的折叠并删除退化的三角形
+        size_t write = 0;
+        for (size_t tri = 0; tri < triangle_num; tri++)
+        {
+            const GLuint a = remap[result[tri * 3]];
+            const GLuint b = remap[result[tri * 3 + 1]];
+            const GLuint c = remap[result[tri * 3 + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (resultError)
+        *resultError = static_cast<float>(std::sqrt(max_cost) / extent);
+
+    return result;
+}
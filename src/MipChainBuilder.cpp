@@ -0,0 +1,429 @@
+#include "MipChainBuilder.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+const char CACHE_MAGIC[4] = {'L', 'G', 'M', 'P'};
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t source_hash;
+    int32_t width;
+    int32_t height;
+    int32_t channel_num;
+    uint32_t level_num;
+    uint32_t srgb; // 滤波方式不同，同一张图片按 sRGB 和线性处理的结果不能混用
+    uint32_t reserved;
+};
+
+struct LevelHeader
+{
+    int32_t width;
+    int32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+/* 每个任务大约处理的像素数，太小时调度开销超过计算量 */
+const size_t PIXELS_PER_TASK = 64 * 1024;
+
+/* 线性值到 sRGB 的查找表精度 */
+const int LINEAR_TO_SRGB_SIZE = 4096;
+
+struct ColorTables
+{
+    float srgb_to_linear[256];
+    uint8_t linear_to_srgb[LINEAR_TO_SRGB_SIZE];
+
+    ColorTables()
+    {
+        for (int value = 0; value < 256; value++)
+        {
+            const double c = value / 255.0;
+            srgb_to_linear[value] =
+                static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+        }
+        for (int idx = 0; idx < LINEAR_TO_SRGB_SIZE; idx++)
+        {
+            const double l = static_cast<double>(idx) / (LINEAR_TO_SRGB_SIZE - 1);
+            const double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+            linear_to_srgb[idx] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.0, 1.0) * 255.0));
+        }
+    }
+};
+
+const ColorTables &GetColorTables()
+{
+    static const ColorTables tables;
+    return tables;
+}
+
+/*
+ * 通道是否按 sRGB 编码：4通道图像的第4个通道是 alpha，始终是线性的。
+*/
+bool IsSrgbChannel(bool srgb, int channelNum, int channel)
+{
+    return srgb && !(channelNum == 4 && channel == 3);
+}
+
+/*
+ * 把 8 位像素转换为 [0,1] 的线性浮点数。
+*/
+void LinearizeRow(const uint8_t *src, float *dst, size_t valueNum, int channelNum, bool srgb)
+{
+    const ColorTables &tables = GetColorTables();
+    for (size_t idx = 0; idx < valueNum; idx++)
+    {
+        const int channel = static_cast<int>(idx % channelNum);
+        dst[idx] = IsSrgbChannel(srgb, channelNum, channel) ? tables.srgb_to_linear[src[idx]] : src[idx] / 255.0f;
+    }
+}
+
+void QuantizeRow(const float *src, uint8_t *dst, size_t valueNum, int channelNum, bool srgb)
+{
+    const ColorTables &tables = GetColorTables();
+    for (size_t idx = 0; idx < valueNum; idx++)
+    {
+        const float value = std::clamp(src[idx], 0.0f, 1.0f);
+        const int channel = static_cast<int>(idx % channelNum);
+        if (IsSrgbChannel(srgb, channelNum, channel))
+            dst[idx] = tables.linear_to_srgb[static_cast<int>(value * (LINEAR_TO_SRGB_SIZE - 1) + 0.5f)];
+        else
+            dst[idx] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+    }
+}
+
+/*
+ * 由上一级的两行（row0、row1）生成下一级的一行，每个输出像素是 2x2 个输入像素的平均值。
+ * 尺寸为奇数时舍弃最后一列/行（下一级尺寸向下取整），宽度为1时重复使用唯一的一列。
+*/
+void DownsampleRow(const float *row0, const float *row1, int srcWidth, float *dst, int dstWidth, int channelNum)
+{
+    int x = 0;
+
+#ifdef MIP_USE_SSE2
+    if (srcWidth >= 2)
+    {
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        if (channelNum == 4)
+        {
+            // 一个寄存器正好是一个像素的4个通道
+            for (; x < dstWidth; x++)
+            {
+                const __m128 left = _mm_add_ps(_mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row1 + x * 8));
+                const __m128 right = _mm_add_ps(_mm_loadu_ps(row0 + x * 8 + 4), _mm_loadu_ps(row1 + x * 8 + 4));
+                _mm_storeu_ps(dst + x * 4, _mm_mul_ps(_mm_add_ps(left, right), quarter));
+            }
+        }
+        else if (channelNum == 1)
+        {
+            // 一次处理8个输入像素，分离奇偶位置后相加得到4个输出像素
+            for (; x + 4 <= dstWidth; x += 4)
+            {
+                const __m128 a = _mm_add_ps(_mm_loadu_ps(row0 + x * 2), _mm_loadu_ps(row1 + x * 2));
+                const __m128 b = _mm_add_ps(_mm_loadu_ps(row0 + x * 2 + 4), _mm_loadu_ps(row1 + x * 2 + 4));
+                const __m128 even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                const __m128 odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(dst + x, _mm_mul_ps(_mm_add_ps(even, odd), quarter));
+            }
+        }
+    }
+#endif
+
+    for (; x < dstWidth; x++)
+    {
+        const int x0 = x * 2;
+        const int x1 = std::min(x * 2 + 1, srcWidth - 1);
+        for (int c = 0; c < channelNum; c++)
+        {
+            dst[x * channelNum + c] = 0.25f * (row0[x0 * channelNum + c] + row0[x1 * channelNum + c] +
+                                               row1[x0 * channelNum + c] + row1[x1 * channelNum + c]);
+        }
+    }
+}
+
+/*
+ * 把 rowNum 行分成若干块并行处理，每块大约 PIXELS_PER_TASK 个像素；图像很小时直接在当前线程中处理。
+*/
+void ForEachRowBlock(int rowNum, int rowWidth, const std::function<void(int, int)> &func)
+{
+    const int rows_per_task = static_cast<int>(std::max<size_t>(1, PIXELS_PER_TASK / std::max(rowWidth, 1)));
+    const int task_num = (rowNum + rows_per_task - 1) / rows_per_task;
+    if (task_num <= 1)
+    {
+        func(0, rowNum);
+        return;
+    }
+
+    ThreadPool::getInstance().ParallelFor(static_cast<size_t>(task_num), [&](size_t task) {
+        const int begin = static_cast<int>(task) * rows_per_task;
+        func(begin, std::min(begin + rows_per_task, rowNum));
+    });
+}
+} // namespace
+
+int MipChainBuilder::GetLevelNum(int width, int height)
+{
+    int level_num = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2)
+        level_num++;
+    return level_num;
+}
+
+size_t MipChainBuilder::ComputeLevels(int width, int height, int channelNum, std::vector<MipLevel> &levels)
+{
+    levels.clear();
+
+    size_t total_size = 0;
+    int level_width = width, level_height = height;
+    const int level_num = GetLevelNum(width, height);
+    for (int level = 0; level < level_num; level++)
+    {
+        const size_t size = static_cast<size_t>(level_width) * level_height * channelNum;
+        levels.push_back({level_width, level_height, total_size, size});
+        total_size += size;
+
+        level_width = std::max(1, level_width / 2);
+        level_height = std::max(1, level_height / 2);
+    }
+    return total_size;
+}
+
+void MipChainBuilder::Build(const uint8_t *pixels, int width, int height, int channelNum, bool srgb, MipChain &chain)
+{
+    chain.width = width;
+    chain.height = height;
+    chain.channel_num = channelNum;
+
+    // 先计算所有级别的偏移量，一次分配全部存储
+    chain.data.resize(ComputeLevels(width, height, channelNum, chain.levels));
+    BuildInto(pixels, width, height, channelNum, srgb, chain.levels, chain.data.data());
+}
+
+void MipChainBuilder::BuildInto(const uint8_t *pixels, int width, int height, int channelNum, bool srgb,
+                                const std::vector<MipLevel> &levels, uint8_t *output)
+{
+    std::memcpy(output, pixels, levels[0].size);
+
+    const size_t level_num = levels.size();
+    if (level_num == 1)
+        return;
+
+    const size_t row_values = static_cast<size_t>(width) * channelNum;
+    std::vector<float> current(row_values * height);
+    std::vector<float> next;
+
+    ForEachRowBlock(height, width, [&](int begin, int end) {
+        for (int y = begin; y < end; y++)
+            LinearizeRow(pixels + y * row_values, current.data() + y * row_values, row_values, channelNum, srgb);
+    });
+
+    for (size_t level = 1; level < level_num; level++)
+    {
+        const MipLevel &src_level = levels[level - 1];
+        const MipLevel &dst_level = levels[level];
+        const size_t src_row_values = static_cast<size_t>(src_level.width) * channelNum;
+        const size_t dst_row_values = static_cast<size_t>(dst_level.width) * channelNum;
+
+        next.resize(dst_row_values * dst_level.height);
+        uint8_t *dst_pixels = output + dst_level.offset;
+
+        // 同一级的各行互相独立，按行分块并行；每一级依赖上一级的结果，级与级之间按顺序处理
+        ForEachRowBlock(dst_level.height, dst_level.width, [&](int begin, int end) {
+            for (int y = begin; y < end; y++)
+            {
+                const int y0 = y * 2;
+                const int y1 = std::min(y * 2 + 1, src_level.height - 1);
+                float *dst_row = next.data() + y * dst_row_values;
+
+                DownsampleRow(current.data() + y0 * src_row_values, current.data() + y1 * src_row_values,
+                              src_level.width, dst_row, dst_level.width, channelNum);
+                QuantizeRow(dst_row, dst_pixels + y * dst_row_values, dst_row_values, channelNum, srgb);
+            }
+        });
+
+        current.swap(next);
+    }
+}
+
+std::string MipChainBuilder::GetCachePath(const std::string &sourcePath)
+{
+    return sourcePath + ".mips";
+}
+
+bool MipChainBuilder::Load(const std::string &sourcePath, bool srgb, MipChain &chain, bool persist)
+{
+    MappedFile source;
+    if (!source.Open(sourcePath))
+        return false;
+
+    uint64_t source_hash = 0;
+    const std::string cache_path = GetCachePath(sourcePath);
+    if (persist)
+    {
+        source_hash = source.ComputeHash();
+        if (ReadCache(cache_path, source_hash, srgb, chain))
+            return true;
+    }
+
+    // stbi_set_flip_vertically_on_load 修改的是全局状态，这里可能在工作线程中执行，使用线程局部的版本
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    int width = 0, height = 0, channel_num = 0;
+    unsigned char *pixels = stbi_load_from_memory(source.GetData(), static_cast<int>(source.GetSize()), &width,
+                                                  &height, &channel_num, 0);
+    if (!pixels)
+        return false;
+
+    // stbi_load 对灰度+alpha图片返回2通道数据，扩展为4通道以便按RGBA上传
+    if (channel_num == 2)
+    {
+        stbi_image_free(pixels);
+        pixels = stbi_load_from_memory(source.GetData(), static_cast<int>(source.GetSize()), &width, &height,
+                                       &channel_num, 4);
+        channel_num = 4;
+        if (!pixels)
+            return false;
+    }
+
+    Build(pixels, width, height, channel_num, srgb, chain);
+    stbi_image_free(pixels);
+
+    if (persist)
+        WriteCache(cache_path, source_hash, srgb, chain);
+
+    return true;
+}
+
+bool MipChainBuilder::ReadCache(const std::string &cachePath, uint64_t sourceHash, bool srgb, MipChain &chain)
+{
+    MappedFile file;
+    if (!file.Open(cachePath))
+        return false;
+
+    const uint8_t *cur = file.GetData();
+    const uint8_t *end = cur + file.GetSize();
+
+    FileHeader header;
+    if (static_cast<size_t>(end - cur) < sizeof(header))
+        return false;
+    std::memcpy(&header, cur, sizeof(header));
+    cur += sizeof(header);
+
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != VERSION ||
+        header.source_hash != sourceHash || header.srgb != (srgb ? 1u : 0u))
+        return false;
+
+    if (header.width <= 0 || header.height <= 0 ||
+        (header.channel_num != 1 && header.channel_num != 3 && header.channel_num != 4) ||
+        static_cast<int>(header.level_num) != GetLevelNum(header.width, header.height) ||
+        static_cast<size_t>(end - cur) / sizeof(LevelHeader) < header.level_num)
+        return false;
+
+    std::vector<MipLevel> levels(header.level_num);
+    for (MipLevel &level : levels)
+    {
+        LevelHeader level_header;
+        std::memcpy(&level_header, cur, sizeof(level_header));
+        cur += sizeof(level_header);
+
+        level.width = level_header.width;
+        level.height = level_header.height;
+        level.offset = static_cast<size_t>(level_header.offset);
+        level.size = static_cast<size_t>(level_header.size);
+    }
+
+    // 每一级的数据范围都不能超出文件，且大小必须与尺寸一致，防止损坏或截断的缓存导致越界上传
+    const size_t data_size = static_cast<size_t>(end - cur);
+    for (const MipLevel &level : levels)
+    {
+        if (level.width <= 0 || level.height <= 0 || level.offset > data_size || level.size > data_size - level.offset ||
+            level.size != static_cast<size_t>(level.width) * level.height * header.channel_num)
+        {
+            std::cerr << "Mip chain cache is corrupted: " << cachePath << std::endl;
+            return false;
+        }
+    }
+
+    chain.width = header.width;
+    chain.height = header.height;
+    chain.channel_num = header.channel_num;
+    chain.levels = std::move(levels);
+    chain.data.assign(cur, end);
+
+    return true;
+}
+
+bool MipChainBuilder::WriteCache(const std::string &cachePath, uint64_t sourceHash, bool srgb, const MipChain &chain)
+{
+    // 先写入临时文件再重命名，避免写入中途失败时留下半个缓存文件
+    const std::string temp_path = cachePath + ".tmp";
+
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "Failed to create mip chain cache: " << cachePath << std::endl;
+            return false;
+        }
+
+        FileHeader header;
+        std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = VERSION;
+        header.source_hash = sourceHash;
+        header.width = chain.width;
+        header.height = chain.height;
+        header.channel_num = chain.channel_num;
+        header.level_num = static_cast<uint32_t>(chain.levels.size());
+        header.srgb = srgb ? 1 : 0;
+        header.reserved = 0;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        for (const MipLevel &level : chain.levels)
+        {
+            LevelHeader level_header;
+            level_header.width = level.width;
+            level_header.height = level.height;
+            level_header.offset = level.offset;
+            level_header.size = level.size;
+            out.write(reinterpret_cast<const char *>(&level_header), sizeof(level_header));
+        }
+
+        out.write(reinterpret_cast<const char *>(chain.data.data()), static_cast<std::streamsize>(chain.data.size()));
+
+        if (!out.good())
+        {
+            std::cerr << "Failed to write mip chain cache: " << cachePath << std::endl;
+            out.close();
+            std::error_code error;
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, cachePath, error);
+    if (error)
+    {
+        std::cerr << "Failed to write mip chain cache: " << cachePath << ", " << error.message() << std::endl;
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+
+    return true;
+}
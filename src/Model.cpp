@@ -1,19 +1,29 @@
 #include "Model.h"
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Material.h"
 #include "Shader.h"
-#include "ShaderUnit.h"
+#include "ShaderRegistry.h"
 #include "Texture2D.h"
+#include "TextureRegistry.h"
+#include "ThreadPool.h"
 #include "VertexAttribute.h"
+#include "VertexEncoder.h"
 #include "assimp/Importer.hpp"
 #include "assimp/mesh.h"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
 #include "assimp/vector3.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 
-Model::Model(const char *path)
+Model::Model(const char *path) : m_shader(nullptr), m_bounds_min(0.0f), m_bounds_max(0.0f), m_indirect_buffer(0)
 {
     LoadModel(path);
 }
@@ -24,17 +34,54 @@ Model::~Model()
         delete mesh;
     m_meshes.clear();
 
-    for (auto shader : m_shaders)
-        delete shader;
-    m_shaders.clear();
+    if (m_indirect_buffer != 0)
+    {
+        glDeleteBuffers(1, &m_indirect_buffer);
+        m_indirect_buffer = 0;
+    }
+
+    for (auto &material_pair : m_materials)
+        delete material_pair.second;
+    m_materials.clear();
+
+    ShaderRegistry::getInstance().Release(m_shader);
+    m_shader = nullptr;
 
     for (auto texture : m_textures)
-        delete texture;
+        TextureRegistry::getInstance().Release(texture);
     m_textures.clear();
 }
 
 void Model::LoadModel(const std::string &path)
 {
+    m_directory = path.substr(0, path.find_last_of('/'));
+
+    /*
+     * 所有子网格（以及所有模型）共享同一个着色器程序，灯光参数来自 LightManager 上传的 LightBlock。
+     * 模型顶点使用压缩格式上传，顶点着色器需要还原量化后的位置。
+    */
+    m_shader = ShaderRegistry::getInstance().Acquire("../shaders/vertex_08.vert", "../shaders/fragment_08.frag",
+                                                     {"QUANTIZED_POSITION"});
+    if (!m_shader)
+        return;
+
+    /*
+     * 源文件哈希与缓存文件中记录的一致时，直接使用映射到内存中的缓存数据创建网格，跳过 Assimp 解析。
+    */
+    uint64_t source_hash = 0;
+    const bool has_hash = MeshCache::HashFile(path, source_hash);
+    const std::string cache_path = MeshCache::GetCachePath(path);
+
+    if (has_hash)
+    {
+        MeshCache cache;
+        if (cache.Open(cache_path, source_hash))
+        {
+            CreateMeshes(cache.GetMeshes());
+            return;
+        }
+    }
+
     Assimp::Importer importer;
     const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
 
@@ -44,148 +91,407 @@ void Model::LoadModel(const std::string &path)
         return;
     }
 
-    m_directory = path.substr(0, path.find_last_of('/'));
+    // 按节点树的遍历顺序收集所有网格
+    std::vector<const aiMesh *> ai_meshes;
+    ProcessNode(scene->mRootNode, scene, ai_meshes);
+
+    // 在线程池中并行地把网格转换为顶点/索引数组并进行优化，这一步不涉及OpenGL调用
+    std::vector<MeshData> mesh_datas(ai_meshes.size());
+    std::vector<MeshOptimizeStats> optimize_stats(ai_meshes.size());
+    ThreadPool::getInstance().ParallelFor(ai_meshes.size(), [&](size_t idx) {
+        ConvertMesh(scene, ai_meshes[idx], mesh_datas[idx]);
+        optimize_stats[idx] = MeshOptimizer::Optimize(mesh_datas[idx].vertices, mesh_datas[idx].indices, 8);
+        GenerateLods(mesh_datas[idx]);
+    });
+
+    PrintOptimizeStats(path, optimize_stats);
+
+    std::vector<MeshView> mesh_views;
+    mesh_views.reserve(mesh_datas.size());
+    for (const MeshData &mesh_data : mesh_datas)
+    {
+        mesh_views.push_back(MeshView::FromData(mesh_data));
+    }
+    CreateMeshes(mesh_views);
+
+    // 写入缓存，下次加载时跳过 Assimp
+    if (has_hash)
+    {
+        MeshCache::Write(cache_path, source_hash, mesh_datas);
+    }
+}
+
+/*
+ * 以上一级为输入逐级简化，每一级的三角形数量减半，允许的误差逐级增大。
+ * 简化效果不明显（例如大部分顶点都在边界或接缝上）时提前停止。
+*/
+void Model::GenerateLods(MeshData &meshData)
+{
+    const unsigned int stride = 8;
+    const size_t vertex_num = meshData.vertices.size() / stride;
+    const size_t base_index_num = meshData.indices.size();
+
+    meshData.lods.clear();
+    meshData.lods.push_back({0, static_cast<uint32_t>(base_index_num), 0.0f});
+
+    std::vector<GLuint> previous = meshData.indices;
+    float previous_error = 0.0f;
+
+    for (float target_error : LOD_TARGET_ERRORS)
+    {
+        const size_t target_index_num = previous.size() / 2 / 3 * 3;
+
+        float error = 0.0f;
+        std::vector<GLuint> lod_indices =
+            MeshSimplifier::Simplify(meshData.vertices.data(), vertex_num, stride, previous.data(), previous.size(),
+                                     target_index_num, target_error, &error);
+
+        if (lod_indices.empty() || lod_indices.size() > previous.size() * 9 / 10)
+            break;
+
+        MeshOptimizer::OptimizeVertexCache(lod_indices, vertex_num);
+
+        // 每一级以上一级为输入，误差上界是逐级误差之和
+        previous_error += error;
+        meshData.lods.push_back({static_cast<uint32_t>(meshData.indices.size()),
+                                 static_cast<uint32_t>(lod_indices.size()), previous_error});
+        meshData.indices.insert(meshData.indices.end(), lod_indices.begin(), lod_indices.end());
+
+        previous.swap(lod_indices);
+    }
+}
+
+void Model::CreateMeshes(const std::vector<MeshView> &meshViews)
+{
+    // 整个模型的包围盒，LOD 的误差会换算为相对于它的比例
+    if (!meshViews.empty())
+    {
+        m_bounds_min = meshViews[0].bounds_min;
+        m_bounds_max = meshViews[0].bounds_max;
+    }
+    for (const MeshView &mesh_view : meshViews)
+    {
+        m_bounds_min = glm::min(m_bounds_min, mesh_view.bounds_min);
+        m_bounds_max = glm::max(m_bounds_max, mesh_view.bounds_max);
+    }
+
+    /*
+     * 顶点压缩只做CPU计算，在线程池中并行执行。
+     * 所有子网格使用整个模型的包围盒作为量化范围，这样合并后的顶点缓冲区只需要一组还原参数。
+    */
+    std::vector<PackedVertices> packed_vertices(meshViews.size());
+    ThreadPool::getInstance().ParallelFor(meshViews.size(), [&](size_t idx) {
+        const MeshView &mesh_view = meshViews[idx];
+        packed_vertices[idx] = VertexEncoder::EncodePosNormalTex(mesh_view.vertices, mesh_view.vertex_float_num / 8,
+                                                                 m_bounds_min, m_bounds_max);
+    });
+
+    /*
+     * 把所有子网格的顶点和索引依次拼接到同一个顶点缓冲区和索引缓冲区中。
+     * 索引保持为子网格内的局部下标，绘制时通过 base vertex 加上子网格第一个顶点的位置。
+    */
+    size_t total_vertex_num = 0, total_index_num = 0;
+    for (size_t idx = 0; idx < meshViews.size(); idx++)
+    {
+        total_vertex_num += packed_vertices[idx].vertices.size();
+        total_index_num += meshViews[idx].index_num;
+    }
+
+    std::vector<VertexPackedPNT> vertices;
+    std::vector<GLuint> indices;
+    vertices.reserve(total_vertex_num);
+    indices.reserve(total_index_num);
+
+    const float model_diagonal = glm::length(m_bounds_max - m_bounds_min);
 
-    ShaderUnit vertex_unit = ShaderUnit("../shaders/vertex_08.glsl", GL_VERTEX_SHADER);
-    ShaderUnit fragment_unit = ShaderUnit("../shaders/fragment_08.glsl", GL_FRAGMENT_SHADER);
+    for (size_t idx = 0; idx < meshViews.size(); idx++)
+    {
+        const MeshView &mesh_view = meshViews[idx];
+        const uint32_t index_base = static_cast<uint32_t>(indices.size());
+
+        SubMesh submesh;
+        submesh.base_vertex = static_cast<GLint>(vertices.size());
+        submesh.lod_index = 0;
+        submesh.material = GetOrCreateMaterial(mesh_view);
+
+        // 网格 LOD 的误差相对于网格自身的包围盒，换算为相对于整个模型的包围盒，方便统一选择
+        const float mesh_diagonal = glm::length(mesh_view.bounds_max - mesh_view.bounds_min);
+        const float error_scale = model_diagonal > 0.0f ? mesh_diagonal / model_diagonal : 0.0f;
+
+        if (mesh_view.lod_num == 0)
+            submesh.lods.push_back({index_base, static_cast<uint32_t>(mesh_view.index_num), 0.0f});
+        for (size_t lod = 0; lod < mesh_view.lod_num; lod++)
+        {
+            MeshLod mesh_lod = mesh_view.lods[lod];
+            mesh_lod.index_offset += index_base;
+            mesh_lod.error *= error_scale;
+            submesh.lods.push_back(mesh_lod);
+        }
+
+        vertices.insert(vertices.end(), packed_vertices[idx].vertices.begin(), packed_vertices[idx].vertices.end());
+        indices.insert(indices.end(), mesh_view.indices, mesh_view.indices + mesh_view.index_num);
 
-    ProcessNode(scene->mRootNode, scene, vertex_unit, fragment_unit);
+        m_submeshes.push_back(std::move(submesh));
+    }
+
+    if (m_submeshes.empty())
+        return;
+
+    // 只有创建 VBO/EBO 以及材质的部分留在OpenGL线程中执行
+    Mesh *mesh = new Mesh(static_cast<const void *>(vertices.data()), vertices.size() * sizeof(VertexPackedPNT),
+                          indices.data(), indices.size(), VertexAttributePresets::GetPackedPosNormalTexLayout(),
+                          m_shader);
+    mesh->SetPositionDequantization(packed_vertices[0].position_scale, packed_vertices[0].position_offset);
+    m_meshes.push_back(mesh);
+
+    // 使用相同材质的子网格放在同一组中，一次调用绘制完成
+    for (size_t idx = 0; idx < m_submeshes.size(); idx++)
+    {
+        auto iter = std::find_if(m_draw_groups.begin(), m_draw_groups.end(),
+                                 [&](const DrawGroup &group) { return group.material == m_submeshes[idx].material; });
+        if (iter == m_draw_groups.end())
+        {
+            m_draw_groups.push_back({m_submeshes[idx].material, {}, 0});
+            iter = m_draw_groups.end() - 1;
+        }
+        iter->submeshes.push_back(idx);
+    }
+
+    /*
+     * OpenGL 4.3 起可以用 glMultiDrawElementsIndirect 从缓冲区中读取绘制参数，
+     * 否则退回到 glMultiDrawElementsBaseVertex，每帧从CPU传入参数数组。
+    */
+    if (GLAD_GL_VERSION_4_3)
+        glGenBuffers(1, &m_indirect_buffer);
+
+    UpdateDrawCommands();
 }
 
-void Model::ProcessNode(aiNode *node, const aiScene *scene, ShaderUnit &vertexUnit, ShaderUnit &fragmentUnit)
+/*
+ * 按分组顺序生成每个子网格当前 LOD 的绘制参数，LOD 改变后需要重新生成。
+*/
+void Model::UpdateDrawCommands()
 {
-    // 处理节点的每个网格
+    m_draw_counts.clear();
+    m_draw_offsets.clear();
+    m_draw_base_vertices.clear();
+    m_draw_commands.clear();
+
+    for (DrawGroup &group : m_draw_groups)
+    {
+        group.command_offset = m_draw_counts.size();
+
+        for (size_t submesh_idx : group.submeshes)
+        {
+            const SubMesh &submesh = m_submeshes[submesh_idx];
+            const MeshLod &lod = submesh.lods[submesh.lod_index];
+
+            m_draw_counts.push_back(static_cast<GLsizei>(lod.index_num));
+            m_draw_offsets.push_back(
+                reinterpret_cast<const void *>(static_cast<uintptr_t>(lod.index_offset) * sizeof(GLuint)));
+            m_draw_base_vertices.push_back(submesh.base_vertex);
+            m_draw_commands.push_back({lod.index_num, 1, lod.index_offset, submesh.base_vertex, 0});
+        }
+    }
+
+    if (m_indirect_buffer != 0)
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect_buffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                     static_cast<GLsizeiptr>(m_draw_commands.size() * sizeof(DrawElementsIndirectCommand)),
+                     m_draw_commands.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+}
+
+/*
+ * 按三角形数量加权，汇总所有子网格优化前后的顶点数和 ACMR。
+*/
+void Model::PrintOptimizeStats(const std::string &path, const std::vector<MeshOptimizeStats> &stats)
+{
+    size_t vertex_num_before = 0, vertex_num_after = 0, triangle_num = 0;
+    double misses_before = 0.0, misses_after = 0.0;
+
+    for (size_t idx = 0; idx < stats.size(); idx++)
+    {
+        const size_t mesh_triangle_num = stats[idx].triangle_num;
+        vertex_num_before += stats[idx].vertex_num_before;
+        vertex_num_after += stats[idx].vertex_num_after;
+        misses_before += stats[idx].acmr_before * mesh_triangle_num;
+        misses_after += stats[idx].acmr_after * mesh_triangle_num;
+        triangle_num += mesh_triangle_num;
+    }
+
+    if (triangle_num == 0)
+        return;
+
+    std::cout << "Model " << path << ": vertices " << vertex_num_before << " -> " << vertex_num_after << ", ACMR "
+              << misses_before / triangle_num << " -> " << misses_after / triangle_num << std::endl;
+}
+
+void Model::ProcessNode(const aiNode *node, const aiScene *scene, std::vector<const aiMesh *> &meshes)
+{
+    // 收集节点的每个网格
     for (unsigned int idx = 0; idx < node->mNumMeshes; idx++)
     {
-        aiMesh *aiMesh = scene->mMeshes[node->mMeshes[idx]];
-        ProcessMesh(aiMesh, scene, vertexUnit, fragmentUnit);
+        meshes.push_back(scene->mMeshes[node->mMeshes[idx]]);
     }
 
     // 处理子节点
     for (unsigned int idx = 0; idx < node->mNumChildren; idx++)
     {
-        ProcessNode(node->mChildren[idx], scene, vertexUnit, fragmentUnit);
+        ProcessNode(node->mChildren[idx], scene, meshes);
     }
 }
 
-Mesh *Model::ProcessMesh(aiMesh *mesh, const aiScene *scene, ShaderUnit &vertexUnit, ShaderUnit &fragmentUnit)
+/*
+ * 将Assimp网格转换为交错排列的顶点数组和索引数组。
+ * 只读取 aiMesh 的数据且不调用任何gl函数，因此可以在工作线程中并行执行。
+*/
+void Model::ConvertMesh(const aiScene *scene, const aiMesh *mesh, MeshData &meshData)
 {
-    std::vector<GLfloat> vertices;
+    const unsigned int stride = 8; // 位置(3) + 法线(3) + 纹理坐标(2)
 
-    // 顶点列表
-    for (unsigned int idx = 0; idx < mesh->mNumVertices; idx++)
+    // 顶点列表，预先分配好空间后直接写入，避免逐个 push_back 带来的反复扩容
+    meshData.vertices.resize(static_cast<size_t>(mesh->mNumVertices) * stride);
+
+    glm::vec3 bounds_min(std::numeric_limits<float>::max());
+    glm::vec3 bounds_max(std::numeric_limits<float>::lowest());
+
+    const aiVector3D *tex_coords = mesh->mTextureCoords[0];
+    GLfloat *dst = meshData.vertices.data();
+    for (unsigned int idx = 0; idx < mesh->mNumVertices; idx++, dst += stride)
     {
         // 位置
-        aiVector3D position = mesh->mVertices[idx];
-        vertices.push_back(position.x);
-        vertices.push_back(position.y);
-        vertices.push_back(position.z);
+        const aiVector3D &position = mesh->mVertices[idx];
+        dst[0] = position.x;
+        dst[1] = position.y;
+        dst[2] = position.z;
+
+        bounds_min = glm::min(bounds_min, glm::vec3(position.x, position.y, position.z));
+        bounds_max = glm::max(bounds_max, glm::vec3(position.x, position.y, position.z));
 
         // 法线
-        aiVector3D normal = mesh->mNormals[idx];
-        vertices.push_back(normal.x);
-        vertices.push_back(normal.y);
-        vertices.push_back(normal.z);
+        if (mesh->mNormals)
+        {
+            const aiVector3D &normal = mesh->mNormals[idx];
+            dst[3] = normal.x;
+            dst[4] = normal.y;
+            dst[5] = normal.z;
+        }
+        else
+        {
+            dst[3] = 0.0f;
+            dst[4] = 0.0f;
+            dst[5] = 0.0f;
+        }
 
         // 纹理坐标
-        if (mesh->mTextureCoords[0])
+        if (tex_coords)
         {
-            aiVector3D texCoord = mesh->mTextureCoords[0][idx];
-            vertices.push_back(texCoord.x);
-            vertices.push_back(texCoord.y);
+            dst[6] = tex_coords[idx].x;
+            dst[7] = tex_coords[idx].y;
         }
         else
         {
-            vertices.push_back(0.0f);
-            vertices.push_back(0.0f);
+            dst[6] = 0.0f;
+            dst[7] = 0.0f;
         }
     }
 
-    std::vector<GLuint> indices;
-
     // 索引列表
+    size_t index_num = 0;
     for (unsigned int idx = 0; idx < mesh->mNumFaces; idx++)
     {
-        aiFace face = mesh->mFaces[idx];
+        index_num += mesh->mFaces[idx].mNumIndices;
+    }
+
+    meshData.indices.resize(index_num);
+
+    GLuint *index_dst = meshData.indices.data();
+    for (unsigned int idx = 0; idx < mesh->mNumFaces; idx++)
+    {
+        const aiFace &face = mesh->mFaces[idx];
         for (unsigned int idx2 = 0; idx2 < face.mNumIndices; idx2++)
         {
-            indices.push_back(face.mIndices[idx2]);
+            *index_dst++ = face.mIndices[idx2];
         }
     }
 
-    Shader *shader = new Shader(vertexUnit, fragmentUnit);
-    m_shaders.push_back(shader);
+    if (mesh->mNumVertices > 0)
+    {
+        meshData.bounds_min = bounds_min;
+        meshData.bounds_max = bounds_max;
+    }
 
-    // 材质
-    if (mesh->mMaterialIndex >= 0)
+    // 材质引用的纹理路径
+    meshData.material_index = mesh->mMaterialIndex;
+    if (mesh->mMaterialIndex < scene->mNumMaterials)
     {
-        aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+        const aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+        CollectTexturePaths(material, aiTextureType_DIFFUSE, meshData.material.diffuse_textures);
+        CollectTexturePaths(material, aiTextureType_SPECULAR, meshData.material.specular_textures);
+    }
+}
 
-        std::vector<Texture2D *> diffuse_textures = LoadMaterialTextures(material, aiTextureType_DIFFUSE);
-        std::vector<Texture2D *> specular_textures = LoadMaterialTextures(material, aiTextureType_SPECULAR);
+/*
+ * 引用同一个 aiMaterial 的子网格共享同一个材质对象。
+*/
+Material *Model::GetOrCreateMaterial(const MeshView &meshView)
+{
+    auto iter = m_materials.find(meshView.material_index);
+    if (iter != m_materials.end())
+        return iter->second;
 
-        if (!diffuse_textures.empty())
-            shader->SetTexture("material.diffuse", diffuse_textures[0]);
-        else
-            shader->SetTexture("material.diffuse", Texture2D::GetWhite2DTexture());
+    Material *material = new Material(m_shader);
 
-        if (!specular_textures.empty())
-            shader->SetTexture("material.specular", specular_textures[0]);
-        else
-            shader->SetTexture("material.specular", Texture2D::GetWhite2DTexture());
-    }
-    else
-    {
-        shader->SetTexture("material.diffuse", Texture2D::GetWhite2DTexture());
-        shader->SetTexture("material.specular", Texture2D::GetWhite2DTexture());
-    }
-    shader->SetFloat("material.shininess", 64.0f);
+    // 漫反射贴图按颜色压缩（BC1/BC3），高光贴图只用到亮度，按灰度压缩（BC4）
+    std::vector<Texture2D *> diffuse_textures =
+        LoadMaterialTextures(meshView.material->diffuse_textures, TextureCompression::Color);
+    std::vector<Texture2D *> specular_textures =
+        LoadMaterialTextures(meshView.material->specular_textures, TextureCompression::Grayscale);
 
-    // 方向光属性
-    shader->SetVec3f("dirLight.direction", glm::vec3(-0.0f, -0.0f, -5.0f));
-    shader->SetVec3f("dirLight.ambient", glm::vec3(0.2f, 0.2f, 0.2f));
-    shader->SetVec3f("dirLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-    shader->SetVec3f("dirLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
+    if (!diffuse_textures.empty())
+        material->SetTexture("material.diffuse", diffuse_textures[0]);
+    else
+        material->SetTexture("material.diffuse", Texture2D::GetWhite2DTexture());
 
-    // 点光源属性
-    shader->SetVec3f("pointLight.position", glm::vec3(0.0f, 0.0f, 3.0f));
-    shader->SetFloat("pointLight.constant", 1.0f);
-    shader->SetFloat("pointLight.linear", 0.045f);
-    shader->SetFloat("pointLight.quadratic", 0.0075f);
-    shader->SetVec3f("pointLight.ambient", glm::vec3(0.2f, 0.2f, 0.2f));
-    shader->SetVec3f("pointLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-    shader->SetVec3f("pointLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
+    if (!specular_textures.empty())
+        material->SetTexture("material.specular", specular_textures[0]);
+    else
+        material->SetTexture("material.specular", Texture2D::GetWhite2DTexture());
 
-    // 聚光灯属性
-    shader->SetVec3f("spotLight.position", glm::vec3(0.0f, 0.0f, 5.0f));
-    shader->SetVec3f("spotLight.direction", glm::vec3(0.0f, 0.0f, -1.0f));
-    shader->SetFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-    shader->SetFloat("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
-    shader->SetFloat("spotLight.constant", 1.0f);
-    shader->SetFloat("spotLight.linear", 0.045f);
-    shader->SetFloat("spotLight.quadratic", 0.0075f);
-    shader->SetVec3f("spotLight.ambient", glm::vec3(0.2f, 0.2f, 0.2f));
-    shader->SetVec3f("spotLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-    shader->SetVec3f("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
+    material->SetFloat("material.shininess", 64.0f);
 
-    Mesh *new_mesh = new Mesh(vertices, indices, VertexAttributePresets::GetPosNormalTexLayout(), shader);
-    m_meshes.push_back(new_mesh);
+    m_materials.emplace(meshView.material_index, material);
 
-    return new_mesh;
+    return material;
 }
 
-std::vector<Texture2D *> Model::LoadMaterialTextures(const aiMaterial *mat, const aiTextureType type)
+void Model::CollectTexturePaths(const aiMaterial *mat, const aiTextureType type, std::vector<std::string> &paths)
 {
-    std::vector<Texture2D *> textures;
-
     unsigned int count = mat->GetTextureCount(type);
     for (unsigned int idx = 0; idx < count; idx++)
     {
         aiString str;
         mat->GetTexture(type, idx, &str);
+        paths.push_back(str.C_Str());
+    }
+}
+
+std::vector<Texture2D *> Model::LoadMaterialTextures(const std::vector<std::string> &paths,
+                                                     TextureCompression compression)
+{
+    std::vector<Texture2D *> textures;
 
-        const std::string &file_path = m_directory + '/' + str.C_Str();
-        Texture2D *texture = new Texture2D(file_path.c_str());
+    for (const std::string &path : paths)
+    {
+        const std::string &file_path = m_directory + '/' + path;
+        // 模型贴图数量多、体积大，异步烘焙为块压缩格式后分帧上传，避免阻塞主线程；只有颜色贴图是 sRGB 编码的
+        Texture2D *texture = TextureRegistry::getInstance().Acquire(file_path, 0, GL_REPEAT, true, compression,
+                                                                    compression == TextureCompression::Color);
+        if (!texture)
+            continue;
 
         m_textures.push_back(texture);
         textures.push_back(texture);
@@ -204,13 +510,81 @@ void Model::ForeachMesh(std::function<void(Mesh *)> func) const
 
 void Model::Draw() const
 {
-    for (auto mesh : m_meshes)
+    if (m_meshes.empty() || !m_shader || !m_shader->IsValidProgram())
+        return;
+
+    const Mesh *mesh = m_meshes[0];
+    mesh->SetQuantizationUniforms();
+
+    // 每个材质组只需要绑定一次材质，组内所有子网格在一次调用中绘制
+    for (const DrawGroup &group : m_draw_groups)
+    {
+        if (group.material)
+            group.material->Use();
+        else
+            m_shader->Use();
+
+        const GLsizei draw_num = static_cast<GLsizei>(group.submeshes.size());
+        if (m_indirect_buffer != 0)
+        {
+            mesh->MultiDrawIndirect(m_indirect_buffer, group.command_offset * sizeof(DrawElementsIndirectCommand),
+                                    draw_num);
+        }
+        else
+        {
+            mesh->MultiDraw(m_draw_counts.data() + group.command_offset,
+                            m_draw_offsets.data() + group.command_offset,
+                            m_draw_base_vertices.data() + group.command_offset, draw_num);
+        }
+    }
+}
+
+void Model::GetBoundingBox(glm::vec3 &boundsMin, glm::vec3 &boundsMax) const
+{
+    boundsMin = m_bounds_min;
+    boundsMax = m_bounds_max;
+}
+
+void Model::GetBoundingSphere(glm::vec3 &center, float &radius) const
+{
+    center = (m_bounds_min + m_bounds_max) * 0.5f;
+    radius = glm::length(m_bounds_max - m_bounds_min) * 0.5f;
+}
+
+void Model::SelectLod(float screenSize)
+{
+    /*
+     * 简化误差投影到屏幕上的大小 = 相对误差 * 包围球在屏幕上的大小，
+     * 为每个网格选择投影误差不超过 LOD_SCREEN_ERROR 的最粗糙一级。
+    */
+    bool changed = false;
+    for (SubMesh &submesh : m_submeshes)
     {
-        mesh->Draw();
+        size_t lod_index = 0;
+        for (size_t idx = 1; idx < submesh.lods.size(); idx++)
+        {
+            if (submesh.lods[idx].error * screenSize > LOD_SCREEN_ERROR)
+                break;
+            lod_index = idx;
+        }
+
+        if (submesh.lod_index != lod_index)
+        {
+            submesh.lod_index = lod_index;
+            changed = true;
+        }
     }
+
+    if (changed)
+        UpdateDrawCommands();
 }
 
 bool Model::HasValidMesh() const
 {
     return !m_meshes.empty();
+}
+
+Shader *Model::GetShader() const
+{
+    return m_shader;
 }
\ No newline at end of file
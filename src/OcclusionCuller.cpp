@@ -0,0 +1,396 @@
+#include "OcclusionCuller.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define OCCLUSION_CULLER_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+constexpr uint32_t SIMD_WIDTH = 4;
+
+// 选择金字塔层级时，包围盒在该层覆盖的最大像素数（每个方向）
+constexpr uint32_t MAX_TEST_TEXELS = 4;
+
+// 屏幕空间面积小于该值的三角形不覆盖任何像素中心或无法可靠计算深度平面，直接丢弃
+constexpr float MIN_TRIANGLE_AREA = 1e-8f;
+} // namespace
+
+OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height) : m_view_projection(1.0f), m_simd_enabled(true)
+{
+    m_tile_x_num = std::max(1u, (width + TILE_WIDTH - 1) / TILE_WIDTH);
+    m_tile_y_num = std::max(1u, (height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+    m_width = m_tile_x_num * TILE_WIDTH;
+    m_height = m_tile_y_num * TILE_HEIGHT;
+
+    m_tile_bins.resize(m_tile_x_num * m_tile_y_num);
+
+    glm::uvec2 size(m_width, m_height);
+    while (true)
+    {
+        m_level_sizes.push_back(size);
+        m_levels.emplace_back(size.x * size.y, 1.0f);
+        if (size.x == 1 && size.y == 1)
+            break;
+
+        size = glm::max(glm::uvec2(1), (size + 1u) / 2u);
+    }
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+void OcclusionCuller::Begin(const glm::mat4 &viewProjection)
+{
+    m_view_projection = viewProjection;
+    m_triangles.clear();
+    std::fill(m_levels[0].begin(), m_levels[0].end(), 1.0f);
+}
+
+void OcclusionCuller::AddOccluder(const glm::vec3 *positions, size_t vertexNum, const uint32_t *indices,
+                                  size_t indexNum, const glm::mat4 &model)
+{
+    const glm::mat4 mvp = m_view_projection * model;
+    const glm::vec2 screen_size(static_cast<float>(m_width), static_cast<float>(m_height));
+
+    for (size_t idx = 0; idx + 2 < indexNum; idx += 3)
+    {
+        glm::vec3 vertices[3];
+        bool clipped = false;
+        for (int corner = 0; corner < 3 && !clipped; corner++)
+        {
+            const uint32_t vertex_idx = indices[idx + corner];
+            if (vertex_idx >= vertexNum)
+            {
+                clipped = true;
+                break;
+            }
+
+            // 跨过近平面的三角形需要裁剪，直接丢弃只会少遮挡
+            const glm::vec4 clip = mvp * glm::vec4(positions[vertex_idx], 1.0f);
+            if (clip.w <= 0.0f || clip.z < -clip.w)
+            {
+                clipped = true;
+                break;
+            }
+
+            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            vertices[corner] = glm::vec3((glm::vec2(ndc) * 0.5f + 0.5f) * screen_size, ndc.z * 0.5f + 0.5f);
+        }
+        if (clipped)
+            continue;
+
+        // 正反面都光栅化，统一为逆时针
+        float area = (vertices[1].x - vertices[0].x) * (vertices[2].y - vertices[0].y) -
+                     (vertices[1].y - vertices[0].y) * (vertices[2].x - vertices[0].x);
+        // 顶点坐标溢出为无穷大时面积为 NaN，同样丢弃
+        if (!(std::fabs(area) >= MIN_TRIANGLE_AREA))
+            continue;
+        if (area < 0.0f)
+        {
+            std::swap(vertices[1], vertices[2]);
+            area = -area;
+        }
+
+        // 覆盖的像素：像素中心 (x + 0.5) 在三角形包围盒内
+        const glm::vec3 bounds_min = glm::min(glm::min(vertices[0], vertices[1]), vertices[2]);
+        const glm::vec3 bounds_max = glm::max(glm::max(vertices[0], vertices[1]), vertices[2]);
+
+        /*
+         * 完全在屏幕外的三角形直接丢弃。w 很小时坐标可能远远超出 int32 的范围，
+         * 必须先限制在屏幕内再转换为整数，否则转换是未定义行为。
+        */
+        if (bounds_max.x < 0.5f || bounds_max.y < 0.5f || bounds_min.x > screen_size.x - 0.5f ||
+            bounds_min.y > screen_size.y - 0.5f)
+            continue;
+
+        Triangle triangle;
+        triangle.min_x = static_cast<int32_t>(std::clamp(std::ceil(bounds_min.x - 0.5f), 0.0f, screen_size.x - 1.0f));
+        triangle.min_y = static_cast<int32_t>(std::clamp(std::ceil(bounds_min.y - 0.5f), 0.0f, screen_size.y - 1.0f));
+        triangle.max_x = static_cast<int32_t>(std::clamp(std::floor(bounds_max.x - 0.5f), 0.0f, screen_size.x - 1.0f));
+        triangle.max_y = static_cast<int32_t>(std::clamp(std::floor(bounds_max.y - 0.5f), 0.0f, screen_size.y - 1.0f));
+        if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y)
+            continue;
+
+        /*
+         * 第 i 条边从顶点 i 指向顶点 i + 1，逆时针三角形内部在每条边的左侧，边函数为正。
+         * 对边的边函数除以面积就是顶点的重心坐标，深度平面由重心坐标插值得到。
+         * 系数总是按两个端点中较小的一个作为起点计算，方向相反时整体取负，
+         * 这样相邻三角形在公共边上的边函数恰好互为相反数，不会因为舍入误差在公共边上留下空洞。
+        */
+        for (int edge = 0; edge < 3; edge++)
+        {
+            glm::vec2 from(vertices[edge]);
+            glm::vec2 to(vertices[(edge + 1) % 3]);
+            float sign = 1.0f;
+            if (from.x > to.x || (from.x == to.x && from.y > to.y))
+            {
+                std::swap(from, to);
+                sign = -1.0f;
+            }
+
+            const float a = from.y - to.y;
+            const float b = to.x - from.x;
+            triangle.edge_a[edge] = sign * a;
+            triangle.edge_b[edge] = sign * b;
+            triangle.edge_c[edge] = sign * -(a * from.x + b * from.y);
+        }
+
+        // 顶点 i 的权重来自它对边（第 i + 1 条边）的边函数
+        const glm::vec3 depths(vertices[2].z, vertices[0].z, vertices[1].z);
+        triangle.depth_plane.x = glm::dot(triangle.edge_a, depths) / area;
+        triangle.depth_plane.y = glm::dot(triangle.edge_b, depths) / area;
+        triangle.depth_plane.z = glm::dot(triangle.edge_c, depths) / area;
+
+        m_triangles.push_back(triangle);
+    }
+}
+
+void OcclusionCuller::BinTriangles()
+{
+    for (std::vector<uint32_t> &bin : m_tile_bins)
+    {
+        bin.clear();
+    }
+
+    for (size_t idx = 0; idx < m_triangles.size(); idx++)
+    {
+        const Triangle &triangle = m_triangles[idx];
+        const uint32_t tile_min_x = triangle.min_x / TILE_WIDTH;
+        const uint32_t tile_max_x = triangle.max_x / TILE_WIDTH;
+        const uint32_t tile_min_y = triangle.min_y / TILE_HEIGHT;
+        const uint32_t tile_max_y = triangle.max_y / TILE_HEIGHT;
+
+        for (uint32_t tile_y = tile_min_y; tile_y <= tile_max_y; tile_y++)
+        {
+            for (uint32_t tile_x = tile_min_x; tile_x <= tile_max_x; tile_x++)
+            {
+                m_tile_bins[tile_y * m_tile_x_num + tile_x].push_back(static_cast<uint32_t>(idx));
+            }
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeTriangleScalar(const Triangle &triangle, uint32_t tileX, uint32_t tileY)
+{
+    const int32_t min_x = std::max<int32_t>(triangle.min_x, tileX * TILE_WIDTH);
+    const int32_t max_x = std::min<int32_t>(triangle.max_x, (tileX + 1) * TILE_WIDTH - 1);
+    const int32_t min_y = std::max<int32_t>(triangle.min_y, tileY * TILE_HEIGHT);
+    const int32_t max_y = std::min<int32_t>(triangle.max_y, (tileY + 1) * TILE_HEIGHT - 1);
+
+    float *depth_buffer = m_levels[0].data();
+    for (int32_t y = min_y; y <= max_y; y++)
+    {
+        const float py = static_cast<float>(y) + 0.5f;
+        float *row = depth_buffer + static_cast<size_t>(y) * m_width;
+        for (int32_t x = min_x; x <= max_x; x++)
+        {
+            const float px = static_cast<float>(x) + 0.5f;
+            const glm::vec3 edges = triangle.edge_a * px + (triangle.edge_b * py + triangle.edge_c);
+            if (edges.x < 0.0f || edges.y < 0.0f || edges.z < 0.0f)
+                continue;
+
+            const float depth = triangle.depth_plane.x * px + (triangle.depth_plane.y * py + triangle.depth_plane.z);
+            row[x] = std::min(row[x], depth);
+        }
+    }
+}
+
+#ifdef OCCLUSION_CULLER_SSE
+void OcclusionCuller::RasterizeTriangleSimd(const Triangle &triangle, uint32_t tileX, uint32_t tileY)
+{
+    // 图块宽度是4的倍数，把起点向下对齐到4后每次处理4个像素，多出的像素由边函数排除
+    const int32_t align_mask = ~static_cast<int32_t>(SIMD_WIDTH - 1);
+    const int32_t min_x = std::max<int32_t>(triangle.min_x, tileX * TILE_WIDTH) & align_mask;
+    const int32_t max_x = std::min<int32_t>(triangle.max_x, (tileX + 1) * TILE_WIDTH - 1);
+    const int32_t min_y = std::max<int32_t>(triangle.min_y, tileY * TILE_HEIGHT);
+    const int32_t max_y = std::min<int32_t>(triangle.max_y, (tileY + 1) * TILE_HEIGHT - 1);
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 lane_offset = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+    __m128 edge_a[3];
+    for (int edge = 0; edge < 3; edge++)
+    {
+        edge_a[edge] = _mm_set1_ps(triangle.edge_a[edge]);
+    }
+    const __m128 depth_a = _mm_set1_ps(triangle.depth_plane.x);
+
+    float *depth_buffer = m_levels[0].data();
+    for (int32_t y = min_y; y <= max_y; y++)
+    {
+        const float py = static_cast<float>(y) + 0.5f;
+        float *row = depth_buffer + static_cast<size_t>(y) * m_width;
+
+        // 与 y 有关的部分每行计算一次；边函数每次直接计算而不是累加步长，与标量实现的结果完全相同
+        __m128 edge_row[3];
+        for (int edge = 0; edge < 3; edge++)
+        {
+            edge_row[edge] = _mm_set1_ps(triangle.edge_b[edge] * py + triangle.edge_c[edge]);
+        }
+        const __m128 depth_row = _mm_set1_ps(triangle.depth_plane.y * py + triangle.depth_plane.z);
+
+        for (int32_t x = min_x; x <= max_x; x += SIMD_WIDTH)
+        {
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_offset);
+
+            __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[0], px), edge_row[0]), zero);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[1], px), edge_row[1]), zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_a[2], px), edge_row[2]), zero));
+
+            if (_mm_movemask_ps(inside) != 0)
+            {
+                const __m128 depth = _mm_add_ps(_mm_mul_ps(depth_a, px), depth_row);
+                const __m128 old_depth = _mm_loadu_ps(row + x);
+                const __m128 new_depth = _mm_min_ps(old_depth, depth);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_depth), _mm_andnot_ps(inside, old_depth)));
+            }
+        }
+    }
+}
+#else
+void OcclusionCuller::RasterizeTriangleSimd(const Triangle &triangle, uint32_t tileX, uint32_t tileY)
+{
+    RasterizeTriangleScalar(triangle, tileX, tileY);
+}
+#endif
+
+void OcclusionCuller::RasterizeTile(uint32_t tileIdx)
+{
+    const uint32_t tile_x = tileIdx % m_tile_x_num;
+    const uint32_t tile_y = tileIdx / m_tile_x_num;
+
+    // 每个图块只写自己范围内的像素，不同图块之间不需要同步
+    for (uint32_t triangle_idx : m_tile_bins[tileIdx])
+    {
+        if (m_simd_enabled)
+            RasterizeTriangleSimd(m_triangles[triangle_idx], tile_x, tile_y);
+        else
+            RasterizeTriangleScalar(m_triangles[triangle_idx], tile_x, tile_y);
+    }
+}
+
+void OcclusionCuller::Rasterize()
+{
+    BinTriangles();
+
+    if (!m_triangles.empty())
+    {
+        ThreadPool::getInstance().ParallelFor(m_tile_bins.size(), [this](size_t tileIdx) {
+            RasterizeTile(static_cast<uint32_t>(tileIdx));
+        });
+    }
+
+    BuildPyramid();
+}
+
+void OcclusionCuller::BuildPyramid()
+{
+    for (size_t level = 1; level < m_levels.size(); level++)
+    {
+        const glm::uvec2 src_size = m_level_sizes[level - 1];
+        const glm::uvec2 dst_size = m_level_sizes[level];
+        const float *src = m_levels[level - 1].data();
+        float *dst = m_levels[level].data();
+
+        // 每个像素取上一级对应的2x2个像素中最远的深度，宽高为奇数时边缘只取存在的像素
+        for (uint32_t y = 0; y < dst_size.y; y++)
+        {
+            const uint32_t y0 = y * 2;
+            const uint32_t y1 = std::min(y0 + 1, src_size.y - 1);
+            for (uint32_t x = 0; x < dst_size.x; x++)
+            {
+                const uint32_t x0 = x * 2;
+                const uint32_t x1 = std::min(x0 + 1, src_size.x - 1);
+                dst[y * dst_size.x + x] = std::max(std::max(src[y0 * src_size.x + x0], src[y0 * src_size.x + x1]),
+                                                   std::max(src[y1 * src_size.x + x0], src[y1 * src_size.x + x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) const
+{
+    const glm::vec2 screen_size(static_cast<float>(m_width), static_cast<float>(m_height));
+
+    glm::vec2 screen_min(std::numeric_limits<float>::max());
+    glm::vec2 screen_max(std::numeric_limits<float>::lowest());
+    float nearest_depth = 1.0f;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        const glm::vec3 position((corner & 1) ? boundsMax.x : boundsMin.x, (corner & 2) ? boundsMax.y : boundsMin.y,
+                                 (corner & 4) ? boundsMax.z : boundsMin.z);
+
+        // 跨过近平面的包围盒无法可靠地投影，视为可见
+        const glm::vec4 clip = m_view_projection * glm::vec4(position, 1.0f);
+        if (clip.w <= 0.0f || clip.z < -clip.w)
+            return true;
+
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        const glm::vec2 screen = (glm::vec2(ndc) * 0.5f + 0.5f) * screen_size;
+        screen_min = glm::min(screen_min, screen);
+        screen_max = glm::max(screen_max, screen);
+        nearest_depth = std::min(nearest_depth, ndc.z * 0.5f + 0.5f);
+    }
+
+    // 完全在屏幕外的包围盒交给视锥体剔除处理
+    if (screen_max.x < 0.0f || screen_max.y < 0.0f || screen_min.x >= screen_size.x || screen_min.y >= screen_size.y)
+        return true;
+
+    // 包围盒接触到的所有像素
+    const glm::vec2 clamped_min = glm::clamp(glm::floor(screen_min), glm::vec2(0.0f), screen_size - 1.0f);
+    const glm::vec2 clamped_max = glm::clamp(glm::floor(screen_max), glm::vec2(0.0f), screen_size - 1.0f);
+    const glm::uvec2 pixel_min(clamped_min);
+    const glm::uvec2 pixel_max(clamped_max);
+
+    // 选择包围盒覆盖不超过 MAX_TEST_TEXELS x MAX_TEST_TEXELS 个像素的层级，该层每个像素是下面所有像素的最远深度
+    size_t level = 0;
+    while (level + 1 < m_levels.size() && ((pixel_max.x >> level) - (pixel_min.x >> level) + 1 > MAX_TEST_TEXELS ||
+                                           (pixel_max.y >> level) - (pixel_min.y >> level) + 1 > MAX_TEST_TEXELS))
+    {
+        level++;
+    }
+
+    const glm::uvec2 level_size = m_level_sizes[level];
+    const float *depths = m_levels[level].data();
+    float farthest_occluder = 0.0f;
+    for (uint32_t y = pixel_min.y >> level; y <= (pixel_max.y >> level); y++)
+    {
+        for (uint32_t x = pixel_min.x >> level; x <= (pixel_max.x >> level); x++)
+        {
+            farthest_occluder = std::max(farthest_occluder, depths[y * level_size.x + x]);
+        }
+    }
+
+    return nearest_depth <= farthest_occluder;
+}
+
+void OcclusionCuller::SetSimdEnabled(bool enabled)
+{
+    m_simd_enabled = enabled;
+}
+
+uint32_t OcclusionCuller::GetWidth() const
+{
+    return m_width;
+}
+
+uint32_t OcclusionCuller::GetHeight() const
+{
+    return m_height;
+}
+
+const float *OcclusionCuller::GetDepthBuffer() const
+{
+    return m_levels[0].data();
+}
+
+size_t OcclusionCuller::GetOccluderTriangleNum() const
+{
+    return m_triangles.size();
+}
@@ -1,9 +1,12 @@
 #include "PointLight.h"
 #include "BaseLight.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 PointLight::PointLight(const glm::vec3 &position, const GLfloat linear, const GLfloat quadratic,
                        const glm::vec3 &ambient, const glm::vec3 &diffuse, const glm::vec3 &specular,
-                       const GLfloat constant = 1.0f)
+                       const GLfloat constant)
     : BaseLight(ambient, diffuse, specular), m_position(position), m_constant(constant), m_linear(linear),
       m_quadratic(quadratic)
 {
@@ -11,4 +14,55 @@ PointLight::PointLight(const glm::vec3 &position, const GLfloat linear, const GL
 
 PointLight::~PointLight()
 {
-}
\ No newline at end of file
+}
+
+LightType PointLight::GetType() const
+{
+    return LightType::Point;
+}
+
+const glm::vec3 &PointLight::GetPosition() const
+{
+    return m_position;
+}
+
+void PointLight::SetPosition(const glm::vec3 &position)
+{
+    m_position = position;
+}
+
+GLfloat PointLight::GetConstant() const
+{
+    return m_constant;
+}
+
+GLfloat PointLight::GetLinear() const
+{
+    return m_linear;
+}
+
+GLfloat PointLight::GetQuadratic() const
+{
+    return m_quadratic;
+}
+
+GLfloat PointLight::GetRange(const GLfloat threshold) const
+{
+    const glm::vec3 brightest = glm::max(m_ambient, glm::max(m_diffuse, m_specular));
+    const GLfloat intensity = std::max({brightest.r, brightest.g, brightest.b});
+
+    /*
+     * 衰减为 1 / (constant + linear * d + quadratic * d^2)，求解 intensity * 衰减 = threshold：
+     *  quadratic * d^2 + linear * d + (constant - intensity / threshold) = 0
+    */
+    const GLfloat c = m_constant - intensity / threshold;
+    if (c >= 0.0f)
+        return 0.0f;
+
+    if (m_quadratic > 0.0f)
+        return (-m_linear + std::sqrt(m_linear * m_linear - 4.0f * m_quadratic * c)) / (2.0f * m_quadratic);
+    if (m_linear > 0.0f)
+        return -c / m_linear;
+
+    return std::numeric_limits<GLfloat>::infinity();
+}
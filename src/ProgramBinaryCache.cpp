@@ -0,0 +1,232 @@
+#include "ProgramBinaryCache.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+const char CACHE_MAGIC[4] = {'L', 'G', 'P', 'B'};
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t binary_format;
+    uint32_t binary_size;
+};
+
+/*
+ * FNV-1a 64位哈希，可以分多次输入。
+*/
+uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t idx = 0; idx < size; idx++)
+    {
+        hash ^= bytes[idx];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t HashString(uint64_t hash, const std::string &str)
+{
+    // 同时哈希长度，避免 ("ab", "c") 与 ("a", "bc") 得到相同的结果
+    const uint64_t length = str.size();
+    hash = HashBytes(hash, &length, sizeof(length));
+    return HashBytes(hash, str.data(), str.size());
+}
+
+std::string GetGLString(GLenum name)
+{
+    const GLubyte *str = glGetString(name);
+    return str ? reinterpret_cast<const char *>(str) : "";
+}
+} // namespace
+
+ProgramBinaryCache::ProgramBinaryCache()
+    : m_initialized(false), m_supported(false), m_directory("shader_cache"), m_hit_num(0), m_miss_num(0)
+{
+}
+
+ProgramBinaryCache::~ProgramBinaryCache()
+{
+}
+
+ProgramBinaryCache &ProgramBinaryCache::getInstance()
+{
+    static ProgramBinaryCache instance; // Guaranteed to be destroyed.
+                                        // Instantiated on first use.
+    return instance;
+}
+
+void ProgramBinaryCache::Init()
+{
+    if (m_initialized)
+        return;
+    m_initialized = true;
+
+    if (!GLAD_GL_VERSION_4_1)
+        return;
+
+    // 部分驱动（例如一些软件实现）虽然提供了接口，但不支持任何二进制格式
+    GLint format_num = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_num);
+    if (format_num <= 0)
+        return;
+
+    m_driver_id = GetGLString(GL_VENDOR) + '|' + GetGLString(GL_RENDERER) + '|' + GetGLString(GL_VERSION);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error)
+    {
+        std::cerr << "ProgramBinaryCache: failed to create " << m_directory << ", " << error.message() << std::endl;
+        return;
+    }
+
+    m_supported = true;
+}
+
+bool ProgramBinaryCache::IsSupported()
+{
+    Init();
+    return m_supported;
+}
+
+uint64_t ProgramBinaryCache::MakeKey(const std::string &vertexSource, const std::string &fragmentSource)
+{
+    Init();
+
+    uint64_t hash = 14695981039346656037ull;
+    hash = HashString(hash, vertexSource);
+    hash = HashString(hash, fragmentSource);
+    hash = HashString(hash, m_driver_id);
+    return hash;
+}
+
+std::string ProgramBinaryCache::GetCachePath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return m_directory + '/' + name;
+}
+
+GLuint ProgramBinaryCache::Load(uint64_t key)
+{
+    if (!IsSupported())
+        return 0;
+
+    MappedFile file;
+    if (!file.Open(GetCachePath(key)))
+    {
+        m_miss_num++;
+        return 0;
+    }
+
+    FileHeader header;
+    if (file.GetSize() < sizeof(header))
+    {
+        m_miss_num++;
+        return 0;
+    }
+    std::memcpy(&header, file.GetData(), sizeof(header));
+
+    // 键相同但内容不符（哈希碰撞或文件损坏）时当作未命中
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != VERSION ||
+        header.key != key || header.binary_size != file.GetSize() - sizeof(header))
+    {
+        m_miss_num++;
+        return 0;
+    }
+
+    /*
+     * glProgramBinary 用之前由 glGetProgramBinary 取回的二进制代替编译和链接。
+     * 驱动可以拒绝任何二进制（例如驱动升级后），拒绝时 GL_LINK_STATUS 为 GL_FALSE，此时必须从源码重新构建程序。
+    */
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binary_format, file.GetData() + sizeof(header),
+                    static_cast<GLsizei>(header.binary_size));
+
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glDeleteProgram(program);
+        m_miss_num++;
+        return 0;
+    }
+
+    m_hit_num++;
+    return program;
+}
+
+void ProgramBinaryCache::PrepareProgram(GLuint program)
+{
+    if (IsSupported())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramBinaryCache::Store(uint64_t key, GLuint program)
+{
+    if (!IsSupported())
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<uint8_t> binary(static_cast<size_t>(length));
+    GLenum binary_format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &binary_format, binary.data());
+    if (written <= 0)
+        return;
+
+    FileHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = VERSION;
+    header.key = key;
+    header.binary_format = binary_format;
+    header.binary_size = static_cast<uint32_t>(written);
+
+    // 先写入临时文件再重命名，避免写入中途失败时留下半个缓存文件
+    const std::string cache_path = GetCachePath(key);
+    const std::string temp_path = cache_path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return;
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(binary.data()), written);
+        if (!out.good())
+        {
+            out.close();
+            std::error_code error;
+            std::filesystem::remove(temp_path, error);
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, cache_path, error);
+    if (error)
+        std::filesystem::remove(temp_path, error);
+}
+
+size_t ProgramBinaryCache::GetHitNum() const
+{
+    return m_hit_num;
+}
+
+size_t ProgramBinaryCache::GetMissNum() const
+{
+    return m_miss_num;
+}
@@ -0,0 +1,251 @@
+#include "RenderQueue.h"
+#include "GLStateCache.h"
+#include "Material.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+constexpr int LAYER_SHIFT = 60;
+constexpr int TRANSLUCENT_SHIFT = 59;
+
+constexpr uint64_t SHADER_MASK = 0xFFFF;
+constexpr uint64_t MATERIAL_MASK = 0xFFFF;
+constexpr uint64_t DEPTH_MASK = 0xFFFFFF;
+
+constexpr int RADIX_BITS = 8;
+constexpr size_t RADIX_BUCKET_NUM = 1 << RADIX_BITS;
+
+void SetCapability(GLenum capability, bool enabled)
+{
+    if (enabled)
+        GLStateCache::getInstance().Enable(capability);
+    else
+        GLStateCache::getInstance().Disable(capability);
+}
+} // namespace
+
+RenderQueue::RenderQueue() : m_view(1.0f)
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::Begin(const glm::mat4 &view)
+{
+    m_view = view;
+    m_packets.clear();
+}
+
+uint32_t RenderQueue::QuantizeDepth(const glm::vec3 &worldPos) const
+{
+    // 相机后方的物体深度按0处理
+    const float depth = std::max(-(m_view * glm::vec4(worldPos, 1.0f)).z, 0.0f);
+
+    uint32_t bits = 0;
+    std::memcpy(&bits, &depth, sizeof(bits));
+
+    // 符号位恒为0，取指数和尾数的高24位
+    return (bits >> 7) & DEPTH_MASK;
+}
+
+uint64_t RenderQueue::MakeSortKey(RenderLayer layer, const DrawPacket &packet) const
+{
+    const uint64_t shader_id = packet.shader ? packet.shader->GetProgramID() & SHADER_MASK : 0;
+
+    const uint64_t material_id = packet.material ? packet.material->GetSortId() & MATERIAL_MASK : 0;
+
+    const glm::vec3 position = packet.has_model_matrix ? glm::vec3(packet.model_matrix[3]) : glm::vec3(0.0f);
+    const uint64_t depth = QuantizeDepth(position);
+
+    uint64_t key = static_cast<uint64_t>(layer) << LAYER_SHIFT;
+    if (packet.state.blend)
+    {
+        // 半透明物体从后到前：深度越大排序键越小
+        key |= uint64_t(1) << TRANSLUCENT_SHIFT;
+        key |= (DEPTH_MASK - depth) << 35;
+        key |= shader_id << 19;
+        key |= material_id << 3;
+    }
+    else
+    {
+        key |= shader_id << 43;
+        key |= material_id << 27;
+        key |= depth << 3;
+    }
+
+    return key;
+}
+
+Material *RenderQueue::MeshMaterial(const Mesh *mesh, const Shader *shader)
+{
+    Material *material = mesh->GetMaterial();
+    return material && material->GetShader() == shader ? material : nullptr;
+}
+
+void RenderQueue::Push(RenderLayer layer, DrawPacket &&packet)
+{
+    packet.sort_key = MakeSortKey(layer, packet);
+    m_packets.push_back(std::move(packet));
+}
+
+void RenderQueue::Submit(RenderLayer layer, Mesh *mesh, const glm::mat4 *model, const RenderState &state,
+                         Shader *shader)
+{
+    if (!mesh)
+        return;
+
+    DrawPacket packet;
+    packet.mesh = mesh;
+    packet.model = nullptr;
+    packet.shader = shader ? shader : &mesh->GetShader();
+    packet.material = MeshMaterial(mesh, packet.shader);
+    packet.model_matrix = model ? *model : glm::mat4(1.0f);
+    packet.has_model_matrix = model != nullptr;
+    packet.instance_num = 0;
+    packet.state = state;
+
+    Push(layer, std::move(packet));
+}
+
+void RenderQueue::SubmitInstanced(RenderLayer layer, Mesh *mesh, GLsizei instanceNum, const RenderState &state,
+                                  Shader *shader)
+{
+    if (!mesh || instanceNum <= 0)
+        return;
+
+    DrawPacket packet;
+    packet.mesh = mesh;
+    packet.model = nullptr;
+    packet.shader = shader ? shader : &mesh->GetShader();
+    packet.material = MeshMaterial(mesh, packet.shader);
+    packet.model_matrix = glm::mat4(1.0f);
+    packet.has_model_matrix = false;
+    packet.instance_num = instanceNum;
+    packet.state = state;
+
+    Push(layer, std::move(packet));
+}
+
+void RenderQueue::Submit(RenderLayer layer, const Model *model, const glm::mat4 *modelMatrix,
+                         const RenderState &state)
+{
+    if (!model || !model->HasValidMesh())
+        return;
+
+    DrawPacket packet;
+    packet.mesh = nullptr;
+    packet.model = model;
+    packet.shader = model->GetShader();
+    packet.material = nullptr;
+    packet.model_matrix = modelMatrix ? *modelMatrix : glm::mat4(1.0f);
+    packet.has_model_matrix = modelMatrix != nullptr;
+    packet.instance_num = 0;
+    packet.state = state;
+
+    Push(layer, std::move(packet));
+}
+
+void RenderQueue::RadixSort()
+{
+    m_sort_scratch.resize(m_sort_items.size());
+
+    for (int shift = 0; shift < 64; shift += RADIX_BITS)
+    {
+        size_t counts[RADIX_BUCKET_NUM] = {};
+        for (const SortItem &item : m_sort_items)
+        {
+            counts[(item.key >> shift) & (RADIX_BUCKET_NUM - 1)]++;
+        }
+
+        // 所有 key 在这8位上都相同，这一趟不会改变顺序
+        if (std::find(std::begin(counts), std::end(counts), m_sort_items.size()) != std::end(counts))
+            continue;
+
+        size_t offset = 0;
+        for (size_t &count : counts)
+        {
+            const size_t bucket_size = count;
+            count = offset;
+            offset += bucket_size;
+        }
+
+        for (const SortItem &item : m_sort_items)
+        {
+            m_sort_scratch[counts[(item.key >> shift) & (RADIX_BUCKET_NUM - 1)]++] = item;
+        }
+        m_sort_items.swap(m_sort_scratch);
+    }
+}
+
+void RenderQueue::ApplyState(const RenderState &state)
+{
+    GLStateCache &cache = GLStateCache::getInstance();
+
+    SetCapability(GL_DEPTH_TEST, state.depth_test);
+    cache.DepthMask(state.depth_write ? GL_TRUE : GL_FALSE);
+    cache.DepthFunc(state.depth_func);
+
+    SetCapability(GL_STENCIL_TEST, state.stencil_test);
+    cache.StencilFunc(state.stencil_func, state.stencil_ref, state.stencil_func_mask);
+    cache.StencilMask(state.stencil_write_mask);
+    cache.StencilOp(state.stencil_fail_op, state.stencil_depth_fail_op, state.stencil_pass_op);
+
+    SetCapability(GL_BLEND, state.blend);
+    if (state.blend)
+        cache.BlendFunc(state.blend_src, state.blend_dst);
+
+    SetCapability(GL_CULL_FACE, state.cull_face);
+    if (state.cull_face)
+        cache.CullFace(state.cull_mode);
+}
+
+void RenderQueue::Execute()
+{
+    m_sort_items.resize(m_packets.size());
+    for (size_t idx = 0; idx < m_packets.size(); idx++)
+    {
+        m_sort_items[idx] = SortItem{m_packets[idx].sort_key, static_cast<uint32_t>(idx)};
+    }
+
+    RadixSort();
+
+    for (const SortItem &item : m_sort_items)
+    {
+        DrawPacket &packet = m_packets[item.index];
+        Shader &shader = *packet.shader;
+
+        ApplyState(packet.state);
+
+        if (packet.has_model_matrix && shader.HasUniform("model"))
+        {
+            shader.SetMat4f("model", packet.model_matrix);
+
+            // 将法向量从模型空间变换到世界空间中需要用到的矩阵
+            if (shader.HasUniform("normalMatrix"))
+                shader.SetMat3f("normalMatrix", glm::transpose(glm::inverse(glm::mat3(packet.model_matrix))));
+        }
+
+        if (packet.mesh)
+        {
+            if (packet.instance_num > 0)
+                packet.mesh->DrawInstanced(packet.instance_num, shader, packet.material);
+            else
+                packet.mesh->Draw(shader, packet.material);
+        }
+        else if (packet.model)
+        {
+            packet.model->Draw();
+        }
+    }
+
+    // 之后不经过队列的绘制（以及下一帧的 glClear）使用默认状态
+    ApplyState(RenderState());
+}
+
+size_t RenderQueue::GetPacketNum() const
+{
+    return m_packets.size();
+}
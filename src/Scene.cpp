@@ -1,25 +1,41 @@
 #include "Scene.h"
 #include "Cube.h"
 #include "FrameBuffer.h"
+#include "DirectionLight.h"
+#include "GLStateCache.h"
 #include "Mesh.h"
+#include "MeshOptimizer.h"
 #include "Model.h"
+#include "PointLight.h"
 #include "Rectangle.h"
 #include "Shader.h"
 #include "ShaderUnit.h"
 #include "Sphere.h"
+#include "SpotLight.h"
 #include "Texture.h"
 #include "Texture2D.h"
 #include "TextureCubeMap.h"
+#include "TextureRegistry.h"
 #include "glm/ext/matrix_transform.hpp"
 #include "GLFW/glfw3.h"
 #include "glm/fwd.hpp"
 #include "glm/matrix.hpp"
 #include "glm/trigonometric.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <random>
 #include <vector>
 #include "VertexAttribute.h"
 
-Scene::Scene() : m_meshes(), m_shaders(), m_textures(), m_models(), m_fbo(nullptr), m_camera()
+namespace
+{
+// 没有包围盒的网格使用足够大的包围盒，总是可见
+constexpr float UNBOUNDED_EXTENT = FrustumCuller::UNBOUNDED_EXTENT;
+} // namespace
+
+Scene::Scene() : m_meshes(), m_shaders(), m_textures(), m_models(), m_fbo(nullptr), m_grass_instances(nullptr), m_camera(), m_frame_ring(), m_camera_buffer(), m_light_manager(), m_render_queue(), m_instances(), m_bvh(), m_visible_instances(), m_occluders(), m_occlusion_culler()
 {
     m_camSpeed = 0.05f;
     m_lastFrameTime = 0.0f;
@@ -42,7 +58,7 @@ Scene::~Scene()
     m_shaders.clear();
 
     for (auto texture : m_textures)
-        delete texture;
+        TextureRegistry::getInstance().Release(texture);
     m_textures.clear();
 
     for (auto model : m_models)
@@ -55,6 +71,12 @@ Scene::~Scene()
         m_fbo = nullptr;
     }
 
+    if (m_grass_instances != nullptr)
+    {
+        delete m_grass_instances;
+        m_grass_instances = nullptr;
+    }
+
     if (m_skybox_mesh != nullptr)
     {
         delete m_skybox_mesh;
@@ -79,10 +101,28 @@ void Scene::Init(int width, int height)
     m_lastCursorPosX = (double)width / 2;
     m_lastCursorPosY = (double)height / 2;
 
+    // 相机和灯光的 uniform block 每帧约 15KB，每个区域留出足够的余量给其他每帧变化的数据
+    m_frame_ring.Init(64 * 1024);
+
+    m_camera_buffer.Init(&m_frame_ring);
+
+    m_light_manager.Init(&m_frame_ring);
+    SetupLights();
+
     SetupSkybox();
 
     Shader *shader = SetupMat_RefractSkybox();
-    SetupSphereMesh(*shader);
+    Mesh *sphere = SetupSphereMesh(*shader);
+    const size_t sphere_instance = AddInstance(sphere);
+
+    // 球体内接立方体的半长为 r / sqrt(3)，再留出一些余量保证在细分后的球面之内
+    glm::vec3 sphere_min, sphere_max;
+    if (sphere->GetBoundingBox(sphere_min, sphere_max))
+    {
+        const glm::vec3 center = (sphere_min + sphere_max) * 0.5f;
+        const glm::vec3 extent = (sphere_max - sphere_min) * 0.5f * (0.95f / std::sqrt(3.0f));
+        SetBoxOccluder(sphere_instance, center - extent, center + extent);
+    }
 }
 
 ////////////////////////////////////////////////// 配置渲染用的材质和网格 ///////////////////////////////////////////////
@@ -231,6 +271,9 @@ Mesh *Scene::SetupMesh_2(Shader &shader)
         30, 31, 32, 33, 34, 35  // 顶面
     };
 
+    // 每个面的两个三角形有重复的顶点，焊接并重排后再创建网格
+    MeshOptimizer::Optimize(vertices, indices, 8);
+
     Mesh *mesh = new Mesh(vertices, indices, VertexAttributePresets::GetPosColorTexLayout(), &shader);
     AddMesh(mesh);
 
@@ -330,6 +373,9 @@ Mesh *Scene::SetupMesh_3(Shader &shader)
         30, 31, 32, 33, 34, 35  // 顶面
     };
 
+    // 每个面的两个三角形有重复的顶点，焊接并重排后再创建网格
+    MeshOptimizer::Optimize(vertices, indices, 8);
+
     Mesh *mesh = new Mesh(vertices, indices, VertexAttributePresets::GetPosNormalTexLayout(), &shader);
     AddMesh(mesh);
 
@@ -349,7 +395,7 @@ Shader *Scene::SetupMat_4()
         return nullptr;
 
     // 高光纹理
-    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA);
+    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA, GL_REPEAT, false);
     if (!specular_tex)
         return nullptr;
 
@@ -427,6 +473,9 @@ Mesh *Scene::SetupMesh_4(Shader &shader)
         30, 31, 32, 33, 34, 35  // 顶面
     };
 
+    // 每个面的两个三角形有重复的顶点，焊接并重排后再创建网格
+    MeshOptimizer::Optimize(vertices, indices, 8);
+
     Mesh *mesh = new Mesh(vertices, indices, VertexAttributePresets::GetPosNormalTexLayout(), &shader);
     AddMesh(mesh);
 
@@ -446,7 +495,7 @@ Shader *Scene::SetupMat_5()
         return nullptr;
 
     // 高光纹理
-    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA);
+    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA, GL_REPEAT, false);
     if (!specular_tex)
         return nullptr;
 
@@ -484,7 +533,7 @@ Shader *Scene::SetupMat_6()
         return nullptr;
 
     // 高光纹理
-    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA);
+    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA, GL_REPEAT, false);
     if (!specular_tex)
         return nullptr;
 
@@ -527,7 +576,7 @@ Shader *Scene::SetupMat_7()
         return nullptr;
 
     // 高光纹理
-    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA);
+    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA, GL_REPEAT, false);
     if (!specular_tex)
         return nullptr;
 
@@ -573,7 +622,7 @@ Shader *Scene::SetupMat_8()
         return nullptr;
 
     // 高光纹理
-    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA);
+    Texture2D *specular_tex = LoadTexture("../textures/container2_specular.png", GL_RGBA, GL_REPEAT, false);
     if (!specular_tex)
         return nullptr;
 
@@ -582,32 +631,7 @@ Shader *Scene::SetupMat_8()
     shader->SetTexture("material.specular", specular_tex);
     shader->SetFloat("material.shininess", 64.0f);
 
-    // 方向光属性
-    shader->SetVec3f("dirLight.direction", glm::vec3(-0.0f, -0.0f, -5.0f));
-    shader->SetVec3f("dirLight.ambient", glm::vec3(0.2f, 0.2f, 0.2f));
-    shader->SetVec3f("dirLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-    shader->SetVec3f("dirLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-
-    // 点光源属性
-    shader->SetVec3f("pointLight.position", glm::vec3(0.0f, 0.0f, 3.0f));
-    shader->SetFloat("pointLight.constant", 1.0f);
-    shader->SetFloat("pointLight.linear", 0.045f);
-    shader->SetFloat("pointLight.quadratic", 0.0075f);
-    shader->SetVec3f("pointLight.ambient", glm::vec3(0.2f, 0.2f, 0.2f));
-    shader->SetVec3f("pointLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-    shader->SetVec3f("pointLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-
-    // 聚光灯属性
-    shader->SetVec3f("spotLight.position", m_camera.GetPos());
-    shader->SetVec3f("spotLight.direction", m_camera.GetFront());
-    shader->SetFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-    shader->SetFloat("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
-    shader->SetFloat("spotLight.constant", 1.0f);
-    shader->SetFloat("spotLight.linear", 0.045f);
-    shader->SetFloat("spotLight.quadratic", 0.0075f);
-    shader->SetVec3f("spotLight.ambient", glm::vec3(0.2f, 0.2f, 0.2f));
-    shader->SetVec3f("spotLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-    shader->SetVec3f("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
+    // 灯光参数来自 LightManager 上传的 LightBlock（见 SetupLights）
 
     AddShader(shader);
 
@@ -657,7 +681,8 @@ Shader *Scene::SetupMat_GlassWind()
 Shader *Scene::SetupMat_Grass()
 {
     // Shader
-    Shader *shader = LoadShader("../shaders/vertex_grass.vert", "../shaders/fragment_grass.frag");
+    // 草使用实例化绘制，每棵草的模型矩阵来自逐实例属性（见 SetupGrassInstances）
+    Shader *shader = LoadShader("../shaders/vertex_grass.vert", "../shaders/fragment_grass.frag", {"INSTANCED"});
     if (!shader)
         return nullptr;
 
@@ -666,11 +691,6 @@ Shader *Scene::SetupMat_Grass()
     if (!texture)
         return nullptr;
 
-    glm::mat4 model = glm::mat4(1.0f);
-    // model = glm::scale(model, glm::vec3(0.7f));
-    model = glm::translate(model, glm::vec3(0.0f, 0.0f, 3.0f));
-    shader->SetMat4f("model", model);
-
     shader->SetTexture("texture0", texture);
 
     AddShader(shader);
@@ -771,6 +791,23 @@ Mesh *Scene::SetupSphereMesh(Shader &shader)
     return sphere;
 }
 
+/*
+ * 场景中的灯光：一个方向光、一个点光源和一个聚光灯
+*/
+void Scene::SetupLights()
+{
+    m_light_manager.AddLight(new DirectionLight(glm::vec3(-0.0f, -0.0f, -5.0f), glm::vec3(0.2f, 0.2f, 0.2f),
+                                                glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(1.0f, 1.0f, 1.0f)));
+
+    m_light_manager.AddLight(new PointLight(glm::vec3(0.0f, 0.0f, 3.0f), 0.045f, 0.0075f, glm::vec3(0.2f, 0.2f, 0.2f),
+                                            glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(1.0f, 1.0f, 1.0f)));
+
+    m_light_manager.AddLight(new SpotLight(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                                           glm::cos(glm::radians(12.5f)), glm::cos(glm::radians(17.5f)), 0.045f,
+                                           0.0075f, glm::vec3(0.2f, 0.2f, 0.2f), glm::vec3(0.5f, 0.5f, 0.5f),
+                                           glm::vec3(1.0f, 1.0f, 1.0f)));
+}
+
 void Scene::SetupModel_1()
 {
     Model *model = new Model("../models/nanosuit/nanosuit.obj");
@@ -822,8 +859,12 @@ void Scene::InitMVP(Shader *shader, bool setNormal)
     projection = m_camera.GetProjectionMatrix();
 
     shader->SetMat4f("model", model);
-    shader->SetMat4f("view", view);
-    shader->SetMat4f("projection", projection);
+
+    // 使用 CameraBlock 的着色器没有这两个 uniform
+    if (shader->HasUniform("view"))
+        shader->SetMat4f("view", view);
+    if (shader->HasUniform("projection"))
+        shader->SetMat4f("projection", projection);
 
     if (setNormal) // 不忽略非 model 值时
     {
@@ -943,10 +984,11 @@ void Scene::SetupFrameBuffer(int width, int height)
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-Shader *Scene::LoadShader(const std::string &vertexFilePath, const std::string &fragmentFilePath)
+Shader *Scene::LoadShader(const std::string &vertexFilePath, const std::string &fragmentFilePath,
+                          const std::vector<std::string> &defines)
 {
-    ShaderUnit vertex_unit = ShaderUnit(vertexFilePath, GL_VERTEX_SHADER);
-    ShaderUnit fragment_unit = ShaderUnit(fragmentFilePath, GL_FRAGMENT_SHADER);
+    ShaderUnit vertex_unit = ShaderUnit(vertexFilePath, GL_VERTEX_SHADER, defines);
+    ShaderUnit fragment_unit = ShaderUnit(fragmentFilePath, GL_FRAGMENT_SHADER, defines);
 
     Shader *shader = new Shader(vertex_unit, fragment_unit);
 
@@ -959,14 +1001,14 @@ Shader *Scene::LoadShader(const std::string &vertexFilePath, const std::string &
     return shader;
 }
 
-Texture2D *Scene::LoadTexture(const std::string &filePath, GLenum format, GLint wrapMode)
+Texture2D *Scene::LoadTexture(const std::string &filePath, GLenum format, GLint wrapMode, bool srgb)
 {
-    Texture2D *texture = new Texture2D(filePath.c_str(), format, wrapMode);
-    if (!texture->IsValidTexture())
-    {
-        delete texture;
+    // 同一张图片在多个材质中引用时（例如 wall.jpg），只会解码和上传一次
+    Texture2D *texture =
+        TextureRegistry::getInstance().Acquire(filePath, format, wrapMode, false, TextureCompression::None, srgb);
+    if (!texture)
         return nullptr;
-    }
+
     AddTexture(texture);
     return texture;
 }
@@ -989,6 +1031,54 @@ void Scene::AddTexture(Texture2D *texture)
 void Scene::AddModel(Model *model)
 {
     m_models.push_back(model);
+    AddInstance(model);
+}
+
+size_t Scene::AddInstance(Mesh *mesh)
+{
+    SceneInstance instance = {mesh, nullptr, glm::vec3(-UNBOUNDED_EXTENT), glm::vec3(UNBOUNDED_EXTENT),
+                              glm::vec3(0.0f), glm::vec3(0.0f), DynamicBVH::NULL_NODE, false};
+    mesh->GetBoundingBox(instance.bounds_min, instance.bounds_max);
+
+    m_instances.push_back(instance);
+    UpdateInstanceBounds(m_instances.back(), GetModelMatrix());
+    return m_instances.size() - 1;
+}
+
+size_t Scene::AddInstance(Model *model)
+{
+    SceneInstance instance = {nullptr, model, glm::vec3(0.0f), glm::vec3(0.0f),
+                              glm::vec3(0.0f), glm::vec3(0.0f), DynamicBVH::NULL_NODE, false};
+    model->GetBoundingBox(instance.bounds_min, instance.bounds_max);
+
+    m_instances.push_back(instance);
+    UpdateInstanceBounds(m_instances.back(), GetModelMatrix());
+    return m_instances.size() - 1;
+}
+
+void Scene::SetBoxOccluder(size_t instanceIdx, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    if (instanceIdx >= m_instances.size())
+    {
+        std::cerr << "Scene::SetBoxOccluder: invalid instance index " << instanceIdx << std::endl;
+        return;
+    }
+
+    Occluder occluder;
+    occluder.instance = instanceIdx;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        occluder.positions.emplace_back((corner & 1) ? boundsMax.x : boundsMin.x,
+                                        (corner & 2) ? boundsMax.y : boundsMin.y,
+                                        (corner & 4) ? boundsMax.z : boundsMin.z);
+    }
+
+    // 每个面两个三角形，遮挡剔除不区分正反面
+    occluder.indices = {0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1,
+                        2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3};
+
+    m_occluders.push_back(std::move(occluder));
+    m_instances[instanceIdx].is_occluder = true;
 }
 
 void Scene::Render()
@@ -1000,36 +1090,66 @@ void Scene::Render()
     m_deltaTime = now_time - m_lastFrameTime;
     m_lastFrameTime = now_time;
 
+    // 切换到环形缓冲区的下一个区域，本帧所有每帧变化的数据都从这里分配
+    m_frame_ring.BeginFrame();
+
+    // 相机参数每帧只计算和上传一次，所有声明了 CameraBlock 的着色器共享
+    m_camera_buffer.Update(m_camera, now_time);
+
+    // 所有灯光每帧打包上传一次，与使用灯光的网格和材质数量无关
+    m_light_manager.Update(m_camera);
+
+    // 以下只提交绘制包，最后由渲染队列排序后统一绘制
+    m_render_queue.Begin(m_camera_buffer.GetData().view);
+
+    /*
+     * 视锥体剔除：实例的包围盒保存在 BVH 中，每帧只更新移动过的叶节点，
+     * 查询时跳过整棵位于视锥体外的子树，只提交可见的实例。
+    */
+    const glm::mat4 model_matrix = GetModelMatrix();
+    for (SceneInstance &instance : m_instances)
+    {
+        UpdateInstanceBounds(instance, model_matrix);
+    }
+
+    glm::vec4 frustum_planes[6];
+    m_camera.GetFrustumPlanes(frustum_planes);
+
+    m_visible_instances.clear();
+    m_bvh.QueryFrustum(frustum_planes, m_visible_instances);
+
+    // 遮挡剔除：被遮挡体完全挡住的实例不提交
+    CullOccludedInstances(model_matrix);
+
     /*
      * 先渲染天空盒不能利用Early-z进行片元剔除
     */
     // DrawSkybox()
 
-    // 网格渲染
-    if (!m_meshes.empty())
-    {
-        Mesh *mesh = m_meshes[0];
+    std::function<void(Mesh *)> each_mesh_func = [this](Mesh *mesh) {
         Shader &shader = mesh->GetShader();
-        UpdateModelMatrix(shader);
+
         UpdateViewMatrix(shader);
         UpdateProjectionMatrix(shader);
-        mesh->Draw();
-    }
+    };
 
-    // 模型渲染
-    if (!m_models.empty())
+    for (uint32_t instance_idx : m_visible_instances)
     {
-        std::function<void(Mesh *)> each_mesh_func = [this](Mesh *mesh) {
-            Shader &shader = mesh->GetShader();
+        const SceneInstance &instance = m_instances[instance_idx];
+
+        // 网格渲染
+        if (instance.mesh)
+        {
+            each_mesh_func(instance.mesh);
+            m_render_queue.Submit(RenderLayer::Opaque, instance.mesh, &model_matrix);
+            continue;
+        }
 
-            UpdateModelMatrix(shader);
-            UpdateViewMatrix(shader);
-            UpdateProjectionMatrix(shader);
-        };
+        // 模型渲染
+        SelectModelLod(instance.model);
+        instance.model->ForeachMesh(each_mesh_func);
 
-        Model *model = m_models[0];
-        model->ForeachMesh(each_mesh_func);
-        model->Draw();
+        m_render_queue.Submit(RenderLayer::Opaque, instance.model, &model_matrix);
     }
 
     /*
@@ -1037,6 +1157,108 @@ void Scene::Render()
      * 后渲染天空盒时可以通过影响输出的深度值从而避免天空盒遮挡其他物体，进而可以利用Early-z进行片元剔除。
     */
     DrawOptimizedSkybox();
+
+    // 不透明物体按着色器和材质分组、组内从前到后，天空盒在不透明物体之后，半透明物体从后到前
+    m_render_queue.Execute();
+
+    // 本帧的绘制都已提交，插入 fence 之后 GPU 读完之前不会再写入这个区域
+    m_frame_ring.EndFrame();
+}
+
+void Scene::UpdateInstanceBounds(SceneInstance &instance, const glm::mat4 &model)
+{
+    glm::vec3 world_min = instance.bounds_min;
+    glm::vec3 world_max = instance.bounds_max;
+
+    // 没有包围盒的网格不需要变换
+    if (instance.model || world_max.x < UNBOUNDED_EXTENT)
+    {
+        // 中心直接变换，半长乘以模型矩阵3x3部分各元素的绝对值（Arvo 方法）
+        const glm::vec3 center = (instance.bounds_min + instance.bounds_max) * 0.5f;
+        const glm::vec3 extent = (instance.bounds_max - instance.bounds_min) * 0.5f;
+
+        const glm::mat3 rotation(model);
+        const glm::mat3 abs_rotation(glm::abs(rotation[0]), glm::abs(rotation[1]), glm::abs(rotation[2]));
+
+        const glm::vec3 world_center = glm::vec3(model * glm::vec4(center, 1.0f));
+        const glm::vec3 world_extent = abs_rotation * extent;
+        world_min = world_center - world_extent;
+        world_max = world_center + world_extent;
+    }
+
+    instance.world_min = world_min;
+    instance.world_max = world_max;
+
+    if (instance.proxy == DynamicBVH::NULL_NODE)
+    {
+        const uint32_t instance_idx = static_cast<uint32_t>(&instance - m_instances.data());
+        instance.proxy = m_bvh.CreateProxy(world_min, world_max, instance_idx);
+        return;
+    }
+
+    m_bvh.MoveProxy(instance.proxy, world_min, world_max);
+}
+
+void Scene::CullOccludedInstances(const glm::mat4 &model)
+{
+    if (m_occluders.empty())
+        return;
+
+    m_occlusion_culler.Begin(m_camera_buffer.GetData().view_projection);
+    for (const Occluder &occluder : m_occluders)
+    {
+        m_occlusion_culler.AddOccluder(occluder.positions.data(), occluder.positions.size(),
+                                       occluder.indices.data(), occluder.indices.size(), model);
+    }
+    m_occlusion_culler.Rasterize();
+
+    // 遮挡体数量很少，总是绘制，不再测试
+    auto occluded = [this](uint32_t instanceIdx) {
+        const SceneInstance &instance = m_instances[instanceIdx];
+        return !instance.is_occluder && !m_occlusion_culler.IsVisible(instance.world_min, instance.world_max);
+    };
+    m_visible_instances.erase(std::remove_if(m_visible_instances.begin(), m_visible_instances.end(), occluded),
+                              m_visible_instances.end());
+}
+
+size_t Scene::GetVisibleDrawNum() const
+{
+    return m_visible_instances.size();
+}
+
+size_t Scene::GetCulledDrawNum() const
+{
+    return m_bvh.GetProxyNum() - m_visible_instances.size();
+}
+
+/*
+ * 根据模型包围球在屏幕上的大小选择 LOD。
+ * 包围球半径 r、到相机距离 d 时，它在屏幕上的直径占屏幕高度的比例约为 r / (d * tan(fov / 2))。
+*/
+void Scene::SelectModelLod(Model *model)
+{
+    glm::vec3 center;
+    float radius = 0.0f;
+    model->GetBoundingSphere(center, radius);
+
+    const glm::mat4 model_matrix = GetModelMatrix();
+    const glm::vec3 world_center = glm::vec3(model_matrix * glm::vec4(center, 1.0f));
+
+    // 模型矩阵可能带有缩放，半径按最大的轴缩放
+    const float scale = std::max({glm::length(glm::vec3(model_matrix[0])), glm::length(glm::vec3(model_matrix[1])),
+                                  glm::length(glm::vec3(model_matrix[2]))});
+    const float world_radius = radius * scale;
+
+    const float distance = glm::length(world_center - m_camera.GetPos());
+    if (distance <= world_radius)
+    {
+        // 相机位于包围球内部，使用最精细的 LOD
+        model->SelectLod(std::numeric_limits<float>::max());
+        return;
+    }
+
+    const float tan_half_fov = static_cast<float>(std::tan(glm::radians(m_camera.GetFov()) * 0.5));
+    model->SelectLod(world_radius / (distance * tan_half_fov));
 }
 
 /*
@@ -1070,11 +1292,14 @@ void Scene::DrawSkybox()
      * 去除平移的 rotView 矩阵是为了让天空盒固定在视角的背景中，只随摄像机的旋转而旋转，而不会因摄像机的平移而偏移。
      * 这样才能保持天空盒的无限远感，让它充当一个背景元素而不会参与场景的深度变化。
     */
-    glm::mat4 rotView = glm::mat4(glm::mat3(m_camera.GetViewMatrix()));
-    shader.SetMat4f("rotView", rotView);
+    // skybox_optimized.vert 从 CameraBlock 中的 view 计算 rotView，只有旧的天空盒着色器需要设置
+    if (shader.HasUniform("rotView"))
+    {
+        glm::mat4 rotView = glm::mat4(glm::mat3(m_camera_buffer.GetData().view));
+        shader.SetMat4f("rotView", rotView);
 
-    glm::mat4 projection = m_camera.GetProjectionMatrix();
-    shader.SetMat4f("projection", projection);
+        shader.SetMat4f("projection", m_camera_buffer.GetData().projection);
+    }
 
     /*
      * glDepthMask 是 OpenGL 中用于控制深度缓冲区写入操作的函数。其主要作用是控制在绘制几何体时，深度缓冲区是否接受来自当前渲染的写入操作。
@@ -1092,9 +1317,9 @@ void Scene::DrawSkybox()
      * glDepthMask 控制的仅仅是深度缓冲区的写入权限，而不影响深度测试本身的行为。
      * 也就是说，即使关闭了深度写入，深度测试依然可以照常进行，只是深度缓冲区中的值不会被更新。
     */
-    glDepthMask(GL_FALSE); // 关闭深度写入，确保天空盒不会遮挡其他物体绘制
-    m_skybox_mesh->Draw();
-    glDepthMask(GL_TRUE);
+    RenderState state;
+    state.depth_write = false; // 关闭深度写入，确保天空盒不会遮挡其他物体绘制
+    m_render_queue.Submit(RenderLayer::Background, m_skybox_mesh, nullptr, state);
 }
 
 /*
@@ -1128,22 +1353,21 @@ void Scene::DrawOptimizedSkybox()
      * 去除平移的 rotView 矩阵是为了让天空盒固定在视角的背景中，只随摄像机的旋转而旋转，而不会因摄像机的平移而偏移。
      * 这样才能保持天空盒的无限远感，让它充当一个背景元素而不会参与场景的深度变化。
     */
-    glm::mat4 rotView = glm::mat4(glm::mat3(m_camera.GetViewMatrix()));
-    shader.SetMat4f("rotView", rotView);
-
-    glm::mat4 projection = m_camera.GetProjectionMatrix();
-    shader.SetMat4f("projection", projection);
+    // skybox_optimized.vert 从 CameraBlock 中的 view 计算 rotView，只有旧的天空盒着色器需要设置
+    if (shader.HasUniform("rotView"))
+    {
+        glm::mat4 rotView = glm::mat4(glm::mat3(m_camera_buffer.GetData().view));
+        shader.SetMat4f("rotView", rotView);
 
-    /*
-     * 需要保证天空盒在值小于或等于深度缓冲而不是小于时通过深度测试。
-    */
-    glDepthFunc(GL_LEQUAL);
-    m_skybox_mesh->Draw();
+        shader.SetMat4f("projection", m_camera_buffer.GetData().projection);
+    }
 
     /*
-     * 恢复深度测试函数
+     * 需要保证天空盒在值小于或等于深度缓冲而不是小于时通过深度测试，绘制后渲染队列会恢复默认的深度测试函数。
     */
-    glDepthFunc(GL_LESS);
+    RenderState state;
+    state.depth_func = GL_LEQUAL;
+    m_render_queue.Submit(RenderLayer::Skybox, m_skybox_mesh, nullptr, state);
 }
 
 /*
@@ -1154,6 +1378,8 @@ void Scene::DrawOptimizedSkybox()
 */
 void Scene::DrawMeshAndOutline(Mesh *mesh, Shader *shader, Shader *outlineShader)
 {
+    const glm::mat4 model = GetModelMatrix();
+
     // 第一个遍正常渲染物体，
     // 同时片元展示区域的模板缓冲写入模板值1
     {
@@ -1190,7 +1416,10 @@ void Scene::DrawMeshAndOutline(Mesh *mesh, Shader *shader, Shader *outlineShader
          *  GL_DECR_WRAP: 减少当前模板缓冲区的值。如果值已经是最小值，则包裹为最大值。
          *  GL_INVERT: 按位反转当前模板缓冲区的值。
         */
-        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+        RenderState mesh_state;
+        mesh_state.stencil_fail_op = GL_KEEP;
+        mesh_state.stencil_depth_fail_op = GL_KEEP;
+        mesh_state.stencil_pass_op = GL_REPLACE;
 
         /*
          * glStencilFunc 是 OpenGL 中用于设置模板测试（Stencil Test）行为的函数。
@@ -1212,7 +1441,9 @@ void Scene::DrawMeshAndOutline(Mesh *mesh, Shader *shader, Shader *outlineShader
          *  GL_EQUAL: 当模板值等于参考值时，通过测试。
          *  GL_NOTEQUAL: 当模板值不等于参考值时，通过测试。
         */
-        glStencilFunc(GL_ALWAYS, 1, 0xFF);
+        mesh_state.stencil_func = GL_ALWAYS;
+        mesh_state.stencil_ref = 1;
+        mesh_state.stencil_func_mask = 0xFF;
 
         /*
          * glStencilMask 是 OpenGL 中用于控制模板缓冲区的写入权限的函数。
@@ -1227,13 +1458,11 @@ void Scene::DrawMeshAndOutline(Mesh *mesh, Shader *shader, Shader *outlineShader
          * glStencilOp 用于定义在模板测试后应如何处理模板缓冲区中的值，而 glStencilMask 则控制哪些位可以被写入。
          * 这两者通常需要一起使用，以实现所需的渲染效果。
         */
-        glStencilMask(0xFF);
+        mesh_state.stencil_write_mask = 0xFF;
 
-        UpdateModelMatrix(*shader);
         UpdateViewMatrix(*shader);
         UpdateProjectionMatrix(*shader);
-        mesh->ChangeShader(shader);
-        mesh->Draw();
+        m_render_queue.Submit(RenderLayer::Opaque, mesh, &model, mesh_state, shader);
     }
 
     // 第二遍渲染轮廓
@@ -1241,31 +1470,30 @@ void Scene::DrawMeshAndOutline(Mesh *mesh, Shader *shader, Shader *outlineShader
         /*
          * 模板缓冲区中的值不等于1时模板测试通过（即物体片元的渲染区域不会被渲染到）
         */
-        glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
+        RenderState outline_state;
+        outline_state.stencil_func = GL_NOTEQUAL;
+        outline_state.stencil_ref = 1;
+        outline_state.stencil_func_mask = 0xFF;
 
         /*
          * 禁止写入模板缓冲区
         */
-        glStencilMask(0x00);
+        outline_state.stencil_write_mask = 0x00;
 
         /*
          * 在绘制物体轮廓时，禁止深度测试（Depth Test）是常见的做法。这主要是为了确保轮廓能够正确地渲染到物体的边缘上，而不被其他物体遮挡。
          * 轮廓通常是较薄的几何体（如线条），如果深度测试开启，这些线条可能会因为深度冲突（z-fighting）而变得不清晰或不连续。
          * 禁用深度测试可以避免这种情况，使轮廓的渲染效果更加清晰和稳定。
         */
-        glDisable(GL_DEPTH_TEST);
+        outline_state.depth_test = false;
 
-        UpdateModelMatrix(*outlineShader, true);
+        /*
+         * 轮廓放在 Overlay 层，保证在物体写入模板值之后绘制。
+         * 渲染队列绘制完成后恢复默认状态：开启模板缓冲区写入（不开启则使用 glClear(GL_STENCIL_BUFFER_BIT) 清空无法写入清空值）和深度测试。
+        */
         UpdateViewMatrix(*outlineShader, true);
         UpdateProjectionMatrix(*outlineShader);
-        mesh->ChangeShader(outlineShader);
-        mesh->Draw();
-    }
-
-    // 恢复深度测试
-    {
-        glStencilMask(0xFF); // 开启模板缓冲区写入，不开启则使用 glClear(GL_STENCIL_BUFFER_BIT) 清空无法写入清空值。
-        glEnable(GL_DEPTH_TEST);
+        m_render_queue.Submit(RenderLayer::Overlay, mesh, &model, outline_state, outlineShader);
     }
 }
 
@@ -1278,10 +1506,11 @@ void Scene::DrawGlassWithoutBlend(Mesh *cube, Mesh *rectangle)
     {
         Mesh *cube_mesh = cube;
         Shader &cube_shader = cube_mesh->GetShader();
-        UpdateModelMatrix(cube_shader);
         UpdateViewMatrix(cube_shader);
         UpdateProjectionMatrix(cube_shader);
-        cube_mesh->Draw();
+
+        const glm::mat4 model = GetModelMatrix();
+        m_render_queue.Submit(RenderLayer::Opaque, cube_mesh, &model);
     }
 
     // 后渲染前面的半透玻璃
@@ -1290,7 +1519,7 @@ void Scene::DrawGlassWithoutBlend(Mesh *cube, Mesh *rectangle)
         Shader &rectangle_shader = rectangle_mesh->GetShader();
         UpdateViewMatrix(rectangle_shader, true);
         UpdateProjectionMatrix(rectangle_shader);
-        rectangle_mesh->Draw();
+        m_render_queue.Submit(RenderLayer::Opaque, rectangle_mesh, nullptr);
     }
 }
 
@@ -1301,13 +1530,13 @@ void Scene::DrawGlassWithBlend(Mesh *cube, Mesh *rectangle)
 {
     // 先渲染后面的立方体
     {
-        glDisable(GL_BLEND);
         Mesh *cube_mesh = cube;
         Shader &cube_shader = cube_mesh->GetShader();
-        UpdateModelMatrix(cube_shader);
         UpdateViewMatrix(cube_shader);
         UpdateProjectionMatrix(cube_shader);
-        cube_mesh->Draw();
+
+        const glm::mat4 model = GetModelMatrix();
+        m_render_queue.Submit(RenderLayer::Opaque, cube_mesh, &model);
     }
 
     // 后渲染前面的半透玻璃
@@ -1350,7 +1579,8 @@ void Scene::DrawGlassWithBlend(Mesh *cube, Mesh *rectangle)
          *  顺序问题：在渲染半透明物体时，顺序非常重要。通常需要按照从远到近的顺序进行渲染，以确保混合结果正确。
          *  性能影响：启用混合后，会增加 GPU 的计算负担，特别是在复杂场景中。这是因为每个片段都需要与帧缓冲区中的像素进行计算。
         */
-        glEnable(GL_BLEND);
+        RenderState state;
+        state.blend = true;
 
         /*
          * glBlendFunc 是 OpenGL 中的一个函数，用于指定在混合（Blending）操作中使用的混合因子。
@@ -1378,13 +1608,15 @@ void Scene::DrawGlassWithBlend(Mesh *cube, Mesh *rectangle)
          *  GL_ONE_MINUS_DST_ALPHA：因子为1减去目标颜色的Alpha分量，即 (1-A_d, 1-A_d, 1-A_d, 1-A_d)。
          *  GL_CONSTANT_COLOR 和 GL_CONSTANT_ALPHA：因子为一个常量颜色或常量 alpha，即 (R_c, G_c, B_c, A_c)，其中 R_c, G_c, B_c, A_c 是通过 glBlendColor 设置的常量颜色或 alpha。
         */
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        state.blend_src = GL_SRC_ALPHA;
+        state.blend_dst = GL_ONE_MINUS_SRC_ALPHA;
 
+        // 半透明物体进入 Transparent 层，在所有不透明物体之后从后到前绘制
         Mesh *rectangle_mesh = rectangle;
         Shader &rectangle_shader = rectangle_mesh->GetShader();
         UpdateViewMatrix(rectangle_shader, true);
         UpdateProjectionMatrix(rectangle_shader);
-        rectangle_mesh->Draw();
+        m_render_queue.Submit(RenderLayer::Transparent, rectangle_mesh, nullptr, state);
     }
 }
 
@@ -1397,10 +1629,11 @@ void Scene::DrawGrass(Mesh *cube, Mesh *rectangle)
     {
         Mesh *cube_mesh = cube;
         Shader &cube_shader = cube_mesh->GetShader();
-        UpdateModelMatrix(cube_shader);
         UpdateViewMatrix(cube_shader);
         UpdateProjectionMatrix(cube_shader);
-        cube_mesh->Draw();
+
+        const glm::mat4 model = GetModelMatrix();
+        m_render_queue.Submit(RenderLayer::Opaque, cube_mesh, &model);
     }
 
     // 渲染前面的2D草
@@ -1426,11 +1659,55 @@ void Scene::DrawGrass(Mesh *cube, Mesh *rectangle)
     */
     {
         Mesh *rectangle_mesh = rectangle;
+        if (!m_grass_instances)
+            SetupGrassInstances(rectangle_mesh);
+
         Shader &rectangle_shader = rectangle_mesh->GetShader();
         UpdateViewMatrix(rectangle_shader, true);
         UpdateProjectionMatrix(rectangle_shader);
-        rectangle_mesh->Draw();
+
+        // 所有草只需要一次绘制调用，不再逐棵上传模型矩阵
+        const GLsizei grass_num = static_cast<GLsizei>(m_grass_instances->GetInstanceNum());
+        m_render_queue.SubmitInstanced(RenderLayer::Opaque, rectangle_mesh, grass_num);
+    }
+}
+
+/*
+ * 在相机前方铺一片草：GRASS_GRID_SIZE x GRASS_GRID_SIZE 棵，位置带随机偏移，绕y轴随机旋转，
+ * 数据只上传一次，之后每帧直接绘制。
+*/
+void Scene::SetupGrassInstances(Mesh *rectangle)
+{
+    constexpr int GRASS_GRID_SIZE = 100;
+    constexpr float GRASS_SPACING = 0.5f;
+
+    std::vector<InstanceData> instances;
+    instances.reserve(GRASS_GRID_SIZE * GRASS_GRID_SIZE);
+
+    // 固定种子，每次运行的草地相同
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> jitter(-0.5f * GRASS_SPACING, 0.5f * GRASS_SPACING);
+    std::uniform_real_distribution<float> angle(0.0f, glm::pi<float>());
+
+    const float half_size = 0.5f * GRASS_SPACING * (GRASS_GRID_SIZE - 1);
+    for (int z = 0; z < GRASS_GRID_SIZE; z++)
+    {
+        for (int x = 0; x < GRASS_GRID_SIZE; x++)
+        {
+            const glm::vec3 position(x * GRASS_SPACING - half_size + jitter(random), 0.0f,
+                                     3.0f - z * GRASS_SPACING + jitter(random));
+
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+            model = glm::rotate(model, angle(random), glm::vec3(0.0f, 1.0f, 0.0f));
+            model = glm::scale(model, glm::vec3(0.25f));
+            instances.push_back(InstanceData::Make(model));
+        }
     }
+
+    m_grass_instances = new InstanceBuffer(instances.size());
+    m_grass_instances->Update(instances.data(), instances.size());
+
+    rectangle->SetInstanceBuffer(m_grass_instances);
 }
 
 /*
@@ -1453,12 +1730,13 @@ void Scene::DrawCullFace(Mesh *mesh)
     /*
      * 在OpenGL中，使用以下函数来启用面剔除，默认面剔除是关闭的。
     */
-    glEnable(GL_CULL_FACE);
+    RenderState state;
+    state.cull_face = true;
 
     /*
      * 选择剔除哪些面（正面或反面）。OpenGL默认剔除的是背面。通过以下函数设置剔除的面。
     */
-    glCullFace(GL_FRONT); // 剔除正面
+    state.cull_mode = GL_FRONT; // 剔除正面
     // glCullFace(GL_BACK);           // 剔除背面（默认）
     // glCullFace(GL_FRONT_AND_BACK); // 剔除正面和背面（通常用于调试）
 
@@ -1471,7 +1749,7 @@ void Scene::DrawCullFace(Mesh *mesh)
     Shader &shader = mesh->GetShader();
     UpdateViewMatrix(shader, true);
     UpdateProjectionMatrix(shader);
-    mesh->Draw();
+    m_render_queue.Submit(RenderLayer::Opaque, mesh, nullptr, state);
 }
 
 /*
@@ -1513,21 +1791,27 @@ void Scene::DrawRenderToTexture(Mesh *mesh, Mesh *screenRectMesh)
             GL_STENCIL_BUFFER_BIT); // 状态值应用，清理掉颜色缓冲区并设置为指定的颜色，同时也清理掉深度缓冲区、模板缓冲区
 
         // 将全屏举行渲染到屏幕上时不需要使用深度测试
-        glDisable(GL_DEPTH_TEST);
+        GLStateCache::getInstance().Disable(GL_DEPTH_TEST);
 
         m_fbo->BindTexture(0, 0);
         Shader &shader = screenRectMesh->GetShader();
         shader.SetInt("texture0", 0);
         screenRectMesh->Draw();
 
-        glEnable(GL_DEPTH_TEST);
+        GLStateCache::getInstance().Enable(GL_DEPTH_TEST);
     }
 }
 
-void Scene::UpdateModelMatrix(Shader &shader, bool ignoreNotModel)
+glm::mat4 Scene::GetModelMatrix() const
 {
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(0.5f, 1.0f, 0.0f));
+    return model;
+}
+
+void Scene::UpdateModelMatrix(Shader &shader, bool ignoreNotModel)
+{
+    glm::mat4 model = GetModelMatrix();
 
     shader.SetMat4f("model", model);
 
@@ -1541,22 +1825,27 @@ void Scene::UpdateModelMatrix(Shader &shader, bool ignoreNotModel)
     }
 }
 
+/*
+ * 声明了 CameraBlock 的着色器没有单独的 view/camPos/projection uniform，直接从每帧更新一次的缓冲区中读取，
+ * 这里只为没有使用 CameraBlock 的着色器设置，矩阵取自本帧已经计算好的结果。
+*/
 void Scene::UpdateViewMatrix(Shader &shader, bool ignoreNotView)
 {
-    glm::mat4 view = m_camera.GetViewMatrix();
-    shader.SetMat4f("view", view);
+    const CameraBlockData &camera_data = m_camera_buffer.GetData();
+
+    if (shader.HasUniform("view"))
+        shader.SetMat4f("view", camera_data.view);
 
-    if (!ignoreNotView) // 不忽略非 view 值时
+    if (!ignoreNotView && shader.HasUniform("camPos")) // 不忽略非 view 值时
     {
-        glm::vec3 pos = m_camera.GetPos();
-        shader.SetVec3f("camPos", pos);
+        shader.SetVec3f("camPos", camera_data.cam_pos);
     }
 }
 
 void Scene::UpdateProjectionMatrix(Shader &shader)
 {
-    glm::mat4 projection = m_camera.GetProjectionMatrix();
-    shader.SetMat4f("projection", projection);
+    if (shader.HasUniform("projection"))
+        shader.SetMat4f("projection", m_camera_buffer.GetData().projection);
 }
 
 void Scene::MoveCamForward()
@@ -1,11 +1,94 @@
+#include <algorithm>
 #include <iostream>
 #include "Shader.h"
+#include "GLStateCache.h"
+#include "ProgramBinaryCache.h"
+#include "SharedTextureUnit.h"
+#include "UniformBlockBinding.h"
 #include <fstream>
 #include <sstream>
 #include "glm/gtc/type_ptr.hpp"
+#include <cstring>
+
+namespace
+{
+/* 整数、布尔和采样器 uniform，都用 glUniform1i 设置 */
+bool IsIntegerUniform(GLenum type)
+{
+    switch (type)
+    {
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_BOOL:
+    case GL_SAMPLER_1D:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_2D_SHADOW:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_2D_MULTISAMPLE:
+    case GL_SAMPLER_BUFFER:
+    case GL_INT_SAMPLER_BUFFER:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* CPU端副本中一个 uniform 占用的字节数，Set* 不支持的类型返回0 */
+uint32_t GetUniformValueSize(GLenum type)
+{
+    switch (type)
+    {
+    case GL_FLOAT:
+        return sizeof(GLfloat);
+    case GL_FLOAT_VEC3:
+        return sizeof(GLfloat) * 3;
+    case GL_FLOAT_VEC4:
+        return sizeof(GLfloat) * 4;
+    case GL_FLOAT_MAT3:
+        return sizeof(GLfloat) * 9;
+    case GL_FLOAT_MAT4:
+        return sizeof(GLfloat) * 16;
+    default:
+        return IsIntegerUniform(type) ? sizeof(GLint) : 0;
+    }
+}
+} // namespace
 
 Shader::Shader(const ShaderUnit &vertexUnit, const ShaderUnit &fragmentUnit) : shader_program(0), texture_idx(0)
 {
+    if (!vertexUnit.IsValid())
+    {
+        std::cerr << "Shader Init failed, vertex shader source is empty!" << std::endl;
+        return;
+    }
+
+    if (!fragmentUnit.IsValid())
+    {
+        std::cerr << "Shader Init failed, fragment shader source is empty!" << std::endl;
+        return;
+    }
+
+    /*
+     * 先查找程序二进制缓存，命中时跳过编译和链接；未命中、缓存过期或被驱动拒绝时从源码构建，
+     * 链接成功后把新的二进制写回缓存。
+    */
+    ProgramBinaryCache &binary_cache = ProgramBinaryCache::getInstance();
+    const uint64_t cache_key = binary_cache.MakeKey(vertexUnit.GetSource(), fragmentUnit.GetSource());
+
+    shader_program = binary_cache.Load(cache_key);
+    if (shader_program > 0)
+    {
+        ReflectUniforms();
+        BindUniformBlocks();
+        BindSharedTextures();
+        return;
+    }
+
     const GLuint vertex_shader = vertexUnit.GetShaderID();
     if (vertex_shader == 0)
     {
@@ -20,7 +103,15 @@ Shader::Shader(const ShaderUnit &vertexUnit, const ShaderUnit &fragmentUnit) : s
         return;
     }
 
-    shader_program = Link(vertex_shader, fragment_shader);
+    GLint success = GL_FALSE;
+    shader_program = Link(vertex_shader, fragment_shader, success);
+    if (success)
+    {
+        binary_cache.Store(cache_key, shader_program);
+        ReflectUniforms();
+        BindUniformBlocks();
+        BindSharedTextures();
+    }
 }
 
 Shader::~Shader()
@@ -39,6 +130,7 @@ Shader::~Shader()
          * 相反，它会在不再被使用时才实际销毁。这意味着你可以安全地调用 glDeleteProgram 删除一个仍在渲染管线中使用的程序对象，OpenGL 会确保在适当的时间点释放资源。
         */
         glDeleteProgram(shader_program);
+        GLStateCache::getInstance().OnProgramDeleted(shader_program);
         shader_program = 0;
     }
 }
@@ -61,7 +153,7 @@ void Shader::InnerUse() const
      * 与 uniform 变量的关系:
      *  只有在程序被激活后,才能设置其 uniform 变量的值。
     */
-    glUseProgram(shader_program);
+    GLStateCache::getInstance().UseProgram(shader_program);
 }
 
 void Shader::Use() const
@@ -72,6 +164,7 @@ void Shader::Use() const
     }
 
     InnerUse();
+    FlushUniforms();
 }
 
 bool Shader::IsValidProgram() const
@@ -79,9 +172,20 @@ bool Shader::IsValidProgram() const
     return shader_program > 0;
 }
 
-void Shader::SetTexture(const std::string &name, const Texture *texture)
+GLuint Shader::GetProgramID() const
 {
-    SetInt(name, texture_idx);
+    return shader_program;
+}
+
+void Shader::SetTexture(UniformId id, const Texture *texture)
+{
+    if (texture_idx >= static_cast<int>(SHARED_TEXTURE_UNIT_FIRST))
+    {
+        std::cerr << "Shader SetTexture failed, too many textures!" << std::endl;
+        return;
+    }
+
+    SetInt(id, texture_idx);
 
     texture_tuples.push_back({texture_idx, texture});
 
@@ -89,115 +193,293 @@ void Shader::SetTexture(const std::string &name, const Texture *texture)
 }
 
 // 向shader传递bool值
-void Shader::SetBool(const std::string &name, const GLboolean value) const
+void Shader::SetBool(UniformId id, const GLboolean value) const
 {
-    InnerUse();
-
-    GLint location = GetUniformLocation(name);
-    glUniform1i(location, (GLint)value);
+    const GLint int_value = value;
+    StageUniform(id, 0, &int_value, sizeof(int_value));
 }
 
 // 向shader传递int值
-void Shader::SetInt(const std::string &name, const GLint value) const
+void Shader::SetInt(UniformId id, const GLint value) const
 {
-    InnerUse();
-
-    GLint location = GetUniformLocation(name);
-    glUniform1i(location, value);
+    StageUniform(id, 0, &value, sizeof(value));
 }
 
 // 向shader传递float值
-void Shader::SetFloat(const std::string &name, const GLfloat value) const
+void Shader::SetFloat(UniformId id, const GLfloat value) const
 {
-    InnerUse();
-
-    GLint location = GetUniformLocation(name);
-    glUniform1f(location, value);
+    StageUniform(id, GL_FLOAT, &value, sizeof(value));
 }
 
 // 向shader传递浮点型vec4值
-void Shader::SetFloat4(const std::string &name, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) const
+void Shader::SetFloat4(UniformId id, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) const
 {
-    InnerUse();
+    const GLfloat value[4] = {v0, v1, v2, v3};
+    StageUniform(id, GL_FLOAT_VEC4, value, sizeof(value));
+}
 
-    GLint location = GetUniformLocation(name);
+void Shader::SetMat4f(UniformId id, const glm::mat4 &matrix) const
+{
+    StageUniform(id, GL_FLOAT_MAT4, glm::value_ptr(matrix), sizeof(GLfloat) * 16);
+}
 
-    /*
-     * glUniform4f函数用于设置uniform变量的值，特别是那些类型为四元素浮点向量（vec4）的uniform变量。
-     * 需要先调用glUseProgram，因为它会在当前活动的着色器程序上设置统一变量。
+void Shader::SetMat3f(UniformId id, const glm::mat3 &matrix) const
+{
+    StageUniform(id, GL_FLOAT_MAT3, glm::value_ptr(matrix), sizeof(GLfloat) * 9);
+}
 
-     * 函数原型：GLint glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
-     *  location：uniform变量的位置索引，这个位置是通过glGetUniformLocation函数获取的。
-     *  v0到v3：分别是四元素向量的x、y、z和w分量的值。
-    */
-    glUniform4f(location, v0, v1, v2, v3);
+void Shader::SetVec3f(UniformId id, const glm::vec3 &vector) const
+{
+    StageUniform(id, GL_FLOAT_VEC3, glm::value_ptr(vector), sizeof(GLfloat) * 3);
 }
 
-void Shader::SetMat4f(const std::string &name, const glm::mat4 &matrix) const
+void Shader::StageUniform(UniformId id, GLenum expectedType, const void *value, size_t size) const
 {
-    InnerUse();
+    const UniformSlot *slot = FindSlot(id, expectedType);
+    if (!slot || slot->size != size)
+        return;
 
-    GLuint location = GetUniformLocation(name);
+    // 值没有变化时不需要上传
+    uint8_t *shadow = uniform_values.data() + slot->offset;
+    if (std::memcmp(shadow, value, size) == 0)
+        return;
+    std::memcpy(shadow, value, size);
 
-    /*
-     * glUniformMatrix4fv 是 OpenGL 中用于设置着色器程序中的 uniform 矩阵变量的函数。
-     * 具体来说，它将 4x4 浮点矩阵数组传递给当前激活的着色器程序中的指定 uniform 变量。
-
-     * 函数原型：void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
-     *  location：指定 uniform 变量的位置。这个位置值通常通过调用 glGetUniformLocation 函数获取。
-     *  count：指定要传递的矩阵数量。对于单个 4x4 矩阵，这个值通常是 1。如果你需要传递多个矩阵，可以设置为相应的数量。
-     *  transpose：指定是否要转置矩阵传递给着色器。GL_FALSE 表示矩阵是按列主序存储的（即不转置），GL_TRUE 表示矩阵是按行主序存储的（即需要转置）。大多数情况下，这个值设为 GL_FALSE，因为 OpenGL 使用列主序矩阵。
-     *  value：指向包含矩阵数据的数组的指针。矩阵数据应按照列主序存储，即矩阵的第一个列的元素在数组的前四个位置。
-    */
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
+    const uint32_t slot_idx = static_cast<uint32_t>(slot - uniform_slots.data());
+    if (!dirty_flags[slot_idx])
+    {
+        dirty_flags[slot_idx] = 1;
+        dirty_slots.push_back(slot_idx);
+    }
 }
 
-void Shader::SetMat3f(const std::string &name, const glm::mat3 &matrix) const
+void Shader::FlushUniforms() const
 {
-    InnerUse();
+    for (uint32_t slot_idx : dirty_slots)
+    {
+        const UniformSlot &slot = uniform_slots[slot_idx];
+        const GLfloat *float_value = reinterpret_cast<const GLfloat *>(uniform_values.data() + slot.offset);
+        const GLint *int_value = reinterpret_cast<const GLint *>(uniform_values.data() + slot.offset);
 
-    GLuint location = GetUniformLocation(name);
-    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
+        switch (slot.type)
+        {
+        case GL_FLOAT:
+            glUniform1fv(slot.location, 1, float_value);
+            break;
+        case GL_FLOAT_VEC3:
+            glUniform3fv(slot.location, 1, float_value);
+            break;
+        case GL_FLOAT_VEC4:
+            /*
+             * glUniform4fv函数用于设置uniform变量的值，特别是那些类型为四元素浮点向量（vec4）的uniform变量。
+             * 需要先调用glUseProgram，因为它会在当前活动的着色器程序上设置统一变量。
+
+             * 函数原型：void glUniform4fv(GLint location, GLsizei count, const GLfloat *value);
+             *  location：uniform变量的位置索引，这个位置在链接后反射 uniform 时通过glGetUniformLocation函数获取。
+             *  count：要设置的向量数量，非数组变量为1。
+             *  value：指向四元素向量 x、y、z、w 分量的指针。
+            */
+            glUniform4fv(slot.location, 1, float_value);
+            break;
+        case GL_FLOAT_MAT3:
+            glUniformMatrix3fv(slot.location, 1, GL_FALSE, float_value);
+            break;
+        case GL_FLOAT_MAT4:
+            /*
+             * glUniformMatrix4fv 是 OpenGL 中用于设置着色器程序中的 uniform 矩阵变量的函数。
+             * 具体来说，它将 4x4 浮点矩阵数组传递给当前激活的着色器程序中的指定 uniform 变量。
+
+             * 函数原型：void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+             *  location：指定 uniform 变量的位置。这个位置值通常通过调用 glGetUniformLocation 函数获取。
+             *  count：指定要传递的矩阵数量。对于单个 4x4 矩阵，这个值通常是 1。如果你需要传递多个矩阵，可以设置为相应的数量。
+             *  transpose：指定是否要转置矩阵传递给着色器。GL_FALSE 表示矩阵是按列主序存储的（即不转置），GL_TRUE 表示矩阵是按行主序存储的（即需要转置）。大多数情况下，这个值设为 GL_FALSE，因为 OpenGL 使用列主序矩阵。
+             *  value：指向包含矩阵数据的数组的指针。矩阵数据应按照列主序存储，即矩阵的第一个列的元素在数组的前四个位置。
+            */
+            glUniformMatrix4fv(slot.location, 1, GL_FALSE, float_value);
+            break;
+        default:
+            // 整数、布尔和采样器
+            glUniform1iv(slot.location, 1, int_value);
+            break;
+        }
+
+        dirty_flags[slot_idx] = 0;
+    }
+    dirty_slots.clear();
 }
 
-void Shader::SetVec3f(const std::string &name, const glm::vec3 &vector) const
+void Shader::ReflectUniforms()
 {
-    InnerUse();
+    uniforms.clear();
+    uniform_slots.clear();
+
+    GLint uniform_num = 0;
+    GLint max_name_length = 0;
+    glGetProgramiv(shader_program, GL_ACTIVE_UNIFORMS, &uniform_num);
+    glGetProgramiv(shader_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+    if (uniform_num <= 0 || max_name_length <= 0)
+        return;
 
-    GLuint location = GetUniformLocation(name);
-    glUniform3f(location, vector.x, vector.y, vector.z);
-}
+    uint32_t value_size = 0;
+    auto add_slot = [&](GLint location, GLenum type) {
+        const uint32_t size = GetUniformValueSize(type);
+        uniform_slots.push_back({location, type, value_size, size});
+        value_size += size;
+        return static_cast<uint32_t>(uniform_slots.size() - 1);
+    };
+
+    std::vector<char> name_buffer(static_cast<size_t>(max_name_length));
+    for (GLint idx = 0; idx < uniform_num; idx++)
+    {
+        GLsizei name_length = 0;
+        GLint array_size = 0;
+        GLenum type = 0;
+
+        /*
+         * glGetActiveUniform 返回程序中第 idx 个活跃 uniform 的名字、类型和数组长度。
+         * 数组的名字以 "[0]" 结尾，数组中的每个元素需要分别查询位置。
+        */
+        glGetActiveUniform(shader_program, static_cast<GLuint>(idx), max_name_length, &name_length, &array_size,
+                           &type, name_buffer.data());
+
+        std::string name(name_buffer.data(), static_cast<size_t>(name_length));
+
+        /*
+         * glGetUniformLocation函数用于查询特定uniform变量在给定着色器程序中的位置（位置索引）。
+         * 每个uniform变量在编译和链接着色器程序后都会被分配一个位置，但这个位置不是由开发者指定的，而是由OpenGL决定的。
+         * 只在这里对每个 uniform 查询一次，之后设置 uniform 时只查找反射表。
+         * uniform block 中的变量没有位置（返回-1），需要通过缓冲区设置，不放入表中。
+        */
+        const GLint location = glGetUniformLocation(shader_program, name.c_str());
+        if (location < 0)
+            continue;
+
+        const uint32_t slot = add_slot(location, type);
+        uniforms.push_back({UniformId::Hash(name), slot});
+
+        const size_t bracket_pos = name.rfind("[0]");
+        if (bracket_pos == std::string::npos || bracket_pos + 3 != name.size())
+            continue;
+
+        const std::string base_name = name.substr(0, bracket_pos);
+        uniforms.push_back({UniformId::Hash(base_name), slot});
+
+        for (GLint element = 1; element < array_size; element++)
+        {
+            const std::string element_name = base_name + "[" + std::to_string(element) + "]";
+            const GLint element_location = glGetUniformLocation(shader_program, element_name.c_str());
+            if (element_location >= 0)
+                uniforms.push_back({UniformId::Hash(element_name), add_slot(element_location, type)});
+        }
+    }
+
+    std::sort(uniforms.begin(), uniforms.end(),
+              [](const UniformInfo &lhs, const UniformInfo &rhs) { return lhs.hash < rhs.hash; });
+
+    // 32位哈希在一个程序的几十个 uniform 中几乎不可能碰撞，碰撞时两个变量无法区分，需要改名
+    for (size_t idx = 1; idx < uniforms.size(); idx++)
+    {
+        if (uniforms[idx].hash == uniforms[idx - 1].hash)
+        {
+            std::cerr << "Uniform name hash collision in program " << shader_program << "!" << std::endl;
+        }
+    }
 
-// 获取uniform变量位置
-GLint Shader::GetUniformLocation(const std::string &name) const
-{
     /*
-     * glGetUniformLocation函数用于查询特定uniform变量在给定着色器程序中的位置（位置索引）。
-     * 每个uniform变量在编译和链接着色器程序后都会被分配一个位置，但这个位置不是由开发者指定的，而是由OpenGL决定的。
-     * 为了设置一个uniform变量的值，你需要先知道这个变量在着色器程序中的位置。
-
-     * 函数原型：GLint glGetUniformLocation(GLuint program, const GLchar *name);
-     *  program：已链接的着色器程序的ID。
-     *  name：你想要查询位置的uniform变量的名称，这个名称应与着色器代码中声明的名称匹配。
-     *  返回值：如果查询成功，返回uniform变量的位置索引；如果查询失败（例如，如果变量不存在或者没有被着色器程序使用），返回-1。
+     * 用程序中的当前值初始化CPU端副本（GLSL 中的初始值或0），之后与副本相同的值不需要上传。
+     * 只在链接后查询一次，glGetUniform* 会让驱动同步，不能在每帧调用。
     */
-    GLint location = glGetUniformLocation(shader_program, name.c_str());
-    if (location == -1)
+    uniform_values.assign(value_size, 0);
+    dirty_flags.assign(uniform_slots.size(), 0);
+    dirty_slots.clear();
+    for (const UniformSlot &slot : uniform_slots)
+    {
+        if (slot.size == 0)
+            continue;
+
+        uint8_t *shadow = uniform_values.data() + slot.offset;
+        if (IsIntegerUniform(slot.type))
+            glGetUniformiv(shader_program, slot.location, reinterpret_cast<GLint *>(shadow));
+        else
+            glGetUniformfv(shader_program, slot.location, reinterpret_cast<GLfloat *>(shadow));
+    }
+}
+
+void Shader::BindUniformBlocks()
+{
+    for (GLuint binding = 0; binding < UNIFORM_BLOCK_NUM; binding++)
+    {
+        /*
+         * glGetUniformBlockIndex 查询 uniform block 在程序中的索引，程序没有声明（或没有使用）该 block 时返回 GL_INVALID_INDEX。
+         * glUniformBlockBinding 把该 block 关联到绑定点，block 的数据来自通过 glBindBufferBase 绑定到同一绑定点的缓冲区。
+        */
+        const GLuint block_idx = glGetUniformBlockIndex(shader_program, UNIFORM_BLOCK_NAMES[binding]);
+        if (block_idx != GL_INVALID_INDEX)
+            glUniformBlockBinding(shader_program, block_idx, binding);
+    }
+}
+
+void Shader::BindSharedTextures()
+{
+    for (GLuint unit = SHARED_TEXTURE_UNIT_FIRST; unit < SHARED_TEXTURE_UNIT_END; unit++)
+    {
+        const UniformId id = UniformId::FromString(SHARED_TEXTURE_NAMES[unit - SHARED_TEXTURE_UNIT_FIRST]);
+        if (HasUniform(id))
+            SetInt(id, static_cast<GLint>(unit));
+    }
+}
+
+const Shader::UniformSlot *Shader::FindSlot(UniformId id, GLenum expectedType) const
+{
+    auto iter = std::lower_bound(uniforms.begin(), uniforms.end(), id.GetHash(),
+                                 [](const UniformInfo &info, uint32_t hash) { return info.hash < hash; });
+    if (iter == uniforms.end() || iter->hash != id.GetHash())
+    {
+        ReportUniform(id, "doesn't exist");
+        return nullptr;
+    }
+
+    const UniformSlot &slot = uniform_slots[iter->slot];
+    const bool type_matched = expectedType == 0 ? IsIntegerUniform(slot.type) : slot.type == expectedType;
+    if (!type_matched || slot.size == 0)
     {
-        std::cerr << "Uniform variable '" << name << "' doesn't exist!" << std::endl;
+        ReportUniform(id, "has a different type");
+        return nullptr;
     }
-    return location;
+
+    return &slot;
 }
 
-GLuint Shader::Link(GLuint vertexShader, GLuint fragmentShader)
+void Shader::ReportUniform(UniformId id, const char *reason) const
+{
+    if (std::find(reported_uniforms.begin(), reported_uniforms.end(), id.GetHash()) != reported_uniforms.end())
+        return;
+    reported_uniforms.push_back(id.GetHash());
+
+    if (id.GetName())
+        std::cerr << "Uniform variable '" << id.GetName() << "' " << reason << "!" << std::endl;
+    else
+        std::cerr << "Uniform variable #" << std::hex << id.GetHash() << std::dec << " " << reason << "!" << std::endl;
+}
+
+bool Shader::HasUniform(UniformId id) const
+{
+    return std::binary_search(uniforms.begin(), uniforms.end(), UniformInfo{id.GetHash(), 0},
+                              [](const UniformInfo &lhs, const UniformInfo &rhs) { return lhs.hash < rhs.hash; });
+}
+
+GLuint Shader::Link(GLuint vertexShader, GLuint fragmentShader, GLint &success)
 {
     GLuint program = glCreateProgram();
     glAttachShader(program, vertexShader);
     glAttachShader(program, fragmentShader);
+
+    // 必须在链接之前设置，之后才能用 glGetProgramBinary 取回二进制
+    ProgramBinaryCache::getInstance().PrepareProgram(program);
+
     glLinkProgram(program);
 
     // check for linking errors
-    GLint success;
     glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success)
     {
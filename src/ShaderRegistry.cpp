@@ -0,0 +1,98 @@
+#include "ShaderRegistry.h"
+#include "ShaderUnit.h"
+#include <iostream>
+
+ShaderRegistry::ShaderRegistry()
+{
+}
+
+ShaderRegistry::~ShaderRegistry()
+{
+    /*
+     * 单例在程序退出时才析构，此时OpenGL上下文可能已经销毁，不能再调用 glDeleteProgram，
+     * 所以这里只打印仍未归还的程序，不释放它们。
+    */
+    if (!m_entries.empty())
+    {
+        std::cerr << "ShaderRegistry: " << m_entries.size() << " program(s) still referenced at exit" << std::endl;
+    }
+}
+
+ShaderRegistry &ShaderRegistry::getInstance()
+{
+    static ShaderRegistry instance; // Guaranteed to be destroyed.
+                                    // Instantiated on first use.
+    return instance;
+}
+
+std::string ShaderRegistry::MakeKey(const std::string &vertexPath, const std::string &fragmentPath,
+                                    const std::vector<std::string> &defines)
+{
+    std::string key = vertexPath + '|' + fragmentPath;
+    for (const std::string &define : defines)
+    {
+        key += '|' + define;
+    }
+    return key;
+}
+
+Shader *ShaderRegistry::Acquire(const std::string &vertexPath, const std::string &fragmentPath,
+                                const std::vector<std::string> &defines, bool *isNew)
+{
+    if (isNew)
+        *isNew = false;
+
+    const std::string key = MakeKey(vertexPath, fragmentPath, defines);
+
+    auto iter = m_entries.find(key);
+    if (iter != m_entries.end())
+    {
+        iter->second.ref_count++;
+        return iter->second.shader;
+    }
+
+    ShaderUnit vertex_unit = ShaderUnit(vertexPath, GL_VERTEX_SHADER, defines);
+    ShaderUnit fragment_unit = ShaderUnit(fragmentPath, GL_FRAGMENT_SHADER, defines);
+
+    Shader *shader = new Shader(vertex_unit, fragment_unit);
+    if (!shader->IsValidProgram())
+    {
+        std::cerr << "ShaderRegistry: failed to build program " << key << std::endl;
+        delete shader;
+        return nullptr;
+    }
+
+    m_entries.emplace(key, Entry{shader, 1});
+    m_keys.emplace(shader, key);
+
+    if (isNew)
+        *isNew = true;
+
+    return shader;
+}
+
+void ShaderRegistry::Release(const Shader *shader)
+{
+    if (shader == nullptr)
+        return;
+
+    auto key_iter = m_keys.find(shader);
+    if (key_iter == m_keys.end())
+    {
+        std::cerr << "ShaderRegistry: releasing a program that is not registered" << std::endl;
+        return;
+    }
+
+    auto iter = m_entries.find(key_iter->second);
+    if (--iter->second.ref_count > 0)
+        return;
+
+    delete iter->second.shader;
+    m_entries.erase(iter);
+    m_keys.erase(key_iter);
+}
+
+size_t ShaderRegistry::GetShaderNum() const
+{
+    return m_entries.size();
+}
@@ -1,9 +1,11 @@
 #include "ShaderUnit.h"
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
-ShaderUnit::ShaderUnit(const std::string &path, const GLenum shaderType) : shader_id(0)
+ShaderUnit::ShaderUnit(const std::string &path, const GLenum shaderType, const std::vector<std::string> &defines)
+    : shader_type(shaderType), shader_id(0)
 {
     const std::string shader_content = ReadShaderFile(path);
     if (shader_content.empty())
@@ -12,7 +14,15 @@ ShaderUnit::ShaderUnit(const std::string &path, const GLenum shaderType) : shade
         return;
     }
 
-    shader_id = Compile(shaderType, shader_content);
+    std::string resolved_content;
+    const std::string directory = std::filesystem::path(path).parent_path().string();
+    if (!ResolveIncludes(shader_content, directory, 0, resolved_content))
+    {
+        std::cerr << "Failed to resolve includes of shader file: " << path << std::endl;
+        return;
+    }
+
+    shader_source = InjectDefines(resolved_content, defines);
 }
 
 ShaderUnit::~ShaderUnit()
@@ -26,9 +36,28 @@ ShaderUnit::~ShaderUnit()
 
 GLuint ShaderUnit::GetShaderID() const
 {
+    if (shader_id == 0 && IsValid())
+    {
+        shader_id = Compile(shader_type, shader_source);
+    }
     return shader_id;
 }
 
+const std::string &ShaderUnit::GetSource() const
+{
+    return shader_source;
+}
+
+GLenum ShaderUnit::GetShaderType() const
+{
+    return shader_type;
+}
+
+bool ShaderUnit::IsValid() const
+{
+    return !shader_source.empty();
+}
+
 const std::string ShaderUnit::ReadShaderFile(const std::string &path) const
 {
     const char *file_path = path.c_str();
@@ -64,6 +93,91 @@ const std::string ShaderUnit::ReadShaderFile(const std::string &path) const
     return str_content;
 }
 
+bool ShaderUnit::ResolveIncludes(const std::string &shaderCode, const std::string &directory, int depth,
+                                 std::string &output) const
+{
+    // 防止文件互相引入导致无限递归
+    constexpr int MAX_INCLUDE_DEPTH = 8;
+    if (depth > MAX_INCLUDE_DEPTH)
+    {
+        std::cerr << "Shader includes are nested too deep!" << std::endl;
+        return false;
+    }
+
+    size_t line_begin = 0;
+    while (line_begin < shaderCode.size())
+    {
+        size_t line_end = shaderCode.find('\n', line_begin);
+        if (line_end == std::string::npos)
+            line_end = shaderCode.size();
+        else
+            line_end++;
+
+        const size_t directive_pos = shaderCode.find_first_not_of(" \t", line_begin);
+        if (directive_pos >= line_end || shaderCode.compare(directive_pos, 8, "#include") != 0)
+        {
+            output.append(shaderCode, line_begin, line_end - line_begin);
+            line_begin = line_end;
+            continue;
+        }
+
+        const size_t name_begin = shaderCode.find('"', directive_pos);
+        const size_t name_end = name_begin < line_end ? shaderCode.find('"', name_begin + 1) : std::string::npos;
+        if (name_end == std::string::npos || name_end >= line_end)
+        {
+            std::cerr << "Invalid shader include directive: "
+                      << shaderCode.substr(directive_pos, line_end - directive_pos) << std::endl;
+            return false;
+        }
+
+        const std::string include_name = shaderCode.substr(name_begin + 1, name_end - name_begin - 1);
+        const std::string include_path = (std::filesystem::path(directory) / include_name).string();
+        const std::string include_content = ReadShaderFile(include_path);
+        if (include_content.empty())
+        {
+            std::cerr << "Failed to read shader include file: " << include_path << std::endl;
+            return false;
+        }
+
+        const std::string include_directory = std::filesystem::path(include_path).parent_path().string();
+        if (!ResolveIncludes(include_content, include_directory, depth + 1, output))
+            return false;
+
+        // 被引入的文件最后一行可能没有换行符
+        if (output.empty() || output.back() != '\n')
+            output += '\n';
+
+        line_begin = line_end;
+    }
+
+    return true;
+}
+
+std::string ShaderUnit::InjectDefines(const std::string &shaderCode, const std::vector<std::string> &defines)
+{
+    if (defines.empty())
+        return shaderCode;
+
+    std::string define_lines;
+    for (const std::string &define : defines)
+    {
+        define_lines += "#define " + define + "\n";
+    }
+
+    /*
+     * GLSL 要求 #version 必须是源码中的第一条语句，所以宏定义只能插入到 #version 所在行的后面。
+    */
+    size_t version_pos = shaderCode.find("#version");
+    if (version_pos == std::string::npos)
+        return define_lines + shaderCode;
+
+    size_t line_end = shaderCode.find('\n', version_pos);
+    if (line_end == std::string::npos)
+        return shaderCode + "\n" + define_lines;
+
+    return shaderCode.substr(0, line_end + 1) + define_lines + shaderCode.substr(line_end + 1);
+}
+
 GLuint ShaderUnit::Compile(GLenum shaderType, const std::string &shaderCode)
 {
     GLenum shader_type = shaderType;
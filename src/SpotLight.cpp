@@ -1,13 +1,40 @@
 #include "SpotLight.h"
-#include "BaseLight.h"
 #include "glm/fwd.hpp"
 
 SpotLight::SpotLight(const glm::vec3 &position, const glm::vec3 &direction, const GLfloat cutOff,
-                     const glm::vec3 &ambient, const glm::vec3 &diffuse, const glm::vec3 &specular)
-    : BaseLight(ambient, diffuse, specular), m_position(position), m_direction(direction), m_cutOff(cutOff)
+                     const GLfloat outerCutOff, const GLfloat linear, const GLfloat quadratic,
+                     const glm::vec3 &ambient, const glm::vec3 &diffuse, const glm::vec3 &specular,
+                     const GLfloat constant)
+    : PointLight(position, linear, quadratic, ambient, diffuse, specular, constant), m_direction(direction),
+      m_cutOff(cutOff), m_outerCutOff(outerCutOff)
 {
 }
 
 SpotLight::~SpotLight()
 {
-}
\ No newline at end of file
+}
+
+LightType SpotLight::GetType() const
+{
+    return LightType::Spot;
+}
+
+const glm::vec3 &SpotLight::GetDirection() const
+{
+    return m_direction;
+}
+
+void SpotLight::SetDirection(const glm::vec3 &direction)
+{
+    m_direction = direction;
+}
+
+GLfloat SpotLight::GetCutOff() const
+{
+    return m_cutOff;
+}
+
+GLfloat SpotLight::GetOuterCutOff() const
+{
+    return m_outerCutOff;
+}
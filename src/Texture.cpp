@@ -1,4 +1,5 @@
 #include "Texture.h"
+#include "GLStateCache.h"
 #include <iostream>
 
 Texture::Texture() : texture_id(0)
@@ -20,6 +21,7 @@ Texture::~Texture()
          *  textures：一个包含要删除的纹理对象名称（ID）的数组。
         */
         glDeleteTextures(1, &texture_id);
+        GLStateCache::getInstance().OnTextureDeleted(texture_id);
         texture_id = 0;
     }
 }
@@ -51,10 +53,10 @@ void Texture::Use(int idx) const
      *  允许在一个绘制调用中使用多个纹理。
      *  每个纹理可以绑定到不同的纹理单元。
     */
-    glActiveTexture(GL_TEXTURE0 + idx);
-
     GLenum target = GetTextureTarget();
-    glBindTexture(target, texture_id);
+
+    // 纹理单元上已经绑定了同一个纹理时（连续绘制使用相同的材质），不会产生任何GL调用
+    GLStateCache::getInstance().BindTextureUnit(static_cast<GLuint>(idx), target, texture_id);
 }
 
 bool Texture::IsValidTexture() const
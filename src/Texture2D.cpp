@@ -1,7 +1,9 @@
 #include "Texture2D.h"
+#include "GLStateCache.h"
 #include "Texture.h"
-#include "stb_image.h"
+#include "TextureStreamer.h"
 #include "iostream"
+#include <filesystem>
 
 Texture2D *Texture2D::white_2d_texture = nullptr;
 Texture2D *Texture2D::black_2d_texture = nullptr;
@@ -24,20 +26,70 @@ Texture2D *Texture2D::GetBlack2DTexture()
     return black_2d_texture;
 }
 
-Texture2D::Texture2D(const char *filePath, GLenum format, GLint wrapMode)
-    : Texture(), width(0), height(0), channel_num(0)
+Texture2D::Texture2D(const char *filePath, GLenum format, GLint wrapMode, bool async, TextureCompression compression,
+                     bool srgb)
+    : Texture(), width(0), height(0), channel_num(0), ready(false), stream_job(0)
 {
-    InnerInit(filePath, format, wrapMode);
+    if (compression != TextureCompression::None && !TextureCooker::IsSupported(compression))
+        compression = TextureCompression::None;
+
+    if (async)
+        InnerInitAsync(filePath, format, wrapMode, compression, srgb);
+    else
+        InnerInit(filePath, format, wrapMode, compression, srgb);
 }
 
 Texture2D::~Texture2D()
 {
+    // 解码尚未完成时取消任务，避免流式加载器向已销毁的纹理上传数据
+    if (stream_job != 0)
+        TextureStreamer::getInstance().Cancel(stream_job);
 }
 
-bool Texture2D::InnerInit(const char *filePath, GLenum format, GLint wrapMode)
+bool Texture2D::InnerInitAsync(const char *filePath, GLenum format, GLint wrapMode, TextureCompression compression,
+                               bool srgb)
 {
+    // 文件不存在时直接失败，保持与同步加载一致：IsValidTexture 返回 false
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(filePath, error))
+    {
+        std::cerr << "Texture2D load failed!" << std::endl;
+        return false;
+    }
+
+    // 先创建纹理名称并设置参数，图片数据在解码完成后由 TextureStreamer 上传
+    glGenTextures(1, &texture_id);
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, texture_id);
+    SetupParameters(wrapMode);
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, 0);
+
+    stream_job = TextureStreamer::getInstance().Enqueue(this, filePath, format, compression, srgb);
+
+    return true;
+}
+
+bool Texture2D::InnerInit(const char *filePath, GLenum format, GLint wrapMode, TextureCompression compression,
+                          bool srgb)
+{
+    if (compression != TextureCompression::None)
+    {
+        // 烘焙失败（例如缓存目录不可写且图片无法解码）时继续尝试未压缩的加载方式
+        CookedTexture cooked;
+        if (TextureCooker::Cook(filePath, compression, cooked))
+        {
+            glGenTextures(1, &texture_id);
+            GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, texture_id);
+            SetupParameters(wrapMode);
+            UploadCompressed(cooked, cooked.data.data());
+            GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, 0);
+
+            ready = true;
+            return true;
+        }
+    }
+
     /*
-     * 该函数用于在加载纹理时上下翻转图像。
+     * MipChainBuilder::Load 在解码时会上下翻转图像。
 
      * 在OpenGL中，进行纹理映射后渲染出来的图像出现上下颠倒的情况是很常见的。这主要是因为OpenGL和大多数图像文件格式在坐标系统上存在差异。
 
@@ -49,25 +101,14 @@ bool Texture2D::InnerInit(const char *filePath, GLenum format, GLint wrapMode)
      * 加载图像时的影响：
      *    当你加载一个图像作为纹理时，通常图像数据是从顶部到底部存储的。但是当你在OpenGL中使用这些数据时，它会从底部开始渲染，导致图像看起来是上下颠倒的。
     */
-    stbi_set_flip_vertically_on_load(true);
-
-    unsigned char *data = stbi_load(filePath, &width, &height, &channel_num, 0);
-    if (!data)
+    MipChain chain;
+    if (!MipChainBuilder::Load(filePath, srgb, chain))
     {
         std::cerr << "Texture2D load failed!" << std::endl;
         return false;
     }
 
-    // 自动确定纹理的格式
-    if (format == 0)
-    {
-        if (channel_num == 1)
-            format = GL_RED;
-        else if (channel_num == 3)
-            format = GL_RGB;
-        else if (channel_num == 4)
-            format = GL_RGBA;
-    }
+    format = GetFormat(chain.channel_num, format);
 
     /*
      * glGenTextures是OpenGL中用于生成纹理对象名称的函数。
@@ -86,8 +127,22 @@ bool Texture2D::InnerInit(const char *filePath, GLenum format, GLint wrapMode)
      *  target: 指定纹理的类型,如GL_TEXTURE_2D, GL_TEXTURE_3D等。
      *  texture: 要绑定的纹理对象的名称(unsigned int)。
     */
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, texture_id);
+
+    SetupParameters(wrapMode);
+
+    UploadMipChain(chain, chain.data.data(), format);
+
+    // 解除绑定纹理
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, 0);
 
+    ready = true;
+
+    return true;
+}
+
+void Texture2D::SetupParameters(GLint wrapMode)
+{
     /*
      * 设置水平方向（S轴）和垂直方向（T轴）的纹理wrapping方式，此处为重复纹理。
 
@@ -127,6 +182,19 @@ bool Texture2D::InnerInit(const char *filePath, GLenum format, GLint wrapMode)
     */
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+void Texture2D::UploadMipChain(const MipChain &chain, const uint8_t *data, GLenum format)
+{
+    width = chain.width;
+    height = chain.height;
+    channel_num = chain.channel_num;
+
+    // 像素数据的格式由通道数决定，format 只决定纹理在GPU中的存储格式
+    const GLenum pixel_format = GetFormat(chain.channel_num, 0);
+
+    // 1/3通道图片的行长度不一定是4的倍数，按1字节对齐解包
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
     /*
      * 该函数用于定义二维纹理图像的数据。
@@ -155,35 +223,101 @@ bool Texture2D::InnerInit(const char *filePath, GLenum format, GLint wrapMode)
      *  使用glGetError检查可能的错误。
      *  在调用此函数之前，确保正确的纹理已被绑定。
     */
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-
     /*
-     * 该函数用于为当前绑定的纹理自动生成完整的mipmap链。
+     * Mipmap 是纹理的一系列预计算的缩小版本，用于提高渲染速度和减少混叠（aliasing）效果。
+     * 各级在CPU上预先生成（见 MipChainBuilder），这里逐级调用 glTexImage2D 上传，不再使用 glGenerateMipmap。
+    */
+    for (size_t level = 0; level < chain.levels.size(); level++)
+    {
+        const MipLevel &mip_level = chain.levels[level];
+        const void *pixels = data ? static_cast<const void *>(data + mip_level.offset)
+                                  : reinterpret_cast<const void *>(mip_level.offset);
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), format, mip_level.width, mip_level.height, 0,
+                     pixel_format, GL_UNSIGNED_BYTE, pixels);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(chain.levels.size()) - 1);
 
-     * Mipmap 是纹理的一系列预计算的缩小版本，用于提高渲染速度和减少混叠（aliasing）效果，通常只在纹理缩小时使用，放大不使用 mipmap。
-     * 每个级别的尺寸是上一级的一半，直到1x1像素，从原始纹理开始，逐步创建更小的版本，使用高质量的缩小算法（通常是线性过滤）。
-     * 生成mipmap需要一定的计算时间，但通常比在渲染时动态缩小纹理更高效，增加了约33%的纹理内存使用，额外内存用于存储所有mipmap级别。
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
 
-     * 函数原型：void glGenerateMipmap(GLenum target);
-     *  target: 指定纹理目标，如GL_TEXTURE_2D, GL_TEXTURE_3D等。
+void Texture2D::UploadCompressed(const CookedTexture &cooked, const uint8_t *data)
+{
+    width = cooked.width;
+    height = cooked.height;
 
-     * 注意事项：
-     *  在调用glGenerateMipmap之前，必须已经为基本级别（level 0）定义了纹理数据。
-     *  确保在调用时正确的纹理已被绑定。
-     *  对于非2的幂大小的纹理，某些OpenGL实现可能不支持mipmap生成。
-     *  要使用生成的mipmap，需要设置适当的纹理过滤模式（如GL_LINEAR_MIPMAP_LINEAR）。
-     *  如果需要更精细的控制，可以手动为每个mipmap级别调用glTexImage2D。
-     *  对于频繁更新的纹理，重复调用此函数可能影响性能。
-     *  对于某些压缩纹理格式，可能需要手动提供所有mipmap级别。
+    switch (cooked.format)
+    {
+    case BCFormat::BC1:
+        channel_num = 3;
+        break;
+    case BCFormat::BC3:
+        channel_num = 4;
+        break;
+    case BCFormat::BC4:
+        channel_num = 1;
+        break;
+    case BCFormat::BC5:
+        channel_num = 2;
+        break;
+    }
+
+    /*
+     * 压缩纹理不能使用 glGenerateMipmap，每一级都由 glCompressedTexImage2D 直接提供。
+     * imageSize 必须与格式和尺寸精确对应：每个 4x4 块 8 或 16 字节，不足一块的按一块计算。
     */
-    glGenerateMipmap(GL_TEXTURE_2D);
+    const GLenum gl_format = BCnEncoder::GetGLFormat(cooked.format);
+    for (size_t level = 0; level < cooked.levels.size(); level++)
+    {
+        const CookedLevel &cooked_level = cooked.levels[level];
+        const void *pixels = data ? static_cast<const void *>(data + cooked_level.offset)
+                                  : reinterpret_cast<const void *>(cooked_level.offset);
+        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), gl_format, cooked_level.width,
+                               cooked_level.height, 0, static_cast<GLsizei>(cooked_level.size), pixels);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(cooked.levels.size()) - 1);
 
-    // 解除绑定纹理
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // BC4 只有 R 通道，复制到 G、B 后着色器中按 .rgb 采样的结果与未压缩的灰度图一致
+    if (cooked.format == BCFormat::BC4)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    }
+}
+
+GLenum Texture2D::GetFormat(int channelNum, GLenum format)
+{
+    // 自动确定纹理的格式
+    if (format == 0)
+    {
+        if (channelNum == 1)
+            format = GL_RED;
+        else if (channelNum == 3)
+            format = GL_RGB;
+        else if (channelNum == 4)
+            format = GL_RGBA;
+    }
+    return format;
+}
 
-    stbi_image_free(data);
+void Texture2D::Use(int idx) const
+{
+    if (!ready)
+    {
+        // 数据尚未就绪时绑定默认白色纹理作为占位，避免采样到未定义的纹理内容
+        Texture2D *placeholder = GetWhite2DTexture();
+        if (placeholder != this)
+        {
+            placeholder->Use(idx);
+            return;
+        }
+    }
 
-    return true;
+    Texture::Use(idx);
+}
+
+bool Texture2D::IsReady() const
+{
+    return ready;
 }
 
 GLsizei Texture2D::GetWidth() const
@@ -0,0 +1,61 @@
+#include "TextureBuffer.h"
+#include "GLStateCache.h"
+#include <iostream>
+
+TextureBuffer::TextureBuffer(GLenum internalFormat, size_t capacity)
+    : Texture(), buffer_id(0), internal_format(internalFormat), capacity(capacity)
+{
+    glGenBuffers(1, &buffer_id);
+    if (buffer_id == 0)
+    {
+        std::cerr << "TextureBuffer init failed!" << std::endl;
+        return;
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer_id);
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    /*
+     * glTexBuffer 把缓冲区对象关联到当前绑定的缓冲区纹理，纹理本身不保存数据，
+     * 之后对缓冲区的修改在着色器中直接可见，不需要重新关联。
+    */
+    glGenTextures(1, &texture_id);
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_BUFFER, texture_id);
+    glTexBuffer(GL_TEXTURE_BUFFER, internal_format, buffer_id);
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+TextureBuffer::~TextureBuffer()
+{
+    if (buffer_id != 0)
+    {
+        glDeleteBuffers(1, &buffer_id);
+        buffer_id = 0;
+    }
+}
+
+GLenum TextureBuffer::GetTextureTarget() const
+{
+    return GL_TEXTURE_BUFFER;
+}
+
+bool TextureBuffer::Update(const void *data, size_t size)
+{
+    if (buffer_id == 0 || size > capacity)
+        return false;
+
+    // 先废弃旧的存储（orphaning），上一帧仍在使用旧数据的绘制不会阻塞这次上传
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer_id);
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+    if (size > 0)
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    return true;
+}
+
+size_t TextureBuffer::GetCapacity() const
+{
+    return capacity;
+}
@@ -0,0 +1,289 @@
+#include "TextureCooker.h"
+#include "MappedFile.h"
+#include "MipChainBuilder.h"
+#include "ThreadPool.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+const char CACHE_MAGIC[4] = {'L', 'G', 'T', 'C'};
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t source_hash;
+    uint32_t compression;
+    uint32_t format;
+    int32_t width;
+    int32_t height;
+    uint32_t level_num;
+    uint32_t padding;
+};
+
+struct LevelHeader
+{
+    int32_t width;
+    int32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+BCFormat ChooseFormat(TextureCompression compression, const uint8_t *rgba, size_t pixelNum)
+{
+    switch (compression)
+    {
+    case TextureCompression::Grayscale:
+        return BCFormat::BC4;
+    case TextureCompression::Normal:
+        return BCFormat::BC5;
+    default:
+        break;
+    }
+
+    // 只有存在非不透明像素时才需要 BC3 的 alpha 通道
+    for (size_t idx = 0; idx < pixelNum; idx++)
+    {
+        if (rgba[idx * 4 + 3] != 255)
+            return BCFormat::BC3;
+    }
+    return BCFormat::BC1;
+}
+} // namespace
+
+std::string TextureCooker::GetCachePath(const std::string &sourcePath)
+{
+    return sourcePath + ".bctex";
+}
+
+bool TextureCooker::Cook(const std::string &sourcePath, TextureCompression compression, CookedTexture &cooked)
+{
+    if (compression == TextureCompression::None)
+        return false;
+
+    MappedFile source;
+    if (!source.Open(sourcePath))
+    {
+        std::cerr << "TextureCooker: failed to open " << sourcePath << std::endl;
+        return false;
+    }
+
+    const uint64_t source_hash = source.ComputeHash();
+    const std::string cache_path = GetCachePath(sourcePath);
+    if (ReadCache(cache_path, source_hash, compression, cooked))
+        return true;
+
+    // 与未压缩的加载方式保持一致，上下翻转图片；工作线程中使用线程局部的翻转设置
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    int width = 0, height = 0, channel_num = 0;
+    unsigned char *pixels = stbi_load_from_memory(source.GetData(), static_cast<int>(source.GetSize()), &width,
+                                                  &height, &channel_num, 4);
+    if (!pixels)
+    {
+        std::cerr << "TextureCooker: failed to decode " << sourcePath << std::endl;
+        return false;
+    }
+
+    const size_t pixel_num = static_cast<size_t>(width) * height;
+
+    if (compression == TextureCompression::Grayscale)
+    {
+        // 灰度贴图可能保存为RGB，取三个通道的平均值
+        for (size_t idx = 0; idx < pixel_num; idx++)
+        {
+            uint8_t *p = pixels + idx * 4;
+            p[0] = static_cast<uint8_t>((p[0] + p[1] + p[2] + 1) / 3);
+        }
+    }
+
+    // 只有颜色贴图是 sRGB 编码的，灰度和法线贴图保存的是线性数据
+    MipChain chain;
+    MipChainBuilder::Build(pixels, width, height, 4, compression == TextureCompression::Color, chain);
+    stbi_image_free(pixels);
+
+    cooked.format = ChooseFormat(compression, chain.data.data(), pixel_num);
+    cooked.width = width;
+    cooked.height = height;
+    cooked.levels.clear();
+    cooked.data.clear();
+
+    for (const MipLevel &mip_level : chain.levels)
+    {
+        CookedLevel level;
+        level.width = mip_level.width;
+        level.height = mip_level.height;
+        level.offset = cooked.data.size();
+        level.size = BCnEncoder::GetCompressedSize(cooked.format, mip_level.width, mip_level.height);
+        cooked.levels.push_back(level);
+    }
+    cooked.data.resize(cooked.levels.back().offset + cooked.levels.back().size);
+
+    // 各级的编码互相独立，在线程池中并行
+    ThreadPool::getInstance().ParallelFor(chain.levels.size(), [&](size_t level) {
+        const MipLevel &mip_level = chain.levels[level];
+        BCnEncoder::Encode(cooked.format, chain.data.data() + mip_level.offset, mip_level.width, mip_level.height,
+                           cooked.data.data() + cooked.levels[level].offset);
+    });
+
+    WriteCache(cache_path, source_hash, compression, cooked);
+
+    return true;
+}
+
+bool TextureCooker::ReadCache(const std::string &cachePath, uint64_t sourceHash, TextureCompression compression,
+                              CookedTexture &cooked)
+{
+    MappedFile file;
+    if (!file.Open(cachePath))
+        return false;
+
+    const uint8_t *cur = file.GetData();
+    const uint8_t *end = cur + file.GetSize();
+
+    FileHeader header;
+    if (static_cast<size_t>(end - cur) < sizeof(header))
+        return false;
+    std::memcpy(&header, cur, sizeof(header));
+    cur += sizeof(header);
+
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != VERSION ||
+        header.source_hash != sourceHash || header.compression != static_cast<uint32_t>(compression))
+        return false;
+
+    const BCFormat format = static_cast<BCFormat>(header.format);
+    if (format != BCFormat::BC1 && format != BCFormat::BC3 && format != BCFormat::BC4 && format != BCFormat::BC5)
+        return false;
+
+    if (header.level_num == 0 || static_cast<size_t>(end - cur) / sizeof(LevelHeader) < header.level_num)
+        return false;
+
+    std::vector<CookedLevel> levels(header.level_num);
+    for (CookedLevel &level : levels)
+    {
+        LevelHeader level_header;
+        std::memcpy(&level_header, cur, sizeof(level_header));
+        cur += sizeof(level_header);
+
+        level.width = level_header.width;
+        level.height = level_header.height;
+        level.offset = static_cast<size_t>(level_header.offset);
+        level.size = static_cast<size_t>(level_header.size);
+    }
+
+    // 每一级的数据范围都不能超出文件，且大小必须与尺寸一致，防止损坏或截断的缓存导致越界上传
+    const size_t data_size = static_cast<size_t>(end - cur);
+    for (const CookedLevel &level : levels)
+    {
+        if (level.width <= 0 || level.height <= 0 || level.offset > data_size || level.size > data_size - level.offset ||
+            level.size != BCnEncoder::GetCompressedSize(format, level.width, level.height))
+        {
+            std::cerr << "Texture cache is corrupted: " << cachePath << std::endl;
+            return false;
+        }
+    }
+
+    cooked.format = format;
+    cooked.width = header.width;
+    cooked.height = header.height;
+    cooked.levels = std::move(levels);
+    cooked.data.assign(cur, end);
+
+    return true;
+}
+
+bool TextureCooker::WriteCache(const std::string &cachePath, uint64_t sourceHash, TextureCompression compression,
+                               const CookedTexture &cooked)
+{
+    // 先写入临时文件再重命名，避免写入中途失败时留下半个缓存文件
+    const std::string temp_path = cachePath + ".tmp";
+
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            std::cerr << "Failed to create texture cache: " << cachePath << std::endl;
+            return false;
+        }
+
+        FileHeader header;
+        std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = VERSION;
+        header.source_hash = sourceHash;
+        header.compression = static_cast<uint32_t>(compression);
+        header.format = static_cast<uint32_t>(cooked.format);
+        header.width = cooked.width;
+        header.height = cooked.height;
+        header.level_num = static_cast<uint32_t>(cooked.levels.size());
+        header.padding = 0;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        for (const CookedLevel &level : cooked.levels)
+        {
+            LevelHeader level_header;
+            level_header.width = level.width;
+            level_header.height = level.height;
+            level_header.offset = level.offset;
+            level_header.size = level.size;
+            out.write(reinterpret_cast<const char *>(&level_header), sizeof(level_header));
+        }
+
+        out.write(reinterpret_cast<const char *>(cooked.data.data()), static_cast<std::streamsize>(cooked.data.size()));
+
+        if (!out.good())
+        {
+            std::cerr << "Failed to write texture cache: " << cachePath << std::endl;
+            out.close();
+            std::error_code error;
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, cachePath, error);
+    if (error)
+    {
+        std::cerr << "Failed to write texture cache: " << cachePath << ", " << error.message() << std::endl;
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+
+    return true;
+}
+
+bool TextureCooker::IsSupported(TextureCompression compression)
+{
+    // RGTC（BC4/BC5）是 OpenGL 3.0 的核心格式，部分驱动不会在格式列表中列出，但一定支持
+    if (compression == TextureCompression::Grayscale || compression == TextureCompression::Normal)
+        return true;
+    if (compression != TextureCompression::Color)
+        return false;
+
+    // 驱动支持的格式在运行期间不会变化，只查询一次
+    static std::vector<GLint> supported_formats;
+    static bool queried = false;
+    if (!queried)
+    {
+        GLint format_num = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &format_num);
+        supported_formats.resize(static_cast<size_t>(std::max(format_num, 0)));
+        if (format_num > 0)
+            glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, supported_formats.data());
+        queried = true;
+    }
+
+    // 颜色贴图在烘焙时才能确定使用 BC1 还是 BC3，两者都需要支持
+    for (BCFormat format : {BCFormat::BC1, BCFormat::BC3})
+    {
+        const GLint gl_format = static_cast<GLint>(BCnEncoder::GetGLFormat(format));
+        if (std::find(supported_formats.begin(), supported_formats.end(), gl_format) == supported_formats.end())
+            return false;
+    }
+    return true;
+}
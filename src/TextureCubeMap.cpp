@@ -1,6 +1,10 @@
 #include "TextureCubeMap.h"
+#include "GLStateCache.h"
+#include "MipChainBuilder.h"
 #include "Texture.h"
+#include "ThreadPool.h"
 #include "stb_image.h"
+#include <atomic>
 #include <iostream>
 
 TextureCubeMap::TextureCubeMap(const std::vector<const char *> &faces)
@@ -14,6 +18,75 @@ TextureCubeMap::~TextureCubeMap()
 
 bool TextureCubeMap::InnerInit(const std::vector<const char *> &faces)
 {
+    if (faces.size() != FACE_NUM)
+    {
+        std::cerr << "Cubemap requires " << FACE_NUM << " faces, got " << faces.size() << std::endl;
+        return false;
+    }
+
+    /*
+	 * 先只读取各个面的文件头，确认尺寸和通道数一致后一次性分配所有面（包括 mip 链）的暂存内存，
+	 * 再在线程池中并行解码并生成 mip 链，各个面直接写入暂存内存中属于自己的区域。
+	*/
+    int width = 0, height = 0, channel_num = 0;
+    for (unsigned int idx = 0; idx < FACE_NUM; idx++)
+    {
+        int face_width, face_height, face_channel_num;
+        if (!stbi_info(faces[idx], &face_width, &face_height, &face_channel_num))
+        {
+            std::cerr << "Cubemap texture failed to load at path: " << faces[idx] << std::endl;
+            return false;
+        }
+
+        if (idx == 0)
+        {
+            width = face_width;
+            height = face_height;
+            channel_num = face_channel_num;
+        }
+        else if (face_width != width || face_height != height || face_channel_num != channel_num)
+        {
+            std::cerr << "Cubemap face " << faces[idx] << " is " << face_width << "x" << face_height << "x"
+                      << face_channel_num << ", expected " << width << "x" << height << "x" << channel_num
+                      << std::endl;
+            return false;
+        }
+    }
+
+    if (width != height || (channel_num != 3 && channel_num != 4))
+    {
+        std::cerr << "Cubemap faces must be square RGB/RGBA images: " << faces[0] << std::endl;
+        return false;
+    }
+
+    std::vector<MipLevel> levels;
+    const size_t face_size = MipChainBuilder::ComputeLevels(width, height, channel_num, levels);
+    std::vector<uint8_t> staging(face_size * FACE_NUM);
+
+    std::atomic<bool> valid{true};
+    ThreadPool::getInstance().ParallelFor(FACE_NUM, [&](size_t idx) {
+        // 立方体贴图的各个面不翻转，工作线程中使用线程局部的设置，不受2D纹理加载的影响
+        stbi_set_flip_vertically_on_load_thread(false);
+
+        int face_width, face_height, face_channel_num;
+        unsigned char *data = stbi_load(faces[idx], &face_width, &face_height, &face_channel_num, 0);
+        if (!data || face_width != width || face_height != height || face_channel_num != channel_num)
+        {
+            // 文件在读取文件头之后被修改，或者文件头与实际数据不符
+            std::cerr << "Cubemap texture failed to load at path: " << faces[idx] << std::endl;
+            valid = false;
+        }
+        else
+        {
+            MipChainBuilder::BuildInto(data, width, height, channel_num, true, levels,
+                                       staging.data() + idx * face_size);
+        }
+        stbi_image_free(data);
+    });
+
+    if (!valid)
+        return false;
+
     /*
 	 * 分配一个未使用的纹理对象名称（即纹理ID），用于后续的纹理操作。
 	*/
@@ -29,13 +102,14 @@ bool TextureCubeMap::InnerInit(const std::vector<const char *> &faces)
 	 * 	GL_TEXTURE_CUBE_MAP_POSITIVE_Z (前面)
 	 * 	GL_TEXTURE_CUBE_MAP_NEGATIVE_Z (后面)
 	*/
-    glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id);
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_CUBE_MAP, texture_id);
 
     /*
 	 * 设置纹理的过滤参数，控制纹理在缩小和放大时的采样方式。
+	 * 各个面带有完整的 mip 链，反射/折射到较小的物体上时使用三线性过滤减少闪烁。
 	*/
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
     /*
 	 * 设置x方向（S轴）和y方向（T轴）和z方向（R轴）的纹理wrapping方式
@@ -44,24 +118,39 @@ bool TextureCubeMap::InnerInit(const std::vector<const char *> &faces)
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-    unsigned char *data = nullptr;
-    int width, height, channel_num;
-    for (unsigned int idx = 0; idx < faces.size(); idx++)
+    const GLenum format = channel_num == 4 ? GL_RGBA : GL_RGB;
+    const GLsizei level_num = static_cast<GLsizei>(levels.size());
+
+    // 1/3通道图片的行长度不一定是4的倍数，按1字节对齐解包
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    /*
+	 * OpenGL 4.2 起可以用 glTexStorage2D 一次分配所有面和所有级别的不可变存储，
+	 * 驱动不需要在每次 glTexImage2D 时重新检查纹理是否完整，之后用 glTexSubImage2D 填充数据。
+	*/
+    const bool immutable = GLAD_GL_VERSION_4_2;
+    if (immutable)
+        glTexStorage2D(GL_TEXTURE_CUBE_MAP, level_num, channel_num == 4 ? GL_RGBA8 : GL_RGB8, width, height);
+
+    for (unsigned int idx = 0; idx < FACE_NUM; idx++)
     {
-        data = stbi_load(faces[idx], &width, &height, &channel_num, 0);
-        if (!data)
+        const uint8_t *face = staging.data() + idx * face_size;
+        for (GLsizei level = 0; level < level_num; level++)
         {
-            std::cerr << "Cubemap texture failed to load at path: " << faces[idx] << std::endl;
-            return false;
+            const MipLevel &mip_level = levels[level];
+            if (immutable)
+                glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + idx, level, 0, 0, mip_level.width, mip_level.height,
+                                format, GL_UNSIGNED_BYTE, face + mip_level.offset);
+            else
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + idx, level, format, mip_level.width, mip_level.height, 0,
+                             format, GL_UNSIGNED_BYTE, face + mip_level.offset);
         }
-
-        int format = channel_num == 4 ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + idx, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-
-        stbi_image_free(data);
     }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, level_num - 1);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
     return true;
 }
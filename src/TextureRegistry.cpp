@@ -0,0 +1,94 @@
+#include "TextureRegistry.h"
+#include <filesystem>
+#include <iostream>
+
+TextureRegistry::TextureRegistry()
+{
+}
+
+TextureRegistry::~TextureRegistry()
+{
+    /*
+     * 单例在程序退出时才析构，此时OpenGL上下文可能已经销毁，不能再调用 glDeleteTextures，
+     * 所以这里只打印仍未归还的纹理，不释放它们。
+    */
+    if (!m_entries.empty())
+    {
+        std::cerr << "TextureRegistry: " << m_entries.size() << " texture(s) still referenced at exit" << std::endl;
+    }
+}
+
+TextureRegistry &TextureRegistry::getInstance()
+{
+    static TextureRegistry instance; // Guaranteed to be destroyed.
+                                     // Instantiated on first use.
+    return instance;
+}
+
+std::string TextureRegistry::MakeKey(const std::string &filePath, GLenum format, GLint wrapMode,
+                                     TextureCompression compression, bool srgb)
+{
+    /*
+     * 同一个文件可能以不同的相对路径被引用（例如 "../textures/wall.jpg" 和 "../textures/./wall.jpg"），
+     * 规范化后才能识别为同一张图片。文件不存在时 weakly_canonical 也能返回词法规范化后的路径。
+    */
+    std::error_code error;
+    std::filesystem::path canonical_path = std::filesystem::weakly_canonical(filePath, error);
+    if (error)
+        canonical_path = std::filesystem::path(filePath).lexically_normal();
+
+    return canonical_path.generic_string() + '|' + std::to_string(format) + '|' + std::to_string(wrapMode) + '|' +
+           std::to_string(static_cast<uint32_t>(compression)) + '|' + (srgb ? "srgb" : "linear");
+}
+
+Texture2D *TextureRegistry::Acquire(const std::string &filePath, GLenum format, GLint wrapMode, bool async,
+                                    TextureCompression compression, bool srgb)
+{
+    const std::string key = MakeKey(filePath, format, wrapMode, compression, srgb);
+
+    auto iter = m_entries.find(key);
+    if (iter != m_entries.end())
+    {
+        iter->second.ref_count++;
+        return iter->second.texture;
+    }
+
+    Texture2D *texture = new Texture2D(filePath.c_str(), format, wrapMode, async, compression, srgb);
+    if (!texture->IsValidTexture())
+    {
+        std::cerr << "TextureRegistry: failed to load texture " << filePath << std::endl;
+        delete texture;
+        return nullptr;
+    }
+
+    m_entries.emplace(key, Entry{texture, 1});
+    m_keys.emplace(texture, key);
+
+    return texture;
+}
+
+void TextureRegistry::Release(const Texture2D *texture)
+{
+    if (texture == nullptr)
+        return;
+
+    auto key_iter = m_keys.find(texture);
+    if (key_iter == m_keys.end())
+    {
+        std::cerr << "TextureRegistry: releasing a texture that is not registered" << std::endl;
+        return;
+    }
+
+    auto iter = m_entries.find(key_iter->second);
+    if (--iter->second.ref_count > 0)
+        return;
+
+    delete iter->second.texture;
+    m_entries.erase(iter);
+    m_keys.erase(key_iter);
+}
+
+size_t TextureRegistry::GetTextureNum() const
+{
+    return m_entries.size();
+}
@@ -0,0 +1,190 @@
+#include "TextureStreamer.h"
+#include "GLStateCache.h"
+#include "Texture2D.h"
+#include "ThreadPool.h"
+#include <cstring>
+#include <iostream>
+
+TextureStreamer::TextureStreamer()
+    : m_completed(std::make_shared<CompletedQueue>()), m_next_job_id(1), m_pbos{}, m_pbo_capacity{}, m_pbo_cursor(0),
+      m_frame_budget(DEFAULT_FRAME_BUDGET)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    /*
+     * 单例在程序退出时才析构，此时OpenGL上下文可能已经销毁，不能再删除PBO，CPU端尚未上传的图片数据随成员一起释放。
+     * 仍在线程池中执行的解码任务持有完成队列的引用，它们的结果随完成队列一起被丢弃。
+    */
+}
+
+TextureStreamer &TextureStreamer::getInstance()
+{
+    static TextureStreamer instance; // Guaranteed to be destroyed.
+                                     // Instantiated on first use.
+    return instance;
+}
+
+uint64_t TextureStreamer::Enqueue(Texture2D *texture, const std::string &filePath, GLenum format,
+                                  TextureCompression compression, bool srgb)
+{
+    const uint64_t job_id = m_next_job_id++;
+    m_pending.emplace(job_id, PendingTexture{texture, format});
+
+    std::shared_ptr<CompletedQueue> completed = m_completed;
+    ThreadPool::getInstance().Submit([completed, job_id, filePath, compression, srgb]() {
+        DecodedImage image{job_id, nullptr, nullptr};
+
+        if (compression != TextureCompression::None)
+        {
+            auto cooked = std::make_shared<CookedTexture>();
+            if (TextureCooker::Cook(filePath, compression, *cooked))
+                image.cooked = std::move(cooked);
+        }
+
+        if (!image.cooked)
+        {
+            auto chain = std::make_shared<MipChain>();
+            if (MipChainBuilder::Load(filePath, srgb, *chain))
+                image.chain = std::move(chain);
+            else
+                std::cerr << "Texture2D load failed! " << filePath << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(completed->mutex);
+        completed->images.push_back(image);
+    });
+
+    return job_id;
+}
+
+void TextureStreamer::Cancel(uint64_t jobId)
+{
+    // 解码结果到达时找不到对应的纹理，会在 Update 中直接释放
+    m_pending.erase(jobId);
+}
+
+void TextureStreamer::Update()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_completed->mutex);
+        m_ready_images.insert(m_ready_images.end(), m_completed->images.begin(), m_completed->images.end());
+        m_completed->images.clear();
+    }
+
+    size_t uploaded_bytes = 0;
+    size_t consumed = 0;
+
+    for (; consumed < m_ready_images.size(); consumed++)
+    {
+        const DecodedImage &image = m_ready_images[consumed];
+
+        auto iter = m_pending.find(image.job_id);
+        if (iter == m_pending.end() || (!image.chain && !image.cooked))
+        {
+            // 纹理已被销毁或解码失败，失败的纹理保持占位状态
+            if (iter != m_pending.end())
+            {
+                iter->second.texture->stream_job = 0;
+                m_pending.erase(iter);
+            }
+            continue;
+        }
+
+        const size_t image_bytes = GetImageBytes(image);
+        if (uploaded_bytes > 0 && uploaded_bytes + image_bytes > m_frame_budget)
+            break;
+
+        Upload(image, iter->second);
+        uploaded_bytes += image_bytes;
+
+        iter->second.texture->stream_job = 0;
+        m_pending.erase(iter);
+    }
+
+    m_ready_images.erase(m_ready_images.begin(), m_ready_images.begin() + consumed);
+}
+
+size_t TextureStreamer::GetImageBytes(const DecodedImage &image)
+{
+    if (image.cooked)
+        return image.cooked->data.size();
+    return image.chain->data.size();
+}
+
+bool TextureStreamer::FillPixelBuffer(const void *data, size_t bytes)
+{
+    if (m_pbos[0] == 0)
+        glGenBuffers(PBO_RING_SIZE, m_pbos);
+
+    /*
+     * 轮流使用环中的PBO：CPU向一个PBO写入时，驱动可以同时从前几个PBO向纹理传输数据。
+     * 映射时使用 GL_MAP_INVALIDATE_BUFFER_BIT，若该PBO仍在被GPU读取，驱动会分配新的存储而不是等待。
+    */
+    const size_t slot = m_pbo_cursor;
+    m_pbo_cursor = (m_pbo_cursor + 1) % PBO_RING_SIZE;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbos[slot]);
+    if (m_pbo_capacity[slot] < bytes)
+    {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_DRAW);
+        m_pbo_capacity[slot] = bytes;
+    }
+
+    void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped == nullptr)
+    {
+        std::cerr << "TextureStreamer: failed to map pixel unpack buffer" << std::endl;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    std::memcpy(mapped, data, bytes);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    return true;
+}
+
+void TextureStreamer::Upload(const DecodedImage &image, const PendingTexture &pending)
+{
+    Texture2D *texture = pending.texture;
+
+    if (image.cooked)
+    {
+        if (!FillPixelBuffer(image.cooked->data.data(), image.cooked->data.size()))
+            return;
+
+        // 所有 mip 级别依次存放在同一个PBO中，各级的偏移量就是它们在烘焙数据中的偏移量
+        GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, texture->texture_id);
+        texture->UploadCompressed(*image.cooked, nullptr);
+        GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, 0);
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        texture->ready = true;
+        return;
+    }
+
+    if (!FillPixelBuffer(image.chain->data.data(), image.chain->data.size()))
+        return;
+
+    // 绑定PBO时各级的数据指针是缓冲区内的偏移量
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, texture->texture_id);
+    texture->UploadMipChain(*image.chain, nullptr, Texture2D::GetFormat(image.chain->channel_num, pending.format));
+    GLStateCache::getInstance().BindTexture(GL_TEXTURE_2D, 0);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    texture->ready = true;
+}
+
+void TextureStreamer::SetFrameBudget(size_t bytes)
+{
+    m_frame_budget = bytes;
+}
+
+size_t TextureStreamer::GetPendingNum() const
+{
+    return m_pending.size();
+}
@@ -0,0 +1,148 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+ThreadPool::ThreadPool(size_t threadNum) : m_stop(false)
+{
+    for (size_t idx = 0; idx < threadNum; idx++)
+    {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+
+    for (auto &worker : m_workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_workers.clear();
+}
+
+ThreadPool &ThreadPool::getInstance()
+{
+    /*
+     * 主线程需要留给OpenGL提交，所以工作线程数量比硬件线程数少一个。
+     * hardware_concurrency 在无法获取时会返回0，先与2取最大值再减一，此时至少保留一个工作线程。
+    */
+    static ThreadPool instance(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    return instance;
+}
+
+size_t ThreadPool::GetThreadNum() const
+{
+    return m_workers.size();
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+
+            if (m_stop && m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)> &func)
+{
+    if (count == 0)
+        return;
+
+    if (count == 1)
+    {
+        func(0);
+        return;
+    }
+
+    /*
+     * 所有参与者（工作线程和调用线程）通过原子计数器领取下标，
+     * 状态对象由 shared_ptr 持有，因为晚启动的辅助任务可能在本函数返回之后才被执行。
+    */
+    struct SharedState
+    {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::atomic<bool> failed{false};
+        size_t count = 0;
+        std::function<void(size_t)> func;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr exception; // 第一个抛出的异常，由 mutex 保护
+    };
+
+    auto state = std::make_shared<SharedState>();
+    state->count = count;
+    state->func = func;
+
+    auto run = [state]() {
+        size_t idx;
+        while ((idx = state->next.fetch_add(1)) < state->count)
+        {
+            /*
+             * 异常不能离开 run：在工作线程中会直接 std::terminate，并且 done 永远达不到 count，调用线程会一直等待。
+             * 记录第一个异常，之后领取到的下标不再执行，但仍然计入 done，由调用线程在等待结束后重新抛出。
+            */
+            if (!state->failed.load())
+            {
+                try
+                {
+                    state->func(idx);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->exception)
+                        state->exception = std::current_exception();
+                    state->failed.store(true);
+                }
+            }
+
+            if (state->done.fetch_add(1) + 1 == state->count)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helper_num = std::min(count - 1, m_workers.size());
+    for (size_t idx = 0; idx < helper_num; idx++)
+    {
+        Enqueue(run);
+    }
+
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state]() { return state->done.load() == state->count; });
+
+    if (state->exception)
+        std::rethrow_exception(state->exception);
+}
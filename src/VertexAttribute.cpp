@@ -92,4 +92,21 @@ const std::vector<VertexAttribute> &VertexAttributePresets::GetPosNormalTexLayou
         {2, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(sizeof(VertexPNT)), (void *)offsetof(VertexPNT, texCoords)},
     };
     return attributes;
-}
\ No newline at end of file
+}
+
+/*
+ * 压缩的 位置-法线-纹理坐标 布局
+ * 归一化的整数属性在着色器中读取为 [0,1] 或 [-1,1] 的浮点数，半精度浮点数直接读取为浮点数，着色器的输入类型无需修改。
+*/
+const std::vector<VertexAttribute> &VertexAttributePresets::GetPackedPosNormalTexLayout()
+{
+    static const std::vector<VertexAttribute> attributes = {
+        {3, GL_UNSIGNED_SHORT, GL_TRUE, static_cast<GLsizei>(sizeof(VertexPackedPNT)),
+         (void *)offsetof(VertexPackedPNT, position)},
+        {4, GL_INT_2_10_10_10_REV, GL_TRUE, static_cast<GLsizei>(sizeof(VertexPackedPNT)),
+         (void *)offsetof(VertexPackedPNT, normal)},
+        {2, GL_HALF_FLOAT, GL_FALSE, static_cast<GLsizei>(sizeof(VertexPackedPNT)),
+         (void *)offsetof(VertexPackedPNT, texCoords)},
+    };
+    return attributes;
+}
@@ -0,0 +1,67 @@
+#include "VertexEncoder.h"
+#include "glm/gtc/packing.hpp"
+#include <limits>
+
+PackedVertices VertexEncoder::EncodePosNormalTex(const GLfloat *vertices, size_t vertexNum,
+                                                 const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+{
+    const unsigned int stride = 8; // 位置(3) + 法线(3) + 纹理坐标(2)
+
+    PackedVertices packed;
+    packed.vertices.resize(vertexNum);
+    packed.position_offset = boundsMin;
+    packed.position_scale = boundsMax - boundsMin;
+
+    // 某个轴上所有顶点坐标相同时范围为0，此时归一化坐标取任意值都能还原，直接编码为0
+    glm::vec3 inv_scale(0.0f);
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (packed.position_scale[axis] > 0.0f)
+            inv_scale[axis] = 1.0f / packed.position_scale[axis];
+    }
+
+    const GLfloat *src = vertices;
+    for (size_t idx = 0; idx < vertexNum; idx++, src += stride)
+    {
+        VertexPackedPNT &dst = packed.vertices[idx];
+
+        // 位置：映射到 [0,1] 后量化为16位，packUnorm1x16 会截断到 [0,1] 并四舍五入
+        for (int axis = 0; axis < 3; axis++)
+        {
+            dst.position[axis] = glm::packUnorm1x16((src[axis] - boundsMin[axis]) * inv_scale[axis]);
+        }
+        dst.padding = 0;
+
+        // 法线：先归一化，再量化为 10_10_10_2，w分量不使用
+        glm::vec3 normal(src[3], src[4], src[5]);
+        const float length = glm::length(normal);
+        if (length > 0.0f)
+            normal /= length;
+        dst.normal = glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+
+        // 纹理坐标：半精度浮点数
+        dst.texCoords[0] = glm::packHalf1x16(src[6]);
+        dst.texCoords[1] = glm::packHalf1x16(src[7]);
+    }
+
+    return packed;
+}
+
+PackedVertices VertexEncoder::EncodePosNormalTex(const GLfloat *vertices, size_t vertexNum)
+{
+    const unsigned int stride = 8;
+
+    glm::vec3 bounds_min(std::numeric_limits<float>::max());
+    glm::vec3 bounds_max(std::numeric_limits<float>::lowest());
+    for (size_t idx = 0; idx < vertexNum; idx++)
+    {
+        const glm::vec3 position(vertices[idx * stride], vertices[idx * stride + 1], vertices[idx * stride + 2]);
+        bounds_min = glm::min(bounds_min, position);
+        bounds_max = glm::max(bounds_max, position);
+    }
+
+    if (vertexNum == 0)
+        bounds_min = bounds_max = glm::vec3(0.0f);
+
+    return EncodePosNormalTex(vertices, vertexNum, bounds_min, bounds_max);
+}
@@ -0,0 +1,117 @@
+#include "BCnEncoder.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+/*
+ * 合成的测试图像，内容固定，PSNR 只随编码器的实现变化。
+ * 宽高故意不是4的倍数，覆盖边缘补齐的路径。
+*/
+const int WIDTH = 130;
+const int HEIGHT = 66;
+
+// 下限比当前实现的结果（36.8、38.0、52.5、49.8 dB）低约1dB，编码器质量明显下降时测试失败
+const double BC1_MIN_PSNR = 35.8;
+const double BC3_MIN_PSNR = 37.0;
+const double BC4_MIN_PSNR = 51.5;
+const double BC5_MIN_PSNR = 48.8;
+
+uint8_t ToByte(float value)
+{
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+/* 平滑渐变叠加少量噪声，alpha 为径向渐变 */
+std::vector<uint8_t> MakeColorImage()
+{
+    // mt19937 的输出序列由标准规定，不使用 uniform_real_distribution（不同标准库的实现不同）
+    std::mt19937 rng(2024);
+    auto noise = [&rng]() { return (static_cast<float>(rng() & 0xFF) / 255.0f - 0.5f) * 0.04f; };
+
+    std::vector<uint8_t> rgba(static_cast<size_t>(WIDTH) * HEIGHT * 4);
+    for (int y = 0; y < HEIGHT; y++)
+    {
+        for (int x = 0; x < WIDTH; x++)
+        {
+            const float u = static_cast<float>(x) / (WIDTH - 1);
+            const float v = static_cast<float>(y) / (HEIGHT - 1);
+            const float radius = std::sqrt((u - 0.5f) * (u - 0.5f) + (v - 0.5f) * (v - 0.5f));
+
+            uint8_t *pixel = rgba.data() + (static_cast<size_t>(y) * WIDTH + x) * 4;
+            pixel[0] = ToByte(u + noise());
+            pixel[1] = ToByte(0.5f + 0.4f * std::sin(v * 9.0f) + noise());
+            pixel[2] = ToByte(1.0f - 0.5f * (u + v) + noise());
+            pixel[3] = ToByte(1.0f - radius * 1.4f);
+        }
+    }
+    return rgba;
+}
+
+/* 起伏表面的切线空间法线，RG 为映射到 [0, 1] 的 xy 分量 */
+std::vector<uint8_t> MakeNormalImage()
+{
+    std::vector<uint8_t> rgba(static_cast<size_t>(WIDTH) * HEIGHT * 4);
+    for (int y = 0; y < HEIGHT; y++)
+    {
+        for (int x = 0; x < WIDTH; x++)
+        {
+            const float dx = 0.6f * std::cos(x * 0.15f) * std::sin(y * 0.07f);
+            const float dy = 0.6f * std::sin(x * 0.05f) * std::cos(y * 0.2f);
+            const float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+
+            uint8_t *pixel = rgba.data() + (static_cast<size_t>(y) * WIDTH + x) * 4;
+            pixel[0] = ToByte(dx / length * 0.5f + 0.5f);
+            pixel[1] = ToByte(dy / length * 0.5f + 0.5f);
+            pixel[2] = ToByte(1.0f / length * 0.5f + 0.5f);
+            pixel[3] = 255;
+        }
+    }
+    return rgba;
+}
+
+double EncodeAndMeasure(BCFormat format, const std::vector<uint8_t> &rgba)
+{
+    std::vector<uint8_t> blocks(BCnEncoder::GetCompressedSize(format, WIDTH, HEIGHT));
+    BCnEncoder::Encode(format, rgba.data(), WIDTH, HEIGHT, blocks.data());
+
+    std::vector<uint8_t> decoded(rgba.size());
+    BCnEncoder::Decode(format, blocks.data(), WIDTH, HEIGHT, decoded.data());
+
+    const double psnr = BCnEncoder::ComputePSNR(format, rgba.data(), decoded.data(), WIDTH, HEIGHT);
+    std::cout << "BCnEncoderTest: BC" << static_cast<uint32_t>(format) << " PSNR " << psnr << " dB" << std::endl;
+    return psnr;
+}
+} // namespace
+
+int main()
+{
+    const std::vector<uint8_t> color = MakeColorImage();
+    const std::vector<uint8_t> normal = MakeNormalImage();
+
+    CHECK(BCnEncoder::GetCompressedSize(BCFormat::BC1, WIDTH, HEIGHT) == 33u * 17u * 8u);
+    CHECK(BCnEncoder::GetCompressedSize(BCFormat::BC5, WIDTH, HEIGHT) == 33u * 17u * 16u);
+
+    CHECK(EncodeAndMeasure(BCFormat::BC1, color) >= BC1_MIN_PSNR);
+    CHECK(EncodeAndMeasure(BCFormat::BC3, color) >= BC3_MIN_PSNR);
+    CHECK(EncodeAndMeasure(BCFormat::BC4, color) >= BC4_MIN_PSNR);
+    CHECK(EncodeAndMeasure(BCFormat::BC5, normal) >= BC5_MIN_PSNR);
+
+    // 纯色块的端点可以精确表示，解码结果与原图完全相同
+    std::vector<uint8_t> solid(static_cast<size_t>(WIDTH) * HEIGHT * 4);
+    for (size_t idx = 0; idx < solid.size(); idx += 4)
+    {
+        solid[idx] = 255;
+        solid[idx + 1] = 0;
+        solid[idx + 2] = 255;
+        solid[idx + 3] = 255;
+    }
+    CHECK(std::isinf(EncodeAndMeasure(BCFormat::BC1, solid)));
+    CHECK(std::isinf(EncodeAndMeasure(BCFormat::BC4, solid)));
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,275 @@
+#include "DynamicBVH.h"
+#include "TestCommon.h"
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+const float WORLD_EXTENT = 200.0f;
+const size_t MAX_PROXY_NUM = 3000;
+const size_t OPERATION_NUM = 40000;
+const size_t QUERY_INTERVAL = 500;
+
+struct Instance
+{
+    int proxy;
+    glm::vec3 min, max;
+};
+
+/* mt19937 的输出序列由标准规定，不使用各标准库实现不同的 uniform_real_distribution */
+class Random
+{
+  private:
+    std::mt19937 m_rng;
+
+  public:
+    Random(uint32_t seed) : m_rng(seed)
+    {
+    }
+
+    float Uniform(float min, float max)
+    {
+        return min + (max - min) * (static_cast<float>(m_rng() >> 8) / static_cast<float>(1u << 24));
+    }
+
+    glm::vec3 Point(float extent)
+    {
+        return glm::vec3(Uniform(-extent, extent), Uniform(-extent, extent), Uniform(-extent, extent));
+    }
+
+    size_t Index(size_t size)
+    {
+        return m_rng() % size;
+    }
+};
+
+void RandomBox(Random &random, glm::vec3 &min, glm::vec3 &max)
+{
+    const glm::vec3 center = random.Point(WORLD_EXTENT);
+    const glm::vec3 extent(random.Uniform(0.05f, 3.0f), random.Uniform(0.05f, 3.0f), random.Uniform(0.05f, 3.0f));
+    min = center - extent;
+    max = center + extent;
+}
+
+/* 与 Camera::GetFrustumPlanes 相同的 Gribb-Hartmann 方法 */
+void RandomFrustum(Random &random, glm::vec4 planes[6])
+{
+    const glm::vec3 eye = random.Point(WORLD_EXTENT);
+    const glm::vec3 target = random.Point(WORLD_EXTENT);
+    const glm::mat4 projection =
+        glm::perspective(glm::radians(random.Uniform(30.0f, 90.0f)), random.Uniform(0.5f, 2.0f), 0.1f,
+                         random.Uniform(20.0f, 400.0f));
+    const glm::mat4 m = projection * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const glm::vec4 row(m[0][axis], m[1][axis], m[2][axis], m[3][axis]);
+        const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+        planes[axis * 2] = row3 + row;
+        planes[axis * 2 + 1] = row3 - row;
+    }
+    for (int idx = 0; idx < 6; idx++)
+    {
+        planes[idx] /= glm::length(glm::vec3(planes[idx]));
+    }
+}
+
+/* 逐个测试所有实例的参考实现，测试方式与 FrustumCuller 相同 */
+bool InFrustum(const glm::vec4 planes[6], const Instance &instance)
+{
+    const glm::vec3 center = (instance.min + instance.max) * 0.5f;
+    const glm::vec3 extent = (instance.max - instance.min) * 0.5f;
+    for (int idx = 0; idx < 6; idx++)
+    {
+        const glm::vec4 &plane = planes[idx];
+        const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        const float radius =
+            std::fabs(plane.x) * extent.x + std::fabs(plane.y) * extent.y + std::fabs(plane.z) * extent.z;
+        if (distance + radius < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool InSphere(const glm::vec3 &center, float radius, const Instance &instance)
+{
+    const glm::vec3 offset = glm::clamp(center, instance.min, instance.max) - center;
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+/* 射线进入包围盒的距离，没有相交时返回 false */
+bool RayHit(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, const Instance &instance,
+            float &distance)
+{
+    float t_min = 0.0f;
+    float t_max = maxDistance;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const float t0 = (instance.min[axis] - origin[axis]) / direction[axis];
+        const float t1 = (instance.max[axis] - origin[axis]) / direction[axis];
+        t_min = std::max(t_min, std::min(t0, t1));
+        t_max = std::min(t_max, std::max(t0, t1));
+    }
+    distance = t_min;
+    return t_min <= t_max;
+}
+
+void CheckQueries(Random &random, const DynamicBVH &bvh, const std::vector<Instance> &instances)
+{
+    std::vector<uint32_t> result, expected;
+
+    for (int query = 0; query < 4; query++)
+    {
+        glm::vec4 planes[6];
+        RandomFrustum(random, planes);
+
+        result.clear();
+        bvh.QueryFrustum(planes, result);
+
+        expected.clear();
+        for (size_t idx = 0; idx < instances.size(); idx++)
+        {
+            if (instances[idx].proxy != DynamicBVH::NULL_NODE && InFrustum(planes, instances[idx]))
+                expected.push_back(static_cast<uint32_t>(idx));
+        }
+
+        std::sort(result.begin(), result.end());
+        CHECK(result == expected);
+    }
+
+    for (int query = 0; query < 4; query++)
+    {
+        const glm::vec3 center = random.Point(WORLD_EXTENT);
+        const float radius = random.Uniform(1.0f, 60.0f);
+
+        result.clear();
+        bvh.QuerySphere(center, radius, result);
+
+        expected.clear();
+        for (size_t idx = 0; idx < instances.size(); idx++)
+        {
+            if (instances[idx].proxy != DynamicBVH::NULL_NODE && InSphere(center, radius, instances[idx]))
+                expected.push_back(static_cast<uint32_t>(idx));
+        }
+
+        std::sort(result.begin(), result.end());
+        CHECK(result == expected);
+    }
+
+    for (int query = 0; query < 8; query++)
+    {
+        // 方向的各分量都不为0，参考实现中不需要处理 0 * inf
+        const glm::vec3 origin = random.Point(WORLD_EXTENT * 1.2f);
+        glm::vec3 direction = random.Point(1.0f);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (std::fabs(direction[axis]) < 1e-3f)
+                direction[axis] = 1e-3f;
+        }
+        const float max_distance = random.Uniform(10.0f, 1000.0f);
+
+        float best_distance = max_distance;
+        bool expected_hit = false;
+        for (const Instance &instance : instances)
+        {
+            float distance = 0.0f;
+            if (instance.proxy != DynamicBVH::NULL_NODE &&
+                RayHit(origin, direction, best_distance, instance, distance))
+            {
+                best_distance = std::min(best_distance, distance);
+                expected_hit = true;
+            }
+        }
+
+        // 多个实例距离相同时命中哪一个都可以，只比较距离
+        float hit_distance = -1.0f;
+        const uint32_t hit = bvh.RayCast(origin, direction, max_distance, hit_distance);
+        CHECK((hit != DynamicBVH::INVALID_USER_INDEX) == expected_hit);
+        if (hit != DynamicBVH::INVALID_USER_INDEX && expected_hit)
+        {
+            CHECK(hit < instances.size() && instances[hit].proxy != DynamicBVH::NULL_NODE);
+            CHECK(std::fabs(hit_distance - best_distance) <= 1e-3f * std::max(1.0f, best_distance));
+        }
+    }
+}
+} // namespace
+
+int main()
+{
+    Random random(12345);
+    DynamicBVH bvh(0.5f);
+
+    // 实例在数组中的下标作为 userIndex，删除后 proxy 为 NULL_NODE
+    std::vector<Instance> instances;
+    size_t live_num = 0;
+
+    for (size_t op = 0; op < OPERATION_NUM; op++)
+    {
+        const float action = random.Uniform(0.0f, 1.0f);
+
+        if (live_num == 0 || (action < 0.3f && live_num < MAX_PROXY_NUM))
+        {
+            Instance instance;
+            RandomBox(random, instance.min, instance.max);
+            instance.proxy = bvh.CreateProxy(instance.min, instance.max, static_cast<uint32_t>(instances.size()));
+            instances.push_back(instance);
+            live_num++;
+        }
+        else
+        {
+            size_t idx = random.Index(instances.size());
+            while (instances[idx].proxy == DynamicBVH::NULL_NODE)
+                idx = (idx + 1) % instances.size();
+            Instance &instance = instances[idx];
+
+            if (action < 0.45f)
+            {
+                bvh.DestroyProxy(instance.proxy);
+                instance.proxy = DynamicBVH::NULL_NODE;
+                live_num--;
+            }
+            else if (action < 0.9f)
+            {
+                // 小幅移动，大部分仍在宽松包围盒内
+                const glm::vec3 offset = random.Point(0.4f);
+                instance.min += offset;
+                instance.max += offset;
+                bvh.MoveProxy(instance.proxy, instance.min, instance.max);
+            }
+            else
+            {
+                // 移动到很远的地方，或者大小明显变化
+                RandomBox(random, instance.min, instance.max);
+                bvh.MoveProxy(instance.proxy, instance.min, instance.max);
+            }
+
+            CHECK(bvh.GetUserIndex(instance.proxy) == idx || instance.proxy == DynamicBVH::NULL_NODE);
+        }
+
+        if ((op + 1) % QUERY_INTERVAL == 0)
+        {
+            CHECK(bvh.GetProxyNum() == live_num);
+
+            // 平衡后的树高度应为 O(log n)
+            CHECK(bvh.GetHeight() <= 3 * static_cast<int>(std::log2(static_cast<double>(live_num) + 1.0)) + 2);
+
+            CheckQueries(random, bvh, instances);
+        }
+    }
+
+    std::cout << "DynamicBVHTest: " << bvh.GetProxyNum() << " proxies, height " << bvh.GetHeight() << std::endl;
+
+    // 清空后所有查询都没有结果
+    bvh.Clear();
+    for (Instance &instance : instances)
+        instance.proxy = DynamicBVH::NULL_NODE;
+    CHECK(bvh.GetProxyNum() == 0);
+    CHECK(bvh.GetHeight() == 0);
+    CheckQueries(random, bvh, instances);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,87 @@
+#include "LightCluster.h"
+#include "TestCommon.h"
+#include "glm/ext/matrix_clip_space.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+const float NEAR = 0.1f;
+const float FAR = 100.0f;
+
+/*
+ * 随机灯光：大部分位于视锥体内，也有位于相机后方、跨过近平面和远平面之外的灯光。
+ * 观察空间中相机朝向 -z。
+*/
+std::vector<ClusterLight> MakeLights(uint32_t seed, size_t lightNum, float minRange, float maxRange)
+{
+    std::mt19937 rng(seed);
+    auto uniform = [&rng](float min, float max) {
+        return min + (max - min) * (static_cast<float>(rng() >> 8) / static_cast<float>(1u << 24));
+    };
+
+    std::vector<ClusterLight> lights(lightNum);
+    for (ClusterLight &light : lights)
+    {
+        const float depth = uniform(-5.0f, FAR * 1.2f);
+        const float spread = std::max(depth, 1.0f);
+        light.view_pos = glm::vec3(uniform(-spread, spread), uniform(-spread, spread) * 0.6f, -depth);
+        light.range = uniform(minRange, maxRange);
+    }
+    return lights;
+}
+
+bool SameClusters(const std::vector<ClusterRange> &a, const std::vector<ClusterRange> &b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t idx = 0; idx < a.size(); idx++)
+    {
+        if (a[idx].offset != b[idx].offset || a[idx].count != b[idx].count)
+            return false;
+    }
+    return true;
+}
+
+/* Build 与 BuildReference 的结果必须完全相同，返回 Build 丢失的索引数量 */
+size_t Compare(const glm::mat4 &projection, const std::vector<ClusterLight> &lights)
+{
+    LightCluster cluster, reference;
+    cluster.Build(projection, NEAR, FAR, lights);
+    reference.BuildReference(projection, NEAR, FAR, lights);
+
+    CHECK(SameClusters(cluster.GetClusters(), reference.GetClusters()));
+    CHECK(cluster.GetLightIndices() == reference.GetLightIndices());
+    CHECK(cluster.GetDroppedNum() == reference.GetDroppedNum());
+    CHECK(cluster.GetLightIndices().size() <= LightCluster::MAX_LIGHT_INDEX_NUM);
+
+    return cluster.GetDroppedNum();
+}
+} // namespace
+
+int main()
+{
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, NEAR, FAR);
+    const glm::mat4 narrow = glm::perspective(glm::radians(30.0f), 1.0f, NEAR, FAR);
+
+    CHECK(Compare(projection, {}) == 0);
+
+    // 少量小范围的灯光，索引表不会溢出
+    CHECK(Compare(projection, MakeLights(7, 32, 0.5f, 4.0f)) == 0);
+
+    for (uint32_t seed = 1; seed <= 8; seed++)
+    {
+        Compare(projection, MakeLights(seed, 64 * seed, 0.5f, 8.0f));
+        Compare(narrow, MakeLights(seed + 100, 200, 0.1f, 20.0f));
+    }
+
+    // 大量覆盖范围很大的灯光，索引表放不下，两种实现丢弃的必须是同样的索引
+    const size_t dropped = Compare(projection, MakeLights(42, 1000, 20.0f, 60.0f));
+    CHECK(dropped > 0);
+
+    std::cout << "LightClusterTest: " << dropped << " light indices dropped in the overflow case" << std::endl;
+
+    return TEST_RESULT();
+}
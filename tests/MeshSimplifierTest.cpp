@@ -0,0 +1,133 @@
+#include "MeshSimplifier.h"
+#include "TestCommon.h"
+#include <cmath>
+#include <vector>
+
+namespace
+{
+const size_t STRIDE = 8; // 位置(3)-法线(3)-纹理坐标(2)，与导入的模型一致
+const size_t GRID_SIZE = 32;
+const size_t SEAM_COLUMN = GRID_SIZE / 2;
+
+struct GridMesh
+{
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> indices;
+    std::vector<GLuint> boundary_vertices;
+    std::vector<GLuint> seam_vertices;
+};
+
+GLuint AddVertex(GridMesh &mesh, size_t x, size_t y, float u)
+{
+    const float px = static_cast<float>(x) / GRID_SIZE;
+    const float py = static_cast<float>(y) / GRID_SIZE;
+    const float pz = 0.02f * std::sin(px * 6.0f) * std::cos(py * 4.0f);
+
+    const GLuint index = static_cast<GLuint>(mesh.vertices.size() / STRIDE);
+    const GLfloat vertex[STRIDE] = {px, py, pz, 0.0f, 0.0f, 1.0f, u, py};
+    mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + STRIDE);
+    return index;
+}
+
+/*
+ * 起伏的 (GRID_SIZE + 1) x (GRID_SIZE + 1) 网格，第 SEAM_COLUMN 列的顶点复制一份给右半部分使用，
+ * 两份位置相同、纹理坐标不同，形成一条纹理接缝。
+*/
+GridMesh MakeGrid()
+{
+    GridMesh mesh;
+    std::vector<GLuint> left(GRID_SIZE + 1), right(GRID_SIZE + 1);
+    std::vector<std::vector<GLuint>> ids(GRID_SIZE + 1, std::vector<GLuint>(GRID_SIZE + 1));
+
+    for (size_t y = 0; y <= GRID_SIZE; y++)
+    {
+        for (size_t x = 0; x <= GRID_SIZE; x++)
+        {
+            ids[y][x] = AddVertex(mesh, x, y, static_cast<float>(x) / GRID_SIZE);
+            if (x == 0 || y == 0 || x == GRID_SIZE || y == GRID_SIZE)
+                mesh.boundary_vertices.push_back(ids[y][x]);
+        }
+
+        left[y] = ids[y][SEAM_COLUMN];
+        right[y] = AddVertex(mesh, SEAM_COLUMN, y, 1.0f);
+        mesh.seam_vertices.push_back(left[y]);
+        mesh.seam_vertices.push_back(right[y]);
+    }
+
+    for (size_t y = 0; y < GRID_SIZE; y++)
+    {
+        for (size_t x = 0; x < GRID_SIZE; x++)
+        {
+            GLuint v00 = ids[y][x], v10 = ids[y][x + 1], v01 = ids[y + 1][x], v11 = ids[y + 1][x + 1];
+
+            // 接缝右侧的格子使用复制出的顶点
+            if (x == SEAM_COLUMN)
+            {
+                v00 = right[y];
+                v01 = right[y + 1];
+            }
+
+            const GLuint quad[6] = {v00, v10, v11, v00, v11, v01};
+            mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+        }
+    }
+
+    return mesh;
+}
+
+bool IsReferenced(const std::vector<GLuint> &indices, GLuint vertex)
+{
+    for (GLuint index : indices)
+    {
+        if (index == vertex)
+            return true;
+    }
+    return false;
+}
+} // namespace
+
+int main()
+{
+    const GridMesh mesh = MakeGrid();
+    const size_t vertex_num = mesh.vertices.size() / STRIDE;
+    const size_t target_index_num = mesh.indices.size() / 4;
+    const float target_error = 0.01f;
+
+    float error_first = -1.0f, error_second = -1.0f;
+    const std::vector<GLuint> first =
+        MeshSimplifier::Simplify(mesh.vertices.data(), vertex_num, STRIDE, mesh.indices.data(), mesh.indices.size(),
+                                 target_index_num, target_error, &error_first);
+    const std::vector<GLuint> second =
+        MeshSimplifier::Simplify(mesh.vertices.data(), vertex_num, STRIDE, mesh.indices.data(), mesh.indices.size(),
+                                 target_index_num, target_error, &error_second);
+
+    // 相同输入的结果必须完全相同
+    CHECK(first == second);
+    CHECK(error_first == error_second);
+
+    CHECK(first.size() % 3 == 0);
+    CHECK(first.size() < mesh.indices.size());
+    CHECK(error_first >= 0.0f && error_first <= target_error);
+
+    for (GLuint index : first)
+        CHECK(index < vertex_num);
+
+    // 边界顶点和接缝两侧的顶点都不能被折叠掉
+    for (GLuint vertex : mesh.boundary_vertices)
+        CHECK(IsReferenced(first, vertex));
+    for (GLuint vertex : mesh.seam_vertices)
+        CHECK(IsReferenced(first, vertex));
+
+    // 误差上限为0时只能折叠完全不改变形状的边，起伏的网格内部没有这样的边
+    float zero_error = -1.0f;
+    const std::vector<GLuint> unchanged =
+        MeshSimplifier::Simplify(mesh.vertices.data(), vertex_num, STRIDE, mesh.indices.data(), mesh.indices.size(),
+                                 target_index_num, 0.0f, &zero_error);
+    CHECK(zero_error == 0.0f);
+    CHECK(unchanged == mesh.indices);
+
+    std::cout << "MeshSimplifierTest: " << mesh.indices.size() << " -> " << first.size() << " indices, error "
+              << error_first << ", " << unchanged.size() << " indices with zero error" << std::endl;
+
+    return TEST_RESULT();
+}
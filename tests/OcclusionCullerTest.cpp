@@ -0,0 +1,166 @@
+#include "OcclusionCuller.h"
+#include "TestCommon.h"
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+/* mt19937 的输出序列由标准规定，不使用各标准库实现不同的 uniform_real_distribution */
+float Uniform(std::mt19937 &rng, float min, float max)
+{
+    return min + (max - min) * (static_cast<float>(rng() >> 8) / static_cast<float>(1u << 24));
+}
+
+/* 深度缓冲区是否仍为清空后的状态 */
+bool IsCleared(const OcclusionCuller &culler)
+{
+    const float *depths = culler.GetDepthBuffer();
+    for (size_t idx = 0; idx < static_cast<size_t>(culler.GetWidth()) * culler.GetHeight(); idx++)
+    {
+        if (depths[idx] != 1.0f)
+            return false;
+    }
+    return true;
+}
+
+/*
+ * 随机的遮挡三角形：大部分在视锥体内，也有跨过屏幕边缘、远在屏幕外、位于相机后方和跨过近平面的三角形。
+ * 分别用 SIMD 和标量实现光栅化，深度缓冲区必须逐位相同。
+*/
+void CompareSimdAndScalar(uint32_t seed, size_t triangleNum)
+{
+    std::mt19937 rng(seed);
+
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    for (size_t idx = 0; idx < triangleNum; idx++)
+    {
+        const float spread = (idx % 8 == 0) ? 1000.0f : 6.0f;
+        const glm::vec3 center(Uniform(rng, -spread, spread), Uniform(rng, -spread, spread),
+                               Uniform(rng, -30.0f, 5.0f));
+        const float size = Uniform(rng, 0.1f, 4.0f);
+        for (int corner = 0; corner < 3; corner++)
+        {
+            indices.push_back(static_cast<uint32_t>(positions.size()));
+            positions.push_back(center + glm::vec3(Uniform(rng, -size, size), Uniform(rng, -size, size),
+                                                   Uniform(rng, -size, size)));
+        }
+    }
+
+    const glm::mat4 view_projection = glm::perspective(glm::radians(45.0f), 2.0f, 0.1f, 100.0f) *
+                                      glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0, 1, 0));
+
+    OcclusionCuller simd, scalar;
+    scalar.SetSimdEnabled(false);
+    for (OcclusionCuller *culler : {&simd, &scalar})
+    {
+        culler->Begin(view_projection);
+        culler->AddOccluder(positions.data(), positions.size(), indices.data(), indices.size(), glm::mat4(1.0f));
+        culler->Rasterize();
+    }
+
+    CHECK(simd.GetOccluderTriangleNum() == scalar.GetOccluderTriangleNum());
+    CHECK(simd.GetOccluderTriangleNum() > 0);
+    CHECK(!IsCleared(simd));
+    CHECK(std::memcmp(simd.GetDepthBuffer(), scalar.GetDepthBuffer(),
+                      sizeof(float) * simd.GetWidth() * simd.GetHeight()) == 0);
+}
+
+/* z 为常数、在 x / y 方向覆盖 [minX, maxX] x [-2, 2] 的墙 */
+void AddWall(OcclusionCuller &culler, float minX, float maxX, float z)
+{
+    const glm::vec3 positions[4] = {glm::vec3(minX, -2.0f, z), glm::vec3(maxX, -2.0f, z), glm::vec3(minX, 2.0f, z),
+                                    glm::vec3(maxX, 2.0f, z)};
+    const uint32_t indices[6] = {0, 1, 3, 0, 3, 2};
+    culler.AddOccluder(positions, 4, indices, 6, glm::mat4(1.0f));
+}
+
+/*
+ * 观察投影矩阵为单位矩阵，世界坐标就是 NDC：屏幕覆盖 x / y 的 [-1, 1]，z 越大越远，z < -1 跨过近平面。
+*/
+void CheckVisibility(bool simdEnabled)
+{
+    OcclusionCuller culler;
+    culler.SetSimdEnabled(simdEnabled);
+    const glm::vec3 box_extent(0.2f);
+
+    // 没有遮挡体时总是可见
+    culler.Begin(glm::mat4(1.0f));
+    culler.Rasterize();
+    CHECK(culler.IsVisible(glm::vec3(0.3f) - box_extent, glm::vec3(0.3f) + box_extent));
+
+    // 覆盖整个屏幕的墙，深度为 0.5
+    culler.Begin(glm::mat4(1.0f));
+    AddWall(culler, -2.0f, 2.0f, 0.0f);
+    culler.Rasterize();
+    CHECK(culler.IsVisible(glm::vec3(0.0f, 0.0f, -0.5f) - box_extent, glm::vec3(0.0f, 0.0f, -0.5f) + box_extent));
+    CHECK(!culler.IsVisible(glm::vec3(0.0f, 0.0f, 0.5f) - box_extent, glm::vec3(0.0f, 0.0f, 0.5f) + box_extent));
+    CHECK(!culler.IsVisible(glm::vec3(-0.9f, 0.7f, 0.8f) - box_extent, glm::vec3(-0.9f, 0.7f, 0.8f) + box_extent));
+    // 穿过墙的包围盒
+    CHECK(culler.IsVisible(glm::vec3(0.0f, 0.0f, -0.1f), glm::vec3(0.3f, 0.3f, 0.4f)));
+    // 跨过近平面
+    CHECK(culler.IsVisible(glm::vec3(-0.1f, -0.1f, -1.5f), glm::vec3(0.1f, 0.1f, 0.8f)));
+
+    // 只遮住屏幕左半边的墙
+    culler.Begin(glm::mat4(1.0f));
+    AddWall(culler, -2.0f, 0.0f, 0.0f);
+    culler.Rasterize();
+    CHECK(!culler.IsVisible(glm::vec3(-0.5f, 0.0f, 0.5f) - box_extent, glm::vec3(-0.5f, 0.0f, 0.5f) + box_extent));
+    CHECK(culler.IsVisible(glm::vec3(0.5f, 0.0f, 0.5f) - box_extent, glm::vec3(0.5f, 0.0f, 0.5f) + box_extent));
+    // 从墙的边缘露出一部分
+    CHECK(culler.IsVisible(glm::vec3(0.1f, 0.0f, 0.5f) - box_extent, glm::vec3(0.1f, 0.0f, 0.5f) + box_extent));
+}
+
+/*
+ * w 很小的顶点投影后坐标远远超出 int32 的范围：完全在屏幕外的三角形不改变深度缓冲区，
+ * 跨过屏幕的三角形正常光栅化，两种实现的结果相同。
+*/
+void CheckHugeCoordinates()
+{
+    // w = z，z 越小投影后的坐标越大
+    glm::mat4 model(1.0f);
+    model[2][3] = 1.0f;
+    model[3][3] = 0.0f;
+
+    const glm::vec3 off_screen[3] = {glm::vec3(1.0f, 1.0f, 1e-30f), glm::vec3(2.0f, 1.0f, 1e-30f),
+                                     glm::vec3(1.0f, 2.0f, 1e-30f)};
+    const glm::vec3 crossing[3] = {glm::vec3(-0.5f, -0.5f, 1.0f), glm::vec3(1.0f, -0.5f, 1e-20f),
+                                   glm::vec3(-0.5f, 1.0f, 1e-20f)};
+    const uint32_t indices[3] = {0, 1, 2};
+
+    OcclusionCuller culler;
+    culler.Begin(glm::mat4(1.0f));
+    culler.AddOccluder(off_screen, 3, indices, 3, model);
+    culler.Rasterize();
+    CHECK(culler.GetOccluderTriangleNum() == 0);
+    CHECK(IsCleared(culler));
+
+    OcclusionCuller simd, scalar;
+    scalar.SetSimdEnabled(false);
+    for (OcclusionCuller *target : {&simd, &scalar})
+    {
+        target->Begin(glm::mat4(1.0f));
+        target->AddOccluder(off_screen, 3, indices, 3, model);
+        target->AddOccluder(crossing, 3, indices, 3, model);
+        target->Rasterize();
+    }
+    CHECK(std::memcmp(simd.GetDepthBuffer(), scalar.GetDepthBuffer(),
+                      sizeof(float) * simd.GetWidth() * simd.GetHeight()) == 0);
+}
+} // namespace
+
+int main()
+{
+    for (uint32_t seed = 1; seed <= 8; seed++)
+        CompareSimdAndScalar(seed, 200 * seed);
+
+    CheckVisibility(true);
+    CheckVisibility(false);
+
+    CheckHugeCoordinates();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <iostream>
+
+/*
+ * 测试使用的最简单的断言：失败时输出文件、行号和表达式并记录失败次数，不中断后续检查。
+ * 每个测试程序的 main 最后返回 TEST_RESULT()，有任何失败时返回非0，由 ctest 判定为失败。
+*/
+inline int &TestFailureNum()
+{
+    static int failure_num = 0;
+    return failure_num;
+}
+
+#define CHECK(expr)                                                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(expr))                                                                                                   \
+        {                                                                                                              \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #expr << std::endl;                         \
+            TestFailureNum()++;                                                                                        \
+        }                                                                                                              \
+    } while (0)
+
+#define TEST_RESULT() (TestFailureNum() == 0 ? 0 : 1)